@@ -206,7 +206,11 @@ class Keyframe {
   virtual void initialize() {
   }
 
-  virtual T getValueAt(Frame) {
+  /**
+   * Returns the interpolated value at the specified frame. It has no side effects, so it can be
+   * called from multiple threads at the same time.
+   */
+  virtual T getValueAt(Frame) const {
     return startValue;
   }
 
@@ -243,7 +247,11 @@ class Property {
     return false;
   }
 
-  virtual T getValueAt(Frame) {
+  /**
+   * Returns the value at the specified frame. It has no side effects, so multiple threads can
+   * evaluate the same property at different frames at the same time.
+   */
+  virtual T getValueAt(Frame) const {
     return value;
   }
 
@@ -267,8 +275,7 @@ bool PAG_API HasVaryingTimeRange(const std::vector<TimeRange>* staticTimeRanges,
 template <typename T>
 class AnimatableProperty : public Property<T> {
  public:
-  explicit AnimatableProperty(const std::vector<Keyframe<T>*>& keyframes)
-      : keyframes(keyframes), lastKeyframeIndex(0) {
+  explicit AnimatableProperty(const std::vector<Keyframe<T>*>& keyframes) : keyframes(keyframes) {
     this->value = keyframes[0]->startValue;
     for (Keyframe<T>* keyframe : keyframes) {
       keyframe->initialize();
@@ -300,36 +307,30 @@ class AnimatableProperty : public Property<T> {
     }
   }
 
-  T getValueAt(Frame frame) override {
-    T result;
-    Keyframe<T>* lastKeyframe = keyframes[lastKeyframeIndex];
-    if (lastKeyframe->containsTime(frame)) {
-      return lastKeyframe->getValueAt(frame);
+  T getValueAt(Frame frame) const override {
+    auto keyframe = findKeyframeAt(frame);
+    if (frame <= keyframe->startTime) {
+      return keyframe->startValue;
     }
-    if (frame < lastKeyframe->startTime) {
-      while (lastKeyframeIndex > 0) {
-        lastKeyframeIndex--;
-        if (keyframes[lastKeyframeIndex]->containsTime(frame)) {
-          break;
-        }
-      }
-    } else {
-      while (lastKeyframeIndex < keyframes.size() - 1) {
-        lastKeyframeIndex++;
-        if (keyframes[lastKeyframeIndex]->containsTime(frame)) {
-          break;
-        }
-      }
+    if (frame >= keyframe->endTime) {
+      return keyframe->endValue;
     }
-    lastKeyframe = keyframes[lastKeyframeIndex];
-    if (frame <= lastKeyframe->startTime) {
-      result = lastKeyframe->startValue;
-    } else if (frame >= lastKeyframe->endTime) {
-      result = lastKeyframe->endValue;
-    } else {
-      result = lastKeyframe->getValueAt(frame);
+    return keyframe->getValueAt(frame);
+  }
+
+  /**
+   * Returns the keyframe which contains the specified frame. Returns the first keyframe if the
+   * frame is before all keyframes, and the last keyframe if the frame is after all keyframes.
+   */
+  Keyframe<T>* findKeyframeAt(Frame frame) const {
+    // The keyframes are sorted by time, finds the last keyframe that starts at or before the frame.
+    auto position = std::upper_bound(
+        keyframes.begin(), keyframes.end(), frame,
+        [](Frame time, const Keyframe<T>* keyframe) { return time < keyframe->startTime; });
+    if (position == keyframes.begin()) {
+      return keyframes.front();
     }
-    return result;
+    return *(position - 1);
   }
 
   /**
@@ -337,9 +338,6 @@ class AnimatableProperty : public Property<T> {
    */
   std::vector<Keyframe<T>*> keyframes;
 
- private:
-  std::atomic_size_t lastKeyframeIndex;
-
   RTTR_ENABLE(Property<T>)
 };
 
@@ -1545,6 +1543,8 @@ class VectorComposition;
 
 class BitmapComposition;
 
+class DeferredVideoTags;
+
 class ImageBytes;
 
 class PAG_API Cache {
@@ -2124,10 +2124,17 @@ class PAG_API VideoComposition : public Composition {
   CompositionType type() const override;
 
   /**
-   * The video frames of the Composition. It is sorted in ascending order.
+   * The video frames of the Composition. It is sorted in ascending order. It stays empty until
+   * loadSequences() is called if the composition is loaded by the lazy decoding mode.
    */
   std::vector<VideoSequence*> sequences;
 
+  /**
+   * Decodes the sequences deferred by the lazy decoding mode of File. It is thread-safe and does
+   * nothing if the sequences have already been decoded. Sequence::Get() calls it implicitly.
+   */
+  void loadSequences();
+
   bool hasImageContent() const override;
 
   bool verify() const override;
@@ -2135,6 +2142,12 @@ class PAG_API VideoComposition : public Composition {
  protected:
   void updateStaticTimeRanges() override;
 
+ private:
+  DeferredVideoTags* deferredTags = nullptr;
+  std::once_flag deferredTagsDecoded = {};
+
+  friend class DeferredVideoTags;
+
   RTTR_ENABLE(Composition)
 };
 
@@ -2204,6 +2217,37 @@ class PAG_API File {
    */
   static std::shared_ptr<File> Load(const std::string& filePath);
 
+  /**
+   * Returns true if the files loaded from paths are memory-mapped. The default value is false.
+   */
+  static bool MemoryMapEnabled();
+
+  /**
+   * If set to true, the files loaded from paths are mapped into memory instead of being read into
+   * a buffer, and the payloads of images, bitmap frames, audios and MP4 headers reference the mapped
+   * pages directly instead of being copied, so the loading no longer holds a second copy of them.
+   * The file must not be modified or truncated while any File loaded from it is alive. It falls
+   * back to reading the file if memory mapping is not supported on current platform.
+   */
+  static void SetMemoryMapEnabled(bool value);
+
+  /**
+   * Returns true if the sequences of video compositions are decoded on demand. The default value
+   * is false.
+   */
+  static bool LazyDecodingEnabled();
+
+  /**
+   * If set to true, the sequences of video compositions are left undecoded during loading, and each
+   * of them is decoded when its composition is rendered for the first time, so the loading time no
+   * longer grows with the video frames that are never displayed. The undecoded sequences reference
+   * the file data in place, which is the mapped pages if the memory mapping is enabled, otherwise
+   * the File keeps the bytes it is loaded from instead of copying each payload. Only the sequences
+   * of video compositions are deferred, the vector and bitmap compositions are always decoded during
+   * loading.
+   */
+  static void SetLazyDecodingEnabled(bool value);
+
   ~File();
 
   /**
@@ -2298,6 +2342,11 @@ class PAG_API File {
   // Just references, no need to delete them.
   std::vector<std::vector<ImageLayer*>> imageLayers = {};
 
+  // The bytes referenced by the payloads, which are the memory-mapped file, the copy kept by the
+  // lazy decoding, or the decompressed body. It outlives the payloads because ~File() deletes the
+  // compositions and images explicitly before any member is destroyed.
+  std::unique_ptr<ByteData> mappedData = nullptr;
+
   File(std::vector<Composition*> compositionList, std::vector<pag::ImageBytes*> imageList);
   void updateEditables(Composition* composition);
 
@@ -2346,6 +2395,14 @@ class PAG_API Codec {
   static std::shared_ptr<File> Decode(const void* bytes, uint32_t byteLength,
                                       const std::string& path);
 
+  /**
+   * Decode a pag file from the specified memory-mapped data, the payloads of the returned file
+   * reference the data directly, and the file takes ownership of it. Returns null if the data is
+   * not a valid pag file.
+   */
+  static std::shared_ptr<File> Decode(std::unique_ptr<ByteData> mappedData,
+                                      const std::string& path);
+
   /**
    * Encode a pag file to byte data, return null if the file is null.
    */
@@ -2358,6 +2415,17 @@ class PAG_API Codec {
   static std::unique_ptr<ByteData> Encode(std::shared_ptr<File> pagFile,
                                           std::shared_ptr<PerformanceData> performanceData);
 
+  /**
+   * Encode a pag file with the corresponding performance data to byte data. If compressBody is
+   * true, the tags are compressed by the LZ4 algorithm in independent chunks that each hold whole
+   * tags, so the decoder reads the tags of a chunk as soon as it is decompressed. The compressed
+   * files can not be decoded by the SDKs that do not support compression. Returns null if the file
+   * is null.
+   */
+  static std::unique_ptr<ByteData> Encode(std::shared_ptr<File> pagFile,
+                                          std::shared_ptr<PerformanceData> performanceData,
+                                          bool compressBody);
+
   /**
    * Read the performance data from the specified byte data, return null if the byte data contains
    * no performance data.
@@ -2366,6 +2434,9 @@ class PAG_API Codec {
                                                               uint32_t byteLength);
 
  protected:
+  static std::shared_ptr<File> Decode(CodecContext* context, const void* bytes,
+                                      uint32_t byteLength, const std::string& path);
+
   static void UpdateFileAttributes(std::shared_ptr<File> file, CodecContext* context,
                                    const std::string& filePath);
 };
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <functional>  // for windows
 #include <unordered_map>
 #include "pag/decoder.h"
@@ -645,6 +646,8 @@ class PAG_API PAGTextLayer : public PAGLayer {
   friend class PAGFile;
 
   friend class TextReplacement;
+
+  friend class PAGExportSession;
 };
 
 class ShapeLayer;
@@ -806,6 +809,8 @@ class PAG_API PAGImageLayer : public PAGLayer {
   friend class PAGFile;
 
   friend class AudioClip;
+
+  friend class PAGExportSession;
 };
 
 class PreComposeLayer;
@@ -1023,6 +1028,35 @@ class PAG_API PAGFile : public PAGComposition {
    */
   static std::shared_ptr<PAGFile> Load(const std::string& filePath);
 
+  /**
+   * Returns true if the pag files loaded from paths are memory-mapped. The default value is false.
+   */
+  static bool MemoryMapEnabled();
+
+  /**
+   * If set to true, the pag files loaded from paths are mapped into memory instead of being read
+   * into a buffer, and the embedded images, bitmap frames and audios reference the mapped pages
+   * directly, so the loading no longer holds a second copy of them. The files must not be modified
+   * or truncated while they are in use. It falls back to reading the files if memory mapping is not
+   * supported on current platform.
+   */
+  static void SetMemoryMapEnabled(bool value);
+
+  /**
+   * Returns true if the video sequences in pag files are decoded on demand. The default value is
+   * false.
+   */
+  static bool LazyDecodingEnabled();
+
+  /**
+   * If set to true, the video sequences in pag files are decoded when they are rendered for the
+   * first time instead of during loading, which shortens the loading time of the files that contain
+   * many videos. The pag files keep the loaded bytes or the mapped pages alive to decode them later.
+   * Only the video sequences are deferred, the vector and bitmap compositions are still decoded
+   * during loading.
+   */
+  static void SetLazyDecodingEnabled(bool value);
+
   PAGFile(std::shared_ptr<File> file, PreComposeLayer* layer);
 
   /**
@@ -1218,6 +1252,35 @@ class PAG_API PAGSurface {
    */
   bool readPixels(ColorType colorType, AlphaType alphaType, void* dstPixels, size_t dstRowBytes);
 
+  /**
+   * Queues a copy of the pixels of current PAGSurface with specified color type and alpha type
+   * without waiting for the GPU, so the next frame can be rendered while the current one is being
+   * read back. The callback is invoked on the calling thread once the copy is complete, either
+   * during a later call to readPixelsAsync() or during finishPixelReads(), always in the order the
+   * copies are queued. The pixels passed to the callback are only valid during the call, and are
+   * nullptr if the copy failed. The callback must not access this PAGSurface. Falls back to a
+   * synchronous copy if the GPU does not support pixel buffer objects. Returns false if the copy
+   * can not be queued.
+   */
+  bool readPixelsAsync(ColorType colorType, AlphaType alphaType,
+                       std::function<void(const void* pixels, size_t rowBytes)> callback);
+
+  /**
+   * Waits for all copies queued by readPixelsAsync() and invokes their callbacks. Call this before
+   * releasing the PAGSurface or changing its size, otherwise the pending callbacks are discarded.
+   */
+  void finishPixelReads();
+
+  /**
+   * Converts the pixels of current PAGSurface to YUV on the GPU and copies only the resulting planes
+   * to dstPlanes. I420 needs three planes (Y, U, V) and NV12 needs two (Y, interleaved UV). The
+   * chroma planes are subsampled by 2x2 and have (width + 1) / 2 columns and (height + 1) / 2 rows.
+   * Falls back to converting on the CPU if the GPU can not render to single-channel textures.
+   * Returns true if pixels are copied to dstPlanes.
+   */
+  bool readYUVPixels(YUVFormat format, YUVColorSpace colorSpace, YUVColorRange colorRange,
+                     uint8_t* const dstPlanes[], const size_t dstRowBytes[]);
+
  private:
   uint32_t contentVersion = 0;
   PAGPlayer* pagPlayer = nullptr;
@@ -1244,6 +1307,151 @@ class PAG_API PAGSurface {
 
 class FileReporter;
 
+class TaskGroup;
+
+/**
+ * PAGThreadPool is a named group of worker threads used to decode images, bitmap sequences and
+ * video sequences in the background. By default, all PAGPlayers share one thread pool which has one
+ * thread per CPU core. Creating dedicated thread pools and binding them to PAGPlayers can isolate
+ * the decoding work of different tenants from each other.
+ */
+class PAG_API PAGThreadPool {
+ public:
+  /**
+   * Creates a new PAGThreadPool with the specified name and number of threads. If cpuAffinity is
+   * not empty, the threads are only allowed to run on the listed CPU cores, which is only supported
+   * on Linux and Android. Returns nullptr if threadCount is less than 1 or the threads can not be
+   * created. Returns nullptr on the web platform.
+   */
+  static std::shared_ptr<PAGThreadPool> Make(const std::string& name, int threadCount,
+                                             const std::vector<int>& cpuAffinity = {});
+
+  /**
+   * Returns the name of this thread pool.
+   */
+  std::string name() const;
+
+  /**
+   * Returns the number of threads in this thread pool.
+   */
+  int threadCount() const;
+
+  /**
+   * Returns the number of tasks waiting to be executed.
+   */
+  int queueDepth() const;
+
+  /**
+   * Returns the total time in microseconds all threads spent on executing tasks.
+   */
+  int64_t busyTime() const;
+
+  /**
+   * Returns the number of tasks executed by this thread pool.
+   */
+  int64_t completedTasks() const;
+
+ private:
+  std::shared_ptr<TaskGroup> taskGroup = nullptr;
+
+  explicit PAGThreadPool(std::shared_ptr<TaskGroup> taskGroup);
+
+  friend class PAGPlayer;
+};
+
+/**
+ * Defines the limits in bytes of the graphics memory that a PAGPlayer can use for each category of
+ * its internal caches. After each frame is drawn, if a category exceeds its limit, the caches of
+ * that category which are not used by that frame are released, the least recently used ones first,
+ * until the category fits in its limit again. The snapshots are released in the order of their
+ * reuse value instead, which also takes the cost of making them again into account.
+ */
+struct PAGCacheBudget {
+  /**
+   * The limit of the bitmap caches of the static layer contents. No more snapshot is created once
+   * it is reached. The default value is 300 MB.
+   */
+  size_t snapshots = 314572800;
+
+  /**
+   * The limit of the glyph atlases of the text layers. The default value is unlimited.
+   */
+  size_t textAtlases = SIZE_MAX;
+
+  /**
+   * The limit of the decoded frames of the bitmap and video sequences. The default value is
+   * unlimited.
+   */
+  size_t sequenceReaders = SIZE_MAX;
+
+  /**
+   * The limit of the decoded frames kept resident for the short looping video sequences. If it is
+   * greater than 0, each video sequence no longer than 3 seconds keeps all of its frames after the
+   * first pass as long as they fit in the remaining limit, then its later loops cost no decoding.
+   * The frames decoded by hardware video decoders can not be kept. The default value is 0, which
+   * disables it.
+   */
+  size_t loopingVideoFrames = 0;
+
+  /**
+   * The limit of the intermediate frame buffers held by the layer effects and styles. The default
+   * value is unlimited.
+   */
+  size_t filterBuffers = SIZE_MAX;
+
+  /**
+   * The limit of the estimated memory held by the upcoming layers decoded ahead of becoming
+   * visible. Once it is reached, the farther layers start decoding when they become visible. The
+   * default value is 64 MB.
+   */
+  size_t prefetchMemory = 67108864;
+
+  /**
+   * The unused snapshots are released immediately if the total memory of snapshots and text
+   * atlases exceeds this value. The default value is 20 MB.
+   */
+  size_t purgeableMemory = 20971520;
+
+  /**
+   * The number of frames an unused snapshot is kept for when the total memory of snapshots and
+   * text atlases is less than purgeableMemory. The default value is 10.
+   */
+  int expiredFrames = 10;
+};
+
+/**
+ * Describes the graphics memory in bytes currently used by each category of the internal caches of
+ * a PAGPlayer.
+ */
+struct PAGCacheUsage {
+  size_t snapshots = 0;
+  size_t textAtlases = 0;
+  size_t sequenceReaders = 0;
+  size_t filterBuffers = 0;
+};
+
+/**
+ * Defines how the bitmap caches of images and static layers follow the changes of their scale
+ * factors, such as during zooming animations.
+ */
+enum class PAGSnapshotScaleMode {
+  /**
+   * The bitmap caches are rasterized again whenever the scale factor changes.
+   */
+  Exact,
+  /**
+   * The scale factors are rounded up to powers of √2. A bitmap cache is reused as long as the
+   * content is drawn at no less than half of its scale, and it is sampled down with mipmaps.
+   */
+  Bucketed,
+  /**
+   * Same as Bucketed, but when the content is drawn at less than half of the scale, a second bitmap
+   * cache at the smaller bucket is kept along with the first one, which avoids rasterizing again
+   * when zooming back and forth between them.
+   */
+  BucketedWithDownscale
+};
+
 class PAG_API PAGPlayer {
  public:
   PAGPlayer();
@@ -1307,6 +1515,19 @@ class PAG_API PAGPlayer {
    */
   void setCacheScale(float value);
 
+  /**
+   * Returns the thread pool used by this PAGPlayer for background decoding. Returns nullptr if it
+   * uses the default thread pool shared by the whole process.
+   */
+  std::shared_ptr<PAGThreadPool> threadPool();
+
+  /**
+   * Binds this PAGPlayer to the specified thread pool for background decoding. Set to nullptr to
+   * use the default thread pool shared by the whole process. Changing the thread pool releases all
+   * pending decoding tasks and sequence caches of this PAGPlayer.
+   */
+  void setThreadPool(std::shared_ptr<PAGThreadPool> pool);
+
   /**
    * The maximum frame rate for rendering, ranges from 1 to 60. If set to a value less than the
    * actual frame rate from composition, it drops frames but increases performance. Otherwise, it
@@ -1471,10 +1692,100 @@ class PAG_API PAGPlayer {
   int64_t presentingTime();
 
   /**
-   * The memory cost by graphics in bytes.
+   * The memory cost by graphics in bytes, including the estimated CPU memory of the per-frame
+   * contents kept by the layers.
    */
   int64_t graphicsMemory();
 
+  /**
+   * Returns the memory limits of the internal caches of this PAGPlayer.
+   */
+  PAGCacheBudget cacheBudget();
+
+  /**
+   * Sets the memory limits of the internal caches of this PAGPlayer. The caches exceeding the new
+   * limits are released on the next flush.
+   */
+  void setCacheBudget(const PAGCacheBudget& budget);
+
+  /**
+   * Returns the graphics memory currently used by each category of the internal caches.
+   */
+  PAGCacheUsage cacheUsage();
+
+  /**
+   * If set to true, the bitmap caches of images and static layers and the glyph atlases of text
+   * layers are shared with other PAGPlayers which have also enabled it and render on the same GPU
+   * device. This can significantly reduce the graphics memory and rasterizing time when many
+   * PAGPlayers render the same PAGFile at the same size. The default value is false.
+   */
+  bool sharedCacheEnabled();
+
+  /**
+   * Set the value of sharedCacheEnabled property.
+   */
+  void setSharedCacheEnabled(bool value);
+
+  /**
+   * Returns the memory limit in bytes of the caches shared between PAGPlayers on each GPU device.
+   * Only the caches no longer used by any PAGPlayer are released when it is exceeded. The default
+   * value is 64 MB.
+   */
+  static size_t SharedCacheBudget();
+
+  /**
+   * Sets the memory limit in bytes of the caches shared between PAGPlayers on each GPU device.
+   */
+  static void SetSharedCacheBudget(size_t budget);
+
+  /**
+   * Returns the memory limit in bytes of the per-frame contents (shapes, texts, masks and
+   * transforms) kept by the layers of all PAGFiles in the process. Once it is exceeded, the frames
+   * farthest from the ones being rendered are released. The default value is 64 MB.
+   */
+  static size_t FrameCacheBudget();
+
+  /**
+   * Sets the memory limit in bytes of the per-frame contents kept by the layers of all PAGFiles in
+   * the process. Set it to SIZE_MAX to keep all frames until the PAGFiles are released.
+   */
+  static void SetFrameCacheBudget(size_t budget);
+
+  /**
+   * Returns how the bitmap caches of images and static layers follow the changes of their scale
+   * factors. The default value is PAGSnapshotScaleMode::Exact.
+   */
+  PAGSnapshotScaleMode snapshotScaleMode();
+
+  /**
+   * Sets how the bitmap caches of images and static layers follow the changes of their scale
+   * factors. All existing bitmap caches are released if the mode changes.
+   */
+  void setSnapshotScaleMode(PAGSnapshotScaleMode mode);
+
+  /**
+   * Returns the number of frames decoded ahead in background for each video or bitmap sequence.
+   * The default value is 1.
+   */
+  int sequenceLookahead();
+
+  /**
+   * Sets the number of frames decoded ahead in background for each video or bitmap sequence.
+   * Values greater than 1 keep the decoded frames in a ring of buffers, which absorbs the frames
+   * taking longer than one frame interval to decode, at the cost of one frame of memory per
+   * buffer. The frames decoded by hardware video decoders can not be buffered, only one frame is
+   * decoded ahead for them.
+   */
+  void setSequenceLookahead(int frames);
+
+  /**
+   * Returns how far ahead in microseconds each upcoming layer started decoding during the last
+   * flush, keyed by the uniqueID of the layers. The distance of a layer grows with the measured
+   * decoding and uploading time of its content and the current playback rate, and the layers
+   * beyond cacheBudget().prefetchMemory are not decoded ahead. It is useful for tuning the budget.
+   */
+  std::unordered_map<ID, int64_t> prefetchHorizons();
+
  protected:
   std::shared_ptr<std::mutex> rootLocker = nullptr;
   std::shared_ptr<PAGStage> stage = nullptr;
@@ -1488,6 +1799,7 @@ class PAG_API PAGPlayer {
 
  private:
   FileReporter* reporter = nullptr;
+  std::shared_ptr<PAGThreadPool> _threadPool = nullptr;
   float _maxFrameRate = 60;
   int _scaleMode = PAGScaleMode::LetterBox;
   bool _autoClear = true;
@@ -1501,6 +1813,54 @@ class PAG_API PAGPlayer {
   friend class PAGSurface;
 };
 
+/**
+ * PAGExportSession renders a range of frames from a PAGFile off-screen on multiple worker threads.
+ * Each worker has its own PAGSurface, PAGPlayer and render cache, while the immutable file data is
+ * shared between them. The text and image replacements applied to the PAGFile at the time
+ * exportFrames() is called are copied to all workers. Rendered frames are always delivered in order
+ * on the calling thread.
+ */
+class PAG_API PAGExportSession {
+ public:
+  /**
+   * The callback to receive the pixels of one exported frame. The pixels are only valid during the
+   * call. Returns false to cancel the remaining frames.
+   */
+  using FrameCallback = std::function<bool(Frame frame, const void* pixels, size_t rowBytes)>;
+
+  /**
+   * Creates a new PAGExportSession to render the specified PAGFile at the specified size. If
+   * workerCount is less than 1, the number of CPU cores is used. Returns nullptr if pagFile is
+   * nullptr or the size is not valid.
+   */
+  static std::shared_ptr<PAGExportSession> Make(std::shared_ptr<PAGFile> pagFile, int width,
+                                                int height, int workerCount = 0);
+
+  /**
+   * Returns the number of worker threads used to render frames.
+   */
+  int workerCount() const {
+    return _workerCount;
+  }
+
+  /**
+   * Renders the frames in the range [startFrame, endFrame] and passes their pixels to the callback
+   * in order. Frames are counted at the frame rate of the PAGFile. Returns false if any frame fails
+   * to render or the callback cancels the export.
+   */
+  bool exportFrames(Frame startFrame, Frame endFrame, ColorType colorType, AlphaType alphaType,
+                    const FrameCallback& callback);
+
+ private:
+  std::shared_ptr<PAGFile> pagFile = nullptr;
+  int width = 0;
+  int height = 0;
+  int _workerCount = 1;
+
+  PAGExportSession(std::shared_ptr<PAGFile> pagFile, int width, int height, int workerCount);
+  std::shared_ptr<PAGFile> copyFile();
+};
+
 /**
  * Defines methods to control video decoding capabilities of PAG.
  */
@@ -1516,6 +1876,21 @@ class PAG_API PAGVideoDecoder {
    * decoding video sequences from a pag file, if hardware decoders are not available.
    */
   static void RegisterSoftwareDecoderFactory(SoftwareDecoderFactory* decoderFactory);
+
+  /**
+   * Set the number of threads used by each built-in software video decoder (libavc), which uses up
+   * to 3 threads. More threads speed up decoding large video sequences, but take CPU time from
+   * the other work. It has no effect on the decoders created by a registered
+   * SoftwareDecoderFactory. The default value is 1.
+   */
+  static void SetSoftwareDecoderThreadCount(int count);
+
+  /**
+   * Set the maximum number of idle software video decoders that PAG keeps for reusing. A video
+   * sequence reuses an idle decoder of the same video format rather than creating a new one. Idle
+   * decoders are released after 5 seconds. Set it to 0 to disable reusing. The default value is 4.
+   */
+  static void SetMaxIdleDecoderCount(int count);
 };
 
 class PAG_API PAG {
@@ -1456,6 +1456,12 @@ class PAG_API ByteData {
    * Creates a ByteData object from the specified file path.
    */
   static std::unique_ptr<ByteData> FromPath(const std::string& filePath);
+  /**
+   * Creates a read-only ByteData object which maps the specified file into memory. The pages are
+   * loaded on demand and shared with the system page cache. Returns nullptr if the file does not
+   * exist or memory mapping is not supported on current platform.
+   */
+  static std::unique_ptr<ByteData> MapFromPath(const std::string& filePath);
   /**
    * Creates a ByteData object and copy the specified data into it.
    */
@@ -1562,6 +1568,48 @@ enum class ColorType {
   BGRA_8888,
 };
 
+/**
+ * Describes the plane layout of YUV pixels.
+ */
+enum class YUVFormat {
+  /**
+   * 8-bit Y plane followed by 8-bit 2x2 subsampled U and V planes.
+   */
+  I420,
+  /**
+   * 8-bit Y plane followed by an interleaved U/V plane with 2x2 subsampling.
+   */
+  NV12,
+};
+
+/**
+ * Describes the matrix used to convert RGB to YUV.
+ */
+enum class YUVColorSpace {
+  /**
+   * ITU-R BT.601, used by SDTV.
+   */
+  Rec601,
+  /**
+   * ITU-R BT.709, used by HDTV.
+   */
+  Rec709,
+};
+
+/**
+ * Describes the value range of YUV pixels.
+ */
+enum class YUVColorRange {
+  /**
+   * The limited "MPEG" range, Y in [16, 235] and UV in [16, 240].
+   */
+  MPEG,
+  /**
+   * The full "JPEG" range, all components in [0, 255].
+   */
+  JPEG,
+};
+
 class PAG_API BlendMode {
  public:
   static const Enum Normal = 0;
@@ -19,6 +19,14 @@
 #include "pag/file.h"
 #include "tgfx/core/Stream.h"
 
+#if !defined(_WIN32) && !defined(PAG_BUILD_FOR_WEB)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PAG_USE_MMAP
+#endif
+
 namespace pag {
 std::unique_ptr<ByteData> ByteData::FromPath(const std::string& filePath) {
   auto stream = tgfx::Stream::MakeFromFile(filePath);
@@ -33,6 +41,33 @@ std::unique_ptr<ByteData> ByteData::FromPath(const std::string& filePath) {
   return data;
 }
 
+std::unique_ptr<ByteData> ByteData::MapFromPath(const std::string& filePath) {
+#ifdef PAG_USE_MMAP
+  auto fd = open(filePath.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat fileStat = {};
+  if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+    close(fd);
+    return nullptr;
+  }
+  auto length = static_cast<size_t>(fileStat.st_size);
+  auto address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid after the file descriptor is closed.
+  close(fd);
+  if (address == MAP_FAILED) {
+    return nullptr;
+  }
+  auto byteData = new ByteData(reinterpret_cast<uint8_t*>(address), length,
+                               [length](uint8_t* data) { munmap(data, length); });
+  return std::unique_ptr<ByteData>(byteData);
+#else
+  (void)filePath;
+  return nullptr;
+#endif
+}
+
 std::unique_ptr<ByteData> ByteData::MakeCopy(const void* bytes, size_t length) {
   if (length == 0) {
     return Make(0);
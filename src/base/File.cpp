@@ -18,6 +18,7 @@
 
 #include "pag/file.h"
 #include <algorithm>
+#include <atomic>
 #include <unordered_map>
 
 namespace pag {
@@ -54,7 +55,51 @@ static std::shared_ptr<File> FindFileByPath(const std::string& filePath) {
   return nullptr;
 }
 
+static std::atomic<bool> memoryMapEnabled = {false};
+
+bool File::MemoryMapEnabled() {
+  return memoryMapEnabled;
+}
+
+void File::SetMemoryMapEnabled(bool value) {
+  memoryMapEnabled = value;
+}
+
+static std::atomic<bool> lazyDecodingEnabled = {false};
+
+bool File::LazyDecodingEnabled() {
+  return lazyDecodingEnabled;
+}
+
+void File::SetLazyDecodingEnabled(bool value) {
+  lazyDecodingEnabled = value;
+}
+
+static void CacheFileByPath(std::shared_ptr<File> file, const std::string& filePath) {
+  std::lock_guard<std::mutex> autoLock(globalLocker);
+  std::weak_ptr<File> weak = file;
+  weakFileMap.insert(std::make_pair(filePath, std::move(weak)));
+}
+
 std::shared_ptr<File> File::Load(const std::string& filePath) {
+  if (memoryMapEnabled || lazyDecodingEnabled) {
+    auto file = FindFileByPath(filePath);
+    if (file != nullptr) {
+      return file;
+    }
+    // The File takes the data, so the payloads and the deferred sequences reference it in place.
+    auto data = memoryMapEnabled ? ByteData::MapFromPath(filePath) : nullptr;
+    if (data == nullptr && lazyDecodingEnabled) {
+      data = ByteData::FromPath(filePath);
+    }
+    if (data != nullptr) {
+      file = Codec::Decode(std::move(data), filePath);
+      if (file != nullptr) {
+        CacheFileByPath(file, filePath);
+      }
+      return file;
+    }
+  }
   auto byteData = ByteData::FromPath(filePath);
   if (byteData == nullptr) {
     return nullptr;
@@ -71,11 +116,15 @@ std::shared_ptr<File> File::Load(const void* bytes, size_t length, const std::st
   if (file != nullptr) {
     return file;
   }
-  file = Codec::Decode(bytes, static_cast<uint32_t>(length), filePath);
+  if (lazyDecodingEnabled) {
+    // The deferred sequences are decoded after this call returns, so the File keeps a copy of the
+    // bytes, which replaces the copies of the payloads made by the eager decoding.
+    file = Codec::Decode(ByteData::MakeCopy(bytes, length), filePath);
+  } else {
+    file = Codec::Decode(bytes, static_cast<uint32_t>(length), filePath);
+  }
   if (file != nullptr) {
-    std::lock_guard<std::mutex> autoLock(globalLocker);
-    std::weak_ptr<File> weak = file;
-    weakFileMap.insert(std::make_pair(filePath, std::move(weak)));
+    CacheFileByPath(file, filePath);
   }
   return file;
 }
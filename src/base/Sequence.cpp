@@ -25,8 +25,13 @@ Sequence* Sequence::Get(Composition* composition) {
   // one for best rendering quality, ignore all others.
   if (composition != nullptr) {
     switch (composition->type()) {
-      case CompositionType::Video:
-        return static_cast<VideoComposition*>(composition)->sequences.back();
+      case CompositionType::Video: {
+        auto videoComposition = static_cast<VideoComposition*>(composition);
+        videoComposition->loadSequences();
+        auto& sequences = videoComposition->sequences;
+        // The sequences are empty if the deferred tags failed to decode.
+        return sequences.empty() ? nullptr : sequences.back();
+      }
       case CompositionType::Bitmap:
         return static_cast<BitmapComposition*>(composition)->sequences.back();
       default:
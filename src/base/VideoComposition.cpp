@@ -17,6 +17,7 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "base/utils/Verify.h"
+#include "codec/DeferredVideoTags.h"
 #include "pag/file.h"
 
 namespace pag {
@@ -24,6 +25,14 @@ VideoComposition::~VideoComposition() {
   for (auto sequence : sequences) {
     delete sequence;
   }
+  delete deferredTags;
+}
+
+void VideoComposition::loadSequences() {
+  if (deferredTags == nullptr) {
+    return;
+  }
+  std::call_once(deferredTagsDecoded, [this]() { deferredTags->decode(this); });
 }
 
 CompositionType VideoComposition::type() const {
@@ -35,10 +44,12 @@ void VideoComposition::updateStaticTimeRanges() {
   if (duration <= 1) {
     return;
   }
-  if (!sequences.empty()) {
-    auto sequence = sequences[0];
-    for (size_t i = 1; i < sequences.size(); i++) {
-      auto item = sequences[i];
+  // The summaries of the deferred sequences carry the same static time ranges.
+  auto& list = deferredTags != nullptr ? deferredTags->summaries : sequences;
+  if (!list.empty()) {
+    auto sequence = list[0];
+    for (size_t i = 1; i < list.size(); i++) {
+      auto item = list[i];
       if (item->frameRate > sequence->frameRate) {
         sequence = item;
       }
@@ -60,6 +71,13 @@ bool VideoComposition::hasImageContent() const {
 }
 
 bool VideoComposition::verify() const {
+  if (deferredTags != nullptr) {
+    // The deferred sequences are verified after they are decoded.
+    auto& summaries = deferredTags->summaries;
+    auto summaryValid = [](VideoSequence* summary) { return summary->Sequence::verify(); };
+    VerifyAndReturn(Composition::verify() && !summaries.empty() &&
+                    std::all_of(summaries.begin(), summaries.end(), summaryValid));
+  }
   if (!Composition::verify() || sequences.empty()) {
     VerifyFailed();
     return false;
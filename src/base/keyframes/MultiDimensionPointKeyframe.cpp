@@ -34,7 +34,7 @@ void MultiDimensionPointKeyframe::initialize() {
   }
 }
 
-Point MultiDimensionPointKeyframe::getValueAt(Frame time) {
+Point MultiDimensionPointKeyframe::getValueAt(Frame time) const {
   auto progress = static_cast<float>(time - this->startTime) / (this->endTime - this->startTime);
   auto xProgress = xInterpolator->getInterpolation(progress);
   auto yProgress = yInterpolator->getInterpolation(progress);
@@ -28,7 +28,7 @@ class MultiDimensionPointKeyframe : public Keyframe<Point> {
 
   void initialize() override;
 
-  Point getValueAt(Frame time) override;
+  Point getValueAt(Frame time) const override;
 
  private:
   Interpolator* xInterpolator = nullptr;
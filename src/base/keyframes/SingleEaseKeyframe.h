@@ -37,12 +37,12 @@ class SingleEaseKeyframe : public Keyframe<T> {
     }
   }
 
-  float getProgress(Frame time) {
+  float getProgress(Frame time) const {
     auto progress = static_cast<float>(time - this->startTime) / (this->endTime - this->startTime);
     return interpolator->getInterpolation(progress);
   }
 
-  T getValueAt(Frame time) override {
+  T getValueAt(Frame time) const override {
     auto progress = getProgress(time);
     return Interpolate(this->startValue, this->endValue, progress);
   }
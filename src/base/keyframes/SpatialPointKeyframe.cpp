@@ -25,7 +25,7 @@ void SpatialPointKeyframe::initialize() {
       BezierPath::Build(startValue, startValue + spatialOut, endValue + spatialIn, endValue, 0.05f);
 }
 
-Point SpatialPointKeyframe::getValueAt(Frame time) {
+Point SpatialPointKeyframe::getValueAt(Frame time) const {
   auto progress = getProgress(time);
   return spatialBezier->getPosition(progress);
 }
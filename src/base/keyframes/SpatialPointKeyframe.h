@@ -24,7 +24,7 @@ namespace pag {
 class SpatialPointKeyframe : public SingleEaseKeyframe<Point> {
  public:
   void initialize() override;
-  Point getValueAt(Frame time) override;
+  Point getValueAt(Frame time) const override;
 
  private:
   std::shared_ptr<BezierPath> spatialBezier = nullptr;
@@ -23,7 +23,7 @@ BezierEasing::BezierEasing(const Point& control1, const Point& control2) {
   bezierPath = BezierPath::Build(Point::Zero(), control1, control2, Point::Make(1, 1), 0.005f);
 }
 
-float BezierEasing::getInterpolation(float input) {
+float BezierEasing::getInterpolation(float input) const {
   if (input <= 0) {
     return 0;
   }
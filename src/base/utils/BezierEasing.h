@@ -35,7 +35,7 @@ class BezierEasing : public Interpolator {
    * @return The interpolation value. This value can be more than 1.0 for interpolators which
    * overshoot their targets, or less than 0 for interpolators that undershoot their targets.
    */
-  float getInterpolation(float input) override;
+  float getInterpolation(float input) const override;
 
  private:
   std::shared_ptr<BezierPath> bezierPath = nullptr;
@@ -34,7 +34,7 @@ class Interpolator {
    * @return The interpolation value. This value can be more than 1.0 for interpolators which
    * overshoot their targets, or less than 0 for interpolators that undershoot their targets.
    */
-  virtual float getInterpolation(float input) {
+  virtual float getInterpolation(float input) const {
     return input;
   }
 };
@@ -19,14 +19,23 @@
 #ifndef PAG_BUILD_FOR_WEB
 
 #include "Task.h"
-#include <algorithm>
+#include <iterator>
+#include "tgfx/core/Clock.h"
 
 #ifdef __APPLE__
 
+#include <pthread.h>
 #include <sys/sysctl.h>
 
 #endif
 
+#ifdef __linux__
+
+#include <pthread.h>
+#include <sched.h>
+
+#endif
+
 namespace pag {
 
 int GetCPUCores() {
@@ -44,12 +53,19 @@ int GetCPUCores() {
   return cpuCores;
 }
 
-std::shared_ptr<Task> Task::Make(std::unique_ptr<Executor> executor) {
-  return std::shared_ptr<Task>(new Task(std::move(executor)));
+std::shared_ptr<Task> Task::Make(std::unique_ptr<Executor> executor, TaskPriority priority,
+                                 int64_t deadline, std::shared_ptr<TaskGroup> taskGroup) {
+  return std::shared_ptr<Task>(
+      new Task(std::move(executor), priority, deadline, std::move(taskGroup)));
 }
 
-Task::Task(std::unique_ptr<Executor> executor) : executor(std::move(executor)) {
-  taskGroup = TaskGroup::GetInstance();
+Task::Task(std::unique_ptr<Executor> executor, TaskPriority priority, int64_t deadline,
+           std::shared_ptr<TaskGroup> group)
+    : taskGroup(std::move(group)), executor(std::move(executor)), priority(priority),
+      deadline(deadline) {
+  if (taskGroup == nullptr) {
+    taskGroup = TaskGroup::GetInstance();
+  }
 }
 
 Task::~Task() {
@@ -75,7 +91,17 @@ Executor* Task::wait() {
   if (!running) {
     return executor.get();
   }
-  condition.wait(autoLock);
+  if (taskGroup->removeTask(this)) {
+    // The task is still waiting in the queue, execute it on the current thread directly rather
+    // than waiting behind the other tasks for a free worker.
+    autoLock.unlock();
+    executor->execute();
+    autoLock.lock();
+    running = false;
+    condition.notify_all();
+    return executor.get();
+  }
+  condition.wait(autoLock, [this] { return !running; });
   return executor.get();
 }
 
@@ -88,7 +114,7 @@ void Task::cancel() {
     running = false;
     return;
   }
-  condition.wait(autoLock);
+  condition.wait(autoLock, [this] { return !running; });
 }
 
 void Task::execute() {
@@ -98,25 +124,81 @@ void Task::execute() {
   condition.notify_all();
 }
 
-TaskGroup* TaskGroup::GetInstance() {
-  static TaskGroup taskGroup = {};
-  if (taskGroup.threads.empty()) {
-    taskGroup.initThreads();
+// The TaskGroup and queue index of current worker thread, tasks pushed from a worker thread are
+// added to its own queue first.
+static thread_local TaskGroup* currentGroup = nullptr;
+static thread_local size_t currentQueueIndex = 0;
+
+std::shared_ptr<TaskGroup> TaskGroup::GetInstance() {
+  static const int CPUCores = GetCPUCores();
+  static auto taskGroup = std::shared_ptr<TaskGroup>(new TaskGroup("pag", CPUCores, {}));
+  if (taskGroup->threads.empty()) {
+    taskGroup->initThreads();
+  }
+  return taskGroup;
+}
+
+std::shared_ptr<TaskGroup> TaskGroup::Make(const std::string& name, int maxThreads,
+                                           const std::vector<int>& cpuAffinity) {
+  if (maxThreads <= 0) {
+    return nullptr;
+  }
+  auto taskGroup = std::shared_ptr<TaskGroup>(new TaskGroup(name, maxThreads, cpuAffinity));
+  if (taskGroup->threads.empty()) {
+    return nullptr;
+  }
+  return taskGroup;
+}
+
+static void InitWorkerThread(const std::string& name, const std::vector<int>& cpuAffinity) {
+#ifdef __APPLE__
+  if (!name.empty()) {
+    pthread_setname_np(name.c_str());
+  }
+#elif defined(__linux__)
+  if (!name.empty()) {
+    // The thread name is restricted to 16 characters, including the terminating null byte.
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+  }
+  if (!cpuAffinity.empty()) {
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (auto cpu : cpuAffinity) {
+      if (cpu >= 0 && cpu < CPU_SETSIZE) {
+        CPU_SET(cpu, &cpuSet);
+      }
+    }
+    sched_setaffinity(0, sizeof(cpuSet), &cpuSet);
   }
-  return &taskGroup;
+#endif
+  (void)name;
+  (void)cpuAffinity;
 }
 
-void TaskGroup::RunLoop(TaskGroup* taskGroup) {
+void TaskGroup::RunLoop(TaskGroup* taskGroup, size_t queueIndex) {
+  currentGroup = taskGroup;
+  currentQueueIndex = queueIndex;
+  InitWorkerThread(taskGroup->_name, taskGroup->cpuAffinity);
   while (true) {
-    auto task = taskGroup->popTask();
+    auto task = taskGroup->popTask(queueIndex);
     if (!task) {
       break;
     }
+    auto startTime = tgfx::Clock::Now();
     task->execute();
+    taskGroup->_busyTime += tgfx::Clock::Now() - startTime;
+    taskGroup->_completedTasks++;
   }
 }
 
-TaskGroup::TaskGroup() {
+TaskGroup::TaskGroup(std::string name, int maxThreads, std::vector<int> cpuAffinity)
+    : _name(std::move(name)), cpuAffinity(std::move(cpuAffinity)) {
+  if (maxThreads <= 0) {
+    maxThreads = 1;
+  }
+  for (int i = 0; i < maxThreads; i++) {
+    queues.push_back(std::make_unique<TaskQueue>());
+  }
   initThreads();
 }
 
@@ -130,57 +212,110 @@ TaskGroup::~TaskGroup() {
 }
 
 void TaskGroup::initThreads() {
-  static const int CPUCores = GetCPUCores();
-  auto maxThreads = CPUCores > 16 ? 16 : CPUCores;
-  for (int i = 0; i < maxThreads; i++) {
-    std::thread thread(&TaskGroup::RunLoop, this);
+  // Each worker thread owns the queue at the same index. Tasks in queues without a running worker
+  // (if some threads failed to start) can still be stolen by the other workers.
+  for (auto i = threads.size(); i < queues.size(); i++) {
+    std::thread thread(&TaskGroup::RunLoop, this, i);
     if (thread.joinable()) {
       threads.emplace_back(std::move(thread));
     } else {
       break;
     }
   }
-  activeThreads = static_cast<int>(threads.size());
 }
 
 void TaskGroup::pushTask(Task* task) {
-  std::lock_guard<std::mutex> autoLock(locker);
-  tasks.push_back(task);
-  condition.notify_one();
+  auto queueIndex = currentGroup == this ? currentQueueIndex : nextQueue++ % queues.size();
+  auto queue = queues[queueIndex].get();
+  auto priority = static_cast<int>(task->priority);
+  {
+    std::lock_guard<std::mutex> autoLock(queue->locker);
+    auto& tasks = queue->tasks[priority];
+    // Most tasks have no deadline or increasing deadlines, so searching from the end is cheap.
+    auto position = tasks.end();
+    while (position != tasks.begin() && (*std::prev(position))->deadline > task->deadline) {
+      position--;
+    }
+    task->taskQueue = queue;
+    task->position = tasks.insert(position, task);
+    task->queued = true;
+  }
+  priorityTasks[priority]++;
+  pendingTasks++;
+  // Only touch the shared locker if there are sleeping workers. A worker always increases the
+  // sleepingThreads before checking the pendingTasks, so the wakeup can not be lost.
+  if (sleepingThreads > 0) {
+    std::lock_guard<std::mutex> autoLock(locker);
+    condition.notify_one();
+  }
 }
 
-Task* TaskGroup::popTask() {
-  std::unique_lock<std::mutex> autoLock(locker);
-  activeThreads--;
-  while (true) {
-    if (tasks.empty()) {
-      condition.wait(autoLock);
-      if (exited) {
-        return nullptr;
+Task* TaskGroup::popTask(size_t queueIndex) {
+  while (!exited) {
+    // Visits the priorities from high to low, so that a task needed by the current frame never
+    // waits behind prefetching tasks in any queue.
+    for (int priority = 0; priority < TASK_PRIORITY_COUNT; priority++) {
+      if (priorityTasks[priority] <= 0) {
+        continue;
       }
-    } else {
+      auto task = takeTask(queueIndex, priority);
+      if (task) {
+        priorityTasks[priority]--;
+        pendingTasks--;
+        return task;
+      }
+    }
+    std::unique_lock<std::mutex> autoLock(locker);
+    sleepingThreads++;
+    condition.wait(autoLock, [this] { return pendingTasks > 0 || exited; });
+    sleepingThreads--;
+  }
+  return nullptr;
+}
+
+Task* TaskGroup::takeTask(size_t queueIndex, int priority) {
+  // Takes the task from the queue of current worker first, then steals from the others.
+  auto queueCount = queues.size();
+  for (size_t i = 0; i < queueCount; i++) {
+    auto queue = queues[(queueIndex + i) % queueCount].get();
+    std::unique_lock<std::mutex> autoLock(queue->locker, std::defer_lock);
+    if (i == 0) {
+      autoLock.lock();
+    } else if (!autoLock.try_lock()) {
+      // Skip the queues that are busy, they will be visited again in the next round.
+      continue;
+    }
+    auto& tasks = queue->tasks[priority];
+    if (!tasks.empty()) {
       auto task = tasks.front();
       tasks.pop_front();
-      activeThreads++;
-      // LOGI("TaskGroup.activeThreads : %d", activeThreads);
+      task->queued = false;
       return task;
     }
   }
+  return nullptr;
 }
 
 bool TaskGroup::removeTask(Task* task) {
-  std::lock_guard<std::mutex> autoLock(locker);
-  auto position = std::find(tasks.begin(), tasks.end(), task);
-  if (position == tasks.end()) {
+  auto queue = task->taskQueue;
+  if (queue == nullptr) {
+    return false;
+  }
+  std::lock_guard<std::mutex> autoLock(queue->locker);
+  if (!task->queued) {
     return false;
   }
-  tasks.erase(position);
+  auto priority = static_cast<int>(task->priority);
+  queue->tasks[priority].erase(task->position);
+  task->queued = false;
+  priorityTasks[priority]--;
+  pendingTasks--;
   return true;
 }
 
 void TaskGroup::exit() {
-  std::lock_guard<std::mutex> autoLock(locker);
   exited = true;
+  std::lock_guard<std::mutex> autoLock(locker);
   condition.notify_all();
 }
 }  // namespace pag
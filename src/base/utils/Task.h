@@ -18,11 +18,44 @@
 
 #pragma once
 
+#include <cstdint>
+
+namespace pag {
+/**
+ * Defines the scheduling priorities of background tasks. Tasks with a higher priority are always
+ * picked by idle worker threads before any task with a lower priority.
+ */
+enum class TaskPriority {
+  /**
+   * The result is needed by the current flush.
+   */
+  Immediate = 0,
+  /**
+   * The result is needed by the next frame.
+   */
+  NextFrame = 1,
+  /**
+   * Speculative work which may never be used.
+   */
+  Prefetch = 2
+};
+
+static constexpr int TASK_PRIORITY_COUNT = 3;
+
+/**
+ * Indicates that a task has no deadline.
+ */
+static constexpr int64_t NO_DEADLINE = INT64_MAX;
+}  // namespace pag
+
 #ifndef PAG_BUILD_FOR_WEB
 
+#include <atomic>
 #include <condition_variable>
 #include <list>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -38,14 +71,31 @@ class Executor {
 };
 
 class TaskGroup;
+class TaskQueue;
 
 class Task {
  public:
-  static std::shared_ptr<Task> Make(std::unique_ptr<Executor> executor);
+  /**
+   * Creates a new task with the specified executor. Tasks with the same priority are executed in
+   * the order of their deadlines, a deadline is a timestamp in microseconds, tasks without a
+   * deadline are executed after the others in FIFO order. If the taskGroup is nullptr, the task
+   * runs in the default TaskGroup shared by the whole process.
+   */
+  static std::shared_ptr<Task> Make(std::unique_ptr<Executor> executor,
+                                    TaskPriority priority = TaskPriority::Immediate,
+                                    int64_t deadline = NO_DEADLINE,
+                                    std::shared_ptr<TaskGroup> taskGroup = nullptr);
   ~Task();
 
   void run();
   bool isRunning();
+
+  /**
+   * Blocks until the task finishes and returns its executor. If the task is still waiting in the
+   * queue, it is taken out and executed directly on the calling thread rather than on a worker
+   * thread of the TaskGroup. That also runs it ahead of any queued task with a higher priority,
+   * such as when waiting for a Prefetch task, since the caller needs the result right now.
+   */
   Executor* wait();
   void cancel();
 
@@ -53,34 +103,111 @@ class Task {
   std::mutex locker = {};
   std::condition_variable condition = {};
   bool running = false;
-  TaskGroup* taskGroup = nullptr;
+  std::shared_ptr<TaskGroup> taskGroup = nullptr;
   std::unique_ptr<Executor> executor = nullptr;
+  TaskPriority priority = TaskPriority::Immediate;
+  int64_t deadline = NO_DEADLINE;
+  // The queue this task was pushed into, it stays the same even if the task is stolen by another
+  // worker. The 'queued' and 'position' fields are guarded by the locker of that queue.
+  TaskQueue* taskQueue = nullptr;
+  bool queued = false;
+  std::list<Task*>::iterator position = {};
 
-  explicit Task(std::unique_ptr<Executor> executor);
+  Task(std::unique_ptr<Executor> executor, TaskPriority priority, int64_t deadline,
+       std::shared_ptr<TaskGroup> taskGroup);
   void execute();
 
   friend class TaskGroup;
 };
 
+/**
+ * The queues of tasks owned by one worker thread of the TaskGroup, one list for each priority.
+ * Other workers may steal tasks from it when their own queues are empty.
+ */
+class TaskQueue {
+ private:
+  std::mutex locker = {};
+  std::list<Task*> tasks[TASK_PRIORITY_COUNT] = {};
+
+  friend class TaskGroup;
+};
+
+/**
+ * A work-stealing thread pool. Every worker thread owns a TaskQueue, new tasks are distributed to
+ * the queues in round-robin order, and an idle worker steals tasks from the queues of other
+ * workers before going to sleep.
+ */
 class TaskGroup {
  public:
+  /**
+   * Returns the default TaskGroup shared by the whole process, which has one thread per CPU core.
+   */
+  static std::shared_ptr<TaskGroup> GetInstance();
+
+  /**
+   * Creates a new TaskGroup with the specified name and number of threads. If cpuAffinity is not
+   * empty, the worker threads are only allowed to run on the listed CPU cores. The affinity is
+   * only supported on Linux and Android, and ignored on other platforms.
+   */
+  static std::shared_ptr<TaskGroup> Make(const std::string& name, int maxThreads,
+                                         const std::vector<int>& cpuAffinity = {});
+
   ~TaskGroup();
 
+  const std::string& name() const {
+    return _name;
+  }
+
+  /**
+   * Returns the number of worker threads.
+   */
+  int threadCount() const {
+    return static_cast<int>(threads.size());
+  }
+
+  /**
+   * Returns the number of tasks waiting in the queues.
+   */
+  int queueDepth() const {
+    return pendingTasks > 0 ? static_cast<int>(pendingTasks) : 0;
+  }
+
+  /**
+   * Returns the total time in microseconds the worker threads spent on executing tasks.
+   */
+  int64_t busyTime() const {
+    return _busyTime;
+  }
+
+  /**
+   * Returns the number of tasks executed by the worker threads.
+   */
+  int64_t completedTasks() const {
+    return _completedTasks;
+  }
+
  private:
+  std::string _name = {};
+  std::vector<int> cpuAffinity = {};
+  std::atomic<int64_t> _busyTime = {0};
+  std::atomic<int64_t> _completedTasks = {0};
   std::mutex locker = {};
   std::condition_variable condition = {};
-  int activeThreads = 0;
-  bool exited = false;
-  std::list<Task*> tasks = {};
+  std::atomic_int pendingTasks = {0};
+  std::atomic_int priorityTasks[TASK_PRIORITY_COUNT] = {};
+  std::atomic_int sleepingThreads = {0};
+  std::atomic_uint nextQueue = {0};
+  std::atomic_bool exited = {false};
+  std::vector<std::unique_ptr<TaskQueue>> queues = {};
   std::vector<std::thread> threads = {};
 
-  static TaskGroup* GetInstance();
-  static void RunLoop(TaskGroup* taskGroup);
+  static void RunLoop(TaskGroup* taskGroup, size_t queueIndex);
 
-  TaskGroup();
+  TaskGroup(std::string name, int maxThreads, std::vector<int> cpuAffinity);
   void initThreads();
   void pushTask(Task* task);
-  Task* popTask();
+  Task* popTask(size_t queueIndex);
+  Task* takeTask(size_t queueIndex, int priority);
   bool removeTask(Task* task);
   void exit();
 
@@ -92,6 +219,8 @@ class TaskGroup {
 #include <memory>
 
 namespace pag {
+class TaskGroup;
+
 class Executor {
  public:
   virtual ~Executor() = default;
@@ -104,7 +233,9 @@ class Executor {
 
 class Task {
  public:
-  static std::shared_ptr<Task> Make(std::unique_ptr<Executor> executor) {
+  static std::shared_ptr<Task> Make(std::unique_ptr<Executor> executor,
+                                    TaskPriority = TaskPriority::Immediate,
+                                    int64_t = NO_DEADLINE, std::shared_ptr<TaskGroup> = nullptr) {
     return std::shared_ptr<Task>(new Task(std::move(executor)));
   }
 
@@ -16,14 +16,17 @@
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <cstring>
 #include <unordered_map>
 #include <unordered_set>
 #include "Compression.h"
+#include "base/utils/Task.h"
 #include "base/utils/USE.h"
 #include "base/utils/Verify.h"
 #include "codec/Version.h"
 #include "codec/tags/FileTags.h"
 #include "codec/tags/PerformanceTag.h"
+#include "codec/utils/LZ4.h"
 #include "pag/file.h"
 
 namespace pag {
@@ -32,6 +35,16 @@ static const uint8_t EncryptedVersion = 3;
 
 static const uint8_t KnownVersion = 3;
 
+// The minimum number of compositions or images verified by each task when verifying in parallel.
+#define MIN_PARALLEL_VERIFYING_ITEMS 16
+
+// The preferred uncompressed size of each chunk in a compressed body. The chunks are compressed
+// independently and hold whole top-level tags, so the tags of each chunk are read as soon as it is
+// decompressed into the body buffer.
+#define COMPRESSION_CHUNK_SIZE 262144
+// A LZ4 block never expands data by more than 255 times.
+#define MAX_COMPRESSION_RATIO 255
+
 static bool HasTrackMatte(Enum type) {
   switch (type) {
     case TrackMatteType::Alpha:
@@ -141,21 +154,67 @@ void Codec::InstallReferences(const std::vector<Composition*>& compositions) {
   }
 }
 
-std::shared_ptr<File> Codec::VerifyAndMake(const std::vector<pag::Composition*>& compositions,
-                                           const std::vector<pag::ImageBytes*>& images) {
-  bool success = !compositions.empty();
-  for (auto composition : compositions) {
-    if (composition == nullptr || !composition->verify()) {
-      success = false;
-      break;
+template <typename T>
+static bool VerifyRange(const std::vector<T*>& items, size_t start, size_t end) {
+  for (auto i = start; i < end; i++) {
+    if (items[i] == nullptr || !items[i]->verify()) {
+      return false;
     }
   }
-  for (auto& imageBytes : images) {
-    if (imageBytes == nullptr || !imageBytes->verify()) {
-      success = false;
-      break;
+  return true;
+}
+
+#ifndef PAG_BUILD_FOR_WEB
+
+template <typename T>
+class VerifyTask : public Executor {
+ public:
+  VerifyTask(const std::vector<T*>* items, size_t start, size_t end)
+      : items(items), start(start), end(end) {
+  }
+
+  bool success = false;
+
+ private:
+  const std::vector<T*>* items = nullptr;
+  size_t start = 0;
+  size_t end = 0;
+
+  void execute() override {
+    success = VerifyRange(*items, start, end);
+  }
+};
+
+#endif
+
+template <typename T>
+static bool VerifyAll(const std::vector<T*>& items) {
+#ifndef PAG_BUILD_FOR_WEB
+  auto threadCount = static_cast<size_t>(TaskGroup::GetInstance()->threadCount());
+  auto taskCount = std::min(threadCount, items.size() / MIN_PARALLEL_VERIFYING_ITEMS);
+  if (taskCount > 1) {
+    std::vector<std::shared_ptr<Task>> tasks = {};
+    for (size_t i = 0; i < taskCount; i++) {
+      auto start = items.size() * i / taskCount;
+      auto end = items.size() * (i + 1) / taskCount;
+      auto task = Task::Make(std::make_unique<VerifyTask<T>>(&items, start, end));
+      task->run();
+      tasks.push_back(task);
+    }
+    bool success = true;
+    for (auto& task : tasks) {
+      // All tasks must be waited for, since they reference the items.
+      success = static_cast<VerifyTask<T>*>(task->wait())->success && success;
     }
+    return success;
   }
+#endif
+  return VerifyRange(items, 0, items.size());
+}
+
+std::shared_ptr<File> Codec::VerifyAndMake(const std::vector<pag::Composition*>& compositions,
+                                           const std::vector<pag::ImageBytes*>& images) {
+  bool success = !compositions.empty() && VerifyAll(compositions) && VerifyAll(images);
   if (!success) {
     for (auto& composition : compositions) {
       delete composition;
@@ -169,59 +228,246 @@ std::shared_ptr<File> Codec::VerifyAndMake(const std::vector<pag::Composition*>&
   return std::shared_ptr<File>(file);
 }
 
-DecodeStream ReadBodyBytes(DecodeStream* stream) {
-  DecodeStream emptyStream(stream->context);
+/**
+ * Decompresses the next chunk of a compressed body to the dst buffer. Returns the uncompressed
+ * length of the chunk, or 0 if it is malformed or longer than maxLength.
+ */
+static uint32_t DecompressChunk(DecodeStream* stream, uint8_t* dst, uint32_t maxLength) {
+  auto rawLength = stream->readUint32();
+  auto storedLength = stream->readUint32();
+  auto chunk = stream->readBytes(storedLength);
+  if (stream->context->hasException() || rawLength == 0 || rawLength > maxLength) {
+    return 0;
+  }
+  if (storedLength == rawLength) {
+    // The chunk is stored as it is.
+    memcpy(dst, chunk.data(), rawLength);
+  } else if (!LZ4Decompress(chunk.data(), storedLength, dst, rawLength)) {
+    return 0;
+  }
+  return rawLength;
+}
+
+/**
+ * Walks the chunk headers of a compressed body without decompressing them. Returns false if the
+ * chunks are truncated or their uncompressed lengths do not add up to bodyLength, so that a
+ * malformed body fails before its buffer is allocated.
+ */
+static bool CheckCompressedBody(DecodeStream stream, uint32_t bodyLength) {
+  uint64_t totalLength = 0;
+  while (totalLength < bodyLength) {
+    if (stream.bytesAvailable() < 8) {
+      return false;
+    }
+    auto rawLength = stream.readUint32();
+    auto storedLength = stream.readUint32();
+    if (rawLength == 0 || storedLength > rawLength || storedLength > stream.bytesAvailable() ||
+        rawLength / MAX_COMPRESSION_RATIO > storedLength) {
+      return false;
+    }
+    stream.skip(storedLength);
+    totalLength += rawLength;
+  }
+  return totalLength == bodyLength;
+}
+
+static bool DecompressBody(DecodeStream* stream, uint8_t* body, uint32_t bodyLength) {
+  uint32_t offset = 0;
+  while (offset < bodyLength) {
+    auto rawLength = DecompressChunk(stream, body + offset, bodyLength - offset);
+    if (rawLength == 0) {
+      return false;
+    }
+    offset += rawLength;
+  }
+  return true;
+}
+
+static void WriteCompressedChunk(EncodeStream* stream, uint8_t* chunk, uint32_t rawLength,
+                                 std::vector<uint8_t>* buffer) {
+  buffer->resize(std::max(buffer->size(), LZ4CompressBound(rawLength)));
+  auto storedLength = LZ4Compress(chunk, rawLength, buffer->data(), buffer->size());
+  stream->writeUint32(rawLength);
+  if (storedLength == 0 || storedLength >= rawLength) {
+    // Stores the chunk as it is if it does not compress.
+    stream->writeUint32(rawLength);
+    stream->writeBytes(chunk, rawLength);
+  } else {
+    stream->writeUint32(static_cast<uint32_t>(storedLength));
+    stream->writeBytes(buffer->data(), static_cast<uint32_t>(storedLength));
+  }
+}
+
+static void WriteCompressedBody(EncodeStream* stream, uint8_t* body, uint32_t bodyLength) {
+  // Each chunk holds whole top-level tags, so the decoder can read them as soon as the chunk is
+  // decompressed. A tag larger than the chunk size gets a chunk of its own.
+  CodecContext context = {};
+  DecodeStream tags(&context, body, bodyLength);
+  std::vector<uint8_t> buffer = {};
+  uint32_t chunkStart = 0;
+  while (tags.bytesAvailable() > 0 && !context.hasException()) {
+    auto tagStart = tags.position();
+    auto header = ReadTagHeader(&tags);
+    tags.skip(header.length);
+    if (tags.position() - chunkStart > COMPRESSION_CHUNK_SIZE && tagStart > chunkStart) {
+      WriteCompressedChunk(stream, body + chunkStart, tagStart - chunkStart, &buffer);
+      chunkStart = tagStart;
+    }
+  }
+  WriteCompressedChunk(stream, body + chunkStart, bodyLength - chunkStart, &buffer);
+}
+
+struct BodyHeader {
+  uint32_t length = 0;
+  char compression = CompressionAlgorithm::UNCOMPRESSED;
+};
+
+static BodyHeader ReadBodyHeader(DecodeStream* stream) {
+  BodyHeader header = {};
   if (stream->length() < 11) {
     Throw(stream->context, "Length of PAG file is too short.");
-    return emptyStream;
+    return header;
   }
   auto P = stream->readInt8();
   auto A = stream->readInt8();
   auto G = stream->readInt8();
   if (P != 'P' || A != 'A' || G != 'G') {
     Throw(stream->context, "Invalid PAG file header.");
-    return emptyStream;
+    return header;
   }
   auto version = stream->readUint8();
   if (version == EncryptedVersion) {
     Throw(stream->context, "Encrypted PAG file");
-    return emptyStream;
+    return header;
   }
   if (version > KnownVersion) {
     Throw(stream->context, "Invalid PAG file header.");
-    return emptyStream;
+    return header;
+  }
+  header.length = stream->readUint32();
+  header.compression = stream->readInt8();
+  if (header.compression == CompressionAlgorithm::LZ4) {
+    if (header.length / MAX_COMPRESSION_RATIO > stream->bytesAvailable()) {
+      Throw(stream->context, "Invalid PAG file header.");
+    }
+    return header;
   }
-  auto bodyLength = stream->readUint32();
-  auto compression = stream->readInt8();
-  if (compression != CompressionAlgorithm::UNCOMPRESSED) {
+  if (header.compression != CompressionAlgorithm::UNCOMPRESSED) {
     Throw(stream->context, "Invalid PAG file header.");
+    return header;
+  }
+  header.length = std::min(header.length, stream->bytesAvailable());
+  return header;
+}
+
+DecodeStream ReadBodyBytes(DecodeStream* stream, std::unique_ptr<ByteData>* bodyData) {
+  DecodeStream emptyStream(stream->context);
+  auto header = ReadBodyHeader(stream);
+  if (stream->context->hasException()) {
     return emptyStream;
   }
-  bodyLength = std::min(bodyLength, stream->bytesAvailable());
-  return stream->readBytes(bodyLength);
+  if (header.compression == CompressionAlgorithm::LZ4) {
+    if (!CheckCompressedBody(*stream, header.length)) {
+      Throw(stream->context, "Failed to decompress the PAG file body.");
+      return emptyStream;
+    }
+    auto data = ByteData::Make(header.length);
+    if (data == nullptr || !DecompressBody(stream, data->data(), header.length)) {
+      Throw(stream->context, "Failed to decompress the PAG file body.");
+      return emptyStream;
+    }
+    DecodeStream body(stream->context, data->data(), header.length);
+    *bodyData = std::move(data);
+    return body;
+  }
+  return stream->readBytes(header.length);
+}
+
+/**
+ * Reads the tags of a compressed body, each chunk is decompressed into bodyData and its tags are
+ * read before the next chunk is decompressed.
+ */
+static void ReadCompressedFileTags(DecodeStream* stream, uint32_t bodyLength,
+                                   std::unique_ptr<ByteData>* bodyData, CodecContext* context) {
+  if (!CheckCompressedBody(*stream, bodyLength)) {
+    Throw(context, "Failed to decompress the PAG file body.");
+    return;
+  }
+  auto data = ByteData::Make(bodyLength);
+  if (data == nullptr) {
+    Throw(context, "Failed to decompress the PAG file body.");
+    return;
+  }
+  uint32_t offset = 0;
+  auto nextChunk = [&](DecodeStream* chunk) {
+    if (offset >= bodyLength || context->hasException()) {
+      return false;
+    }
+    auto rawLength = DecompressChunk(stream, data->data() + offset, bodyLength - offset);
+    if (rawLength == 0) {
+      Throw(context, "Failed to decompress the PAG file body.");
+      return false;
+    }
+    *chunk = DecodeStream(context, data->data() + offset, rawLength);
+    offset += rawLength;
+    return true;
+  };
+  ReadFileTags(nextChunk, bodyLength, context);
+  *bodyData = std::move(data);
 }
 
 std::shared_ptr<File> Codec::Decode(const void* bytes, uint32_t byteLength,
                                     const std::string& filePath) {
   CodecContext context = {};
-  DecodeStream stream(&context, reinterpret_cast<const uint8_t*>(bytes), byteLength);
-  auto bodyBytes = ReadBodyBytes(&stream);
-  if (context.hasException()) {
+  return Decode(&context, bytes, byteLength, filePath);
+}
+
+std::shared_ptr<File> Codec::Decode(std::unique_ptr<ByteData> mappedData,
+                                    const std::string& filePath) {
+  if (mappedData == nullptr || mappedData->length() > UINT32_MAX) {
     return nullptr;
   }
-  ReadTags(&bodyBytes, &context, ReadTagsOfFile);
-  InstallReferences(context.compositions);
-  if (context.hasException()) {
+  CodecContext context = {};
+  context.referenceBytes = true;
+  context.lazyDecoding = File::LazyDecodingEnabled();
+  auto file = Decode(&context, mappedData->data(), static_cast<uint32_t>(mappedData->length()),
+                     filePath);
+  if (file != nullptr && file->mappedData == nullptr) {
+    file->mappedData = std::move(mappedData);
+  }
+  return file;
+}
+
+std::shared_ptr<File> Codec::Decode(CodecContext* context, const void* bytes,
+                                    uint32_t byteLength, const std::string& filePath) {
+  DecodeStream stream(context, reinterpret_cast<const uint8_t*>(bytes), byteLength);
+  auto header = ReadBodyHeader(&stream);
+  if (context->hasException()) {
+    return nullptr;
+  }
+  std::unique_ptr<ByteData> bodyData = nullptr;
+  if (header.compression == CompressionAlgorithm::LZ4) {
+    ReadCompressedFileTags(&stream, header.length, &bodyData, context);
+  } else {
+    auto bodyBytes = stream.readBytes(header.length);
+    ReadFileTags(&bodyBytes, context);
+  }
+  InstallReferences(context->compositions);
+  if (context->hasException()) {
     return nullptr;
   }
 
   // Verify 提前到使用之前，避免未经Verify导致使用时crash
-  auto file = VerifyAndMake(context.releaseCompositions(), context.releaseImages());
+  auto file = VerifyAndMake(context->releaseCompositions(), context->releaseImages());
   if (file == nullptr) {
     return nullptr;
   }
 
-  UpdateFileAttributes(file, &context, filePath);
+  UpdateFileAttributes(file, context, filePath);
+  if (context->referenceBytes && bodyData != nullptr) {
+    // The payloads reference the decompressed body rather than the original bytes.
+    file->mappedData = std::move(bodyData);
+  }
   return file;
 }
 
@@ -231,6 +477,12 @@ std::unique_ptr<ByteData> Codec::Encode(std::shared_ptr<File> file) {
 
 std::unique_ptr<ByteData> Codec::Encode(std::shared_ptr<File> file,
                                         std::shared_ptr<PerformanceData> performanceData) {
+  return Codec::Encode(file, performanceData, false);
+}
+
+std::unique_ptr<ByteData> Codec::Encode(std::shared_ptr<File> file,
+                                        std::shared_ptr<PerformanceData> performanceData,
+                                        bool compressBody) {
   CodecContext context = {};
   EncodeStream bodyBytes(&context);
   WriteTagsOfFile(&bodyBytes, file.get(), performanceData.get());
@@ -241,8 +493,14 @@ std::unique_ptr<ByteData> Codec::Encode(std::shared_ptr<File> file,
   fileBytes.writeInt8('G');
   fileBytes.writeUint8(Version);
   fileBytes.writeUint32(bodyBytes.length());
-  fileBytes.writeInt8(CompressionAlgorithm::UNCOMPRESSED);
-  fileBytes.writeBytes(&bodyBytes);
+  if (compressBody) {
+    fileBytes.writeInt8(CompressionAlgorithm::LZ4);
+    auto body = bodyBytes.release();
+    WriteCompressedBody(&fileBytes, body->data(), static_cast<uint32_t>(body->length()));
+  } else {
+    fileBytes.writeInt8(CompressionAlgorithm::UNCOMPRESSED);
+    fileBytes.writeBytes(&bodyBytes);
+  }
   return fileBytes.release();
 }
 
@@ -250,7 +508,8 @@ std::shared_ptr<PerformanceData> Codec::ReadPerformanceData(const void* bytes,
                                                             uint32_t byteLength) {
   CodecContext context = {};
   DecodeStream stream(&context, reinterpret_cast<const uint8_t*>(bytes), byteLength);
-  auto bodyBytes = ReadBodyBytes(&stream);
+  std::unique_ptr<ByteData> bodyData = nullptr;
+  auto bodyBytes = ReadBodyBytes(&stream, &bodyData);
   if (context.hasException()) {
     return nullptr;
   }
@@ -41,8 +41,9 @@ CodecContext::~CodecContext() {
 }
 
 FontData CodecContext::getFontData(int id) {
-  auto result = fontIDMap.find(id);
-  if (result != fontIDMap.end()) {
+  auto& fonts = sharedContext != nullptr ? sharedContext->fontIDMap : fontIDMap;
+  auto result = fonts.find(id);
+  if (result != fonts.end()) {
     auto font = result->second;
     return {font->fontFamily, font->fontStyle};
   }
@@ -50,6 +51,19 @@ FontData CodecContext::getFontData(int id) {
 }
 
 ImageBytes* CodecContext::getImageBytes(pag::ID imageID) {
+  if (sharedContext != nullptr) {
+    std::lock_guard<std::mutex> autoLock(sharedContext->imageLocker);
+    return sharedContext->getImageBytes(imageID);
+  }
+  auto image = findImageBytes(imageID);
+  if (image == nullptr) {
+    image = new ImageBytes();
+    images.push_back(image);
+  }
+  return image;
+}
+
+ImageBytes* CodecContext::findImageBytes(pag::ID imageID) const {
   for (auto image : images) {
     if (image->id == imageID) {
       return image;
@@ -60,9 +74,7 @@ ImageBytes* CodecContext::getImageBytes(pag::ID imageID) {
       return image;
     }
   }
-  auto image = new ImageBytes();
-  images.push_back(image);
-  return image;
+  return nullptr;
 }
 
 std::vector<Composition*> CodecContext::releaseCompositions() {
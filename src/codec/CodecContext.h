@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <mutex>
 #include <unordered_map>
 #include "codec/utils/StreamContext.h"
 #include "pag/file.h"
@@ -35,6 +36,7 @@ class CodecContext : public StreamContext {
   uint32_t getFontID(const std::string& fontFamily, const std::string& fontStyle);
   FontData getFontData(int id);
   ImageBytes* getImageBytes(ID imageID);
+  ImageBytes* findImageBytes(ID imageID) const;
   std::vector<Composition*> releaseCompositions();
   std::vector<ImageBytes*> releaseImages();
 
@@ -50,5 +52,13 @@ class CodecContext : public StreamContext {
   std::vector<int>* editableImages = nullptr;
   std::vector<int>* editableTexts = nullptr;
   uint16_t tagLevel = 0;
+  // If true, the sequences of video compositions are left undecoded until they are first used. It
+  // requires the referenceBytes to be true.
+  bool lazyDecoding = false;
+  // The context of the main thread when decoding compositions in parallel. Its fonts and images are
+  // decoded in advance and only read by the workers, except that the placeholders of the missing
+  // images are added to it under the imageLocker, so that all workers share them.
+  CodecContext* sharedContext = nullptr;
+  std::mutex imageLocker = {};
 };
 }  // namespace pag
@@ -0,0 +1,71 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "DeferredVideoTags.h"
+#include "codec/CodecContext.h"
+#include "codec/tags/VideoCompositionTag.h"
+#include "codec/tags/VideoSequence.h"
+
+namespace pag {
+void DeferredVideoTags::Defer(VideoComposition* composition, bool hasAlpha, DecodeStream* stream,
+                              TagCode code) {
+  if (composition->deferredTags == nullptr) {
+    composition->deferredTags = new DeferredVideoTags();
+    composition->deferredTags->hasAlpha = hasAlpha;
+  }
+  auto deferredTags = composition->deferredTags;
+  deferredTags->tags.push_back({code, stream->data(), stream->length()});
+  if (code == TagCode::VideoSequence) {
+    auto summary = ReadVideoSequenceSummary(stream, hasAlpha);
+    summary->composition = composition;
+    deferredTags->summaries.push_back(summary);
+  }
+}
+
+DeferredVideoTags::~DeferredVideoTags() {
+  for (auto summary : summaries) {
+    delete summary;
+  }
+}
+
+bool DeferredVideoTags::decode(VideoComposition* composition) const {
+  CodecContext context = {};
+  context.referenceBytes = true;
+  auto parameter = std::make_pair(composition, hasAlpha);
+  for (auto& tag : tags) {
+    DecodeStream stream(&context, tag.data, tag.length);
+    ReadTagsOfVideoComposition(&stream, tag.code, &parameter);
+  }
+  auto& sequences = composition->sequences;
+  auto success = !context.hasException() && !sequences.empty();
+  for (auto sequence : sequences) {
+    if (!success) {
+      break;
+    }
+    success = sequence->verify();
+  }
+  if (!success) {
+    LOGE("Failed to decode the deferred video sequences of composition: %u", composition->id);
+    for (auto sequence : sequences) {
+      delete sequence;
+    }
+    sequences.clear();
+  }
+  return success;
+}
+}  // namespace pag
@@ -0,0 +1,66 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "pag/file.h"
+
+namespace pag {
+class DecodeStream;
+
+/**
+ * DeferredVideoTags holds the VideoSequence and Mp4Header tags of a VideoComposition that are left
+ * undecoded by the lazy decoding mode. The tags reference the file data in place, which must stay
+ * alive as long as the composition. They are decoded by VideoComposition::loadSequences() when the
+ * composition is rendered for the first time.
+ */
+class DeferredVideoTags {
+ public:
+  /**
+   * Records the tag for the specified composition instead of decoding it. The stream must contain
+   * exactly the body of the tag.
+   */
+  static void Defer(VideoComposition* composition, bool hasAlpha, DecodeStream* stream,
+                    TagCode code);
+
+  ~DeferredVideoTags();
+
+  /**
+   * The sequences with only the attributes required during loading, such as the size, the frame
+   * rate and the static time ranges. They contain no frames and no headers.
+   */
+  std::vector<VideoSequence*> summaries;
+
+  /**
+   * Decodes all the deferred tags and appends the sequences to the composition. Returns false if
+   * any of the tags fails to decode or any of the sequences fails to verify, in which case nothing
+   * is appended.
+   */
+  bool decode(VideoComposition* composition) const;
+
+ private:
+  struct Tag {
+    TagCode code;
+    const uint8_t* data;
+    uint32_t length;
+  };
+
+  bool hasAlpha = false;
+  std::vector<Tag> tags;
+};
+}  // namespace pag
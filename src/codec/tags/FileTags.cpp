@@ -17,8 +17,12 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "FileTags.h"
+#include <deque>
 #include <unordered_set>
 #include "base/utils/EnumClassHash.h"
+#include "base/utils/Task.h"
+#include "base/utils/USE.h"
+#include "codec/TagHeader.h"
 #include "codec/tags/BitmapCompositionTag.h"
 #include "codec/tags/EditableIndices.h"
 #include "codec/tags/FileAttributes.h"
@@ -102,6 +106,221 @@ void ReadTagsOfFile(DecodeStream* stream, TagCode code, CodecContext* context) {
   }
 }
 
+struct CompositionTag {
+  TagCode code;
+  DecodeStream stream;
+  Composition* composition;
+};
+
+static bool IsCompositionTag(TagCode code) {
+  return code == TagCode::VectorCompositionBlock || code == TagCode::BitmapCompositionBlock ||
+         code == TagCode::VideoCompositionBlock;
+}
+
+static void ReadCompositionTag(CompositionTag* tag, CodecContext* context) {
+  tag->stream.context = context;
+  auto count = context->compositions.size();
+  ReadTagsOfFile(&tag->stream, tag->code, context);
+  if (context->compositions.size() > count) {
+    tag->composition = context->compositions.back();
+  }
+}
+
+#ifndef PAG_BUILD_FOR_WEB
+
+class CompositionTagsTask : public Executor {
+ public:
+  explicit CompositionTagsTask(CodecContext* sharedContext) {
+    context.sharedContext = sharedContext;
+    context.referenceBytes = sharedContext->referenceBytes;
+    context.lazyDecoding = sharedContext->lazyDecoding;
+  }
+
+  CodecContext context = {};
+  std::vector<CompositionTag*> tags = {};
+  uint32_t byteLength = 0;
+
+ private:
+  void execute() override {
+    for (auto tag : tags) {
+      ReadCompositionTag(tag, &context);
+      if (context.hasException()) {
+        break;
+      }
+    }
+  }
+};
+
+/**
+ * Waits for the tasks and merges the errors of their contexts. The compositions are left in the tags
+ * for the caller to collect in order.
+ */
+static void WaitCompositionTagsTasks(std::vector<std::shared_ptr<Task>>* tasks,
+                                     CodecContext* context) {
+  for (auto& task : *tasks) {
+    auto executor = static_cast<CompositionTagsTask*>(task->wait());
+    auto& workerContext = executor->context;
+    for (auto& message : workerContext.StreamContext::errorMessages) {
+      context->throwException(message);
+    }
+    context->tagLevel = std::max(context->tagLevel, workerContext.tagLevel);
+    workerContext.releaseCompositions();
+  }
+  tasks->clear();
+}
+
+static void ReadCompositionTagsInParallel(std::vector<CompositionTag>* tags, size_t taskCount,
+                                          CodecContext* context) {
+  std::vector<CompositionTagsTask*> executors = {};
+  for (size_t i = 0; i < taskCount; i++) {
+    executors.push_back(new CompositionTagsTask(context));
+  }
+  // Assigns the largest tags first, each to the task with the fewest bytes so far.
+  std::vector<CompositionTag*> sortedTags = {};
+  for (auto& tag : *tags) {
+    sortedTags.push_back(&tag);
+  }
+  std::stable_sort(sortedTags.begin(), sortedTags.end(),
+                   [](const CompositionTag* a, const CompositionTag* b) {
+                     return a->stream.length() > b->stream.length();
+                   });
+  auto lessBytes = [](const CompositionTagsTask* a, const CompositionTagsTask* b) {
+    return a->byteLength < b->byteLength;
+  };
+  for (auto tag : sortedTags) {
+    auto executor = *std::min_element(executors.begin(), executors.end(), lessBytes);
+    executor->tags.push_back(tag);
+    executor->byteLength += tag->stream.length();
+  }
+  std::vector<std::shared_ptr<Task>> tasks = {};
+  for (auto executor : executors) {
+    auto task = Task::Make(std::unique_ptr<CompositionTagsTask>(executor));
+    task->run();
+    tasks.push_back(task);
+  }
+  WaitCompositionTagsTasks(&tasks, context);
+  // Keeps the compositions in the order of tags, the main composition is always the last one.
+  for (auto& tag : *tags) {
+    if (tag.composition != nullptr) {
+      context->compositions.push_back(tag.composition);
+    }
+  }
+}
+
+#endif
+
+void ReadFileTags(DecodeStream* stream, CodecContext* context) {
+  // The compositions are decoded after all other tags, so that the fonts and images they refer to
+  // are ready, and they can be decoded in parallel.
+  std::vector<CompositionTag> compositionTags = {};
+  uint32_t compositionBytes = 0;
+  auto header = ReadTagHeader(stream);
+  if (context->hasException()) {
+    return;
+  }
+  while (header.code != TagCode::End) {
+    auto tagBytes = stream->readBytes(header.length);
+    if (IsCompositionTag(header.code)) {
+      compositionTags.push_back({header.code, tagBytes, nullptr});
+      compositionBytes += header.length;
+    } else {
+      ReadTagsOfFile(&tagBytes, header.code, context);
+    }
+    if (context->hasException()) {
+      return;
+    }
+    header = ReadTagHeader(stream);
+    if (context->hasException()) {
+      return;
+    }
+  }
+#ifndef PAG_BUILD_FOR_WEB
+  if (compositionBytes >= MIN_PARALLEL_DECODING_BYTES) {
+    auto threadCount = static_cast<size_t>(TaskGroup::GetInstance()->threadCount());
+    auto taskCount = std::min(threadCount, compositionTags.size());
+    if (taskCount > 1) {
+      ReadCompositionTagsInParallel(&compositionTags, taskCount, context);
+      return;
+    }
+  }
+#else
+  USE(compositionBytes);
+#endif
+  for (auto& tag : compositionTags) {
+    ReadCompositionTag(&tag, context);
+    if (context->hasException()) {
+      return;
+    }
+  }
+}
+
+void ReadFileTags(const std::function<bool(DecodeStream*)>& nextChunk, uint32_t bodyLength,
+                  CodecContext* context) {
+#ifndef PAG_BUILD_FOR_WEB
+  auto parallel = bodyLength >= MIN_PARALLEL_DECODING_BYTES &&
+                  TaskGroup::GetInstance()->threadCount() > 1;
+  // A deque keeps the tags in place while the tasks are reading them.
+  std::deque<CompositionTag> compositionTags = {};
+  std::vector<std::shared_ptr<Task>> tasks = {};
+#else
+  USE(bodyLength);
+#endif
+  bool endReached = false;
+  DecodeStream chunk(context);
+  while (!endReached && nextChunk(&chunk)) {
+#ifndef PAG_BUILD_FOR_WEB
+    auto executor = parallel ? new CompositionTagsTask(context) : nullptr;
+#endif
+    while (chunk.bytesAvailable() > 0 && !context->hasException()) {
+      auto header = ReadTagHeader(&chunk);
+      if (header.code == TagCode::End || context->hasException()) {
+        endReached = true;
+        break;
+      }
+      auto tagBytes = chunk.readBytes(header.length);
+      if (context->hasException()) {
+        break;
+      }
+#ifndef PAG_BUILD_FOR_WEB
+      if (executor != nullptr && IsCompositionTag(header.code)) {
+        compositionTags.push_back({header.code, tagBytes, nullptr});
+        executor->tags.push_back(&compositionTags.back());
+        continue;
+      }
+      if (!tasks.empty()) {
+        // The tasks read the fonts and images of the shared context, which this tag may change.
+        WaitCompositionTagsTasks(&tasks, context);
+      }
+#endif
+      ReadTagsOfFile(&tagBytes, header.code, context);
+    }
+#ifndef PAG_BUILD_FOR_WEB
+    if (executor != nullptr && !executor->tags.empty()) {
+      auto task = Task::Make(std::unique_ptr<CompositionTagsTask>(executor));
+      task->run();
+      tasks.push_back(task);
+    } else {
+      delete executor;
+    }
+#endif
+    if (context->hasException()) {
+      break;
+    }
+  }
+#ifndef PAG_BUILD_FOR_WEB
+  // The tasks must be waited for even if reading failed, since they reference the chunks.
+  WaitCompositionTagsTasks(&tasks, context);
+  for (auto& tag : compositionTags) {
+    if (tag.composition != nullptr) {
+      context->compositions.push_back(tag.composition);
+    }
+  }
+#endif
+  if (!endReached && !context->hasException()) {
+    Throw(context, "The End tag of the PAG file body is missing.");
+  }
+}
+
 void GetFontFromTextDocument(std::vector<FontData>& fontList,
                              std::unordered_set<std::string>& fontSet,
                              const TextDocumentHandle& textDocument) {
@@ -18,11 +18,39 @@
 
 #pragma once
 
+#include <functional>
 #include "codec/DataTypes.h"
 
 namespace pag {
+// Decoding in parallel only pays off if the compositions are large enough to outweigh the cost of
+// waking up the worker threads.
+#define MIN_PARALLEL_DECODING_BYTES 65536
+
+/**
+ * Reads the file header and returns the stream of the file body. If the body is compressed, it is
+ * decompressed into bodyData, which the returned stream references.
+ */
+DecodeStream ReadBodyBytes(DecodeStream* stream, std::unique_ptr<ByteData>* bodyData);
+
 void ReadTagsOfFile(DecodeStream* stream, TagCode code, CodecContext* context);
 
+/**
+ * Reads all the top-level tags of the file body. The compositions are decoded in parallel on the
+ * default TaskGroup if the file is large enough.
+ */
+void ReadFileTags(DecodeStream* stream, CodecContext* context);
+
+/**
+ * Reads all the top-level tags of a file body that is provided chunk by chunk, such as a compressed
+ * body. nextChunk sets the stream of the next chunk and returns false if there is none left, each
+ * chunk must hold whole tags. The tags of a chunk are read as soon as it is provided, and its
+ * compositions are decoded on the default TaskGroup while the next chunks are being provided if the
+ * body is large enough. The compositions are expected to follow all the other tags, as the encoder
+ * writes them.
+ */
+void ReadFileTags(const std::function<bool(DecodeStream*)>& nextChunk, uint32_t bodyLength,
+                  CodecContext* context);
+
 void WriteTagsOfFile(EncodeStream* stream, const File* file, PerformanceData* performanceData);
 
 std::vector<FontData> GetFontList(std::vector<Composition*> compositions);
@@ -22,12 +22,19 @@
 #include "CompositionTag.h"
 #include "LayerTag.h"
 #include "VideoSequence.h"
+#include "codec/CodecContext.h"
+#include "codec/DeferredVideoTags.h"
 
 namespace pag {
 void ReadTagsOfVideoComposition(DecodeStream* stream, TagCode code,
                                 std::pair<VideoComposition*, bool>* parameter) {
   auto composition = parameter->first;
   auto hasAlpha = parameter->second;
+  auto lazyDecoding = static_cast<CodecContext*>(stream->context)->lazyDecoding;
+  if (lazyDecoding && (code == TagCode::VideoSequence || code == TagCode::Mp4Header)) {
+    DeferredVideoTags::Defer(composition, hasAlpha, stream, code);
+    return;
+  }
   switch (code) {
     case TagCode::VideoSequence: {
       auto sequence = ReadVideoSequence(stream, hasAlpha);
@@ -62,6 +69,7 @@ static bool lessFirst(const VideoSequence* item1, const VideoSequence* item2) {
 }
 
 TagCode WriteVideoComposition(EncodeStream* stream, VideoComposition* composition) {
+  composition->loadSequences();
   auto sequences = composition->sequences;
   std::sort(sequences.begin(), sequences.end(), lessFirst);
   auto hasAlpha =
@@ -21,6 +21,9 @@
 #include "codec/Attributes.h"
 
 namespace pag {
+void ReadTagsOfVideoComposition(DecodeStream* stream, TagCode code,
+                                std::pair<VideoComposition*, bool>* parameter);
+
 VideoComposition* ReadVideoComposition(DecodeStream* stream);
 
 TagCode WriteVideoComposition(EncodeStream* stream, VideoComposition* composition);
@@ -61,6 +61,43 @@ VideoSequence* ReadVideoSequence(DecodeStream* stream, bool hasAlpha) {
   return sequence;
 }
 
+VideoSequence* ReadVideoSequenceSummary(DecodeStream* stream, bool hasAlpha) {
+  auto sequence = new VideoSequence();
+  sequence->width = stream->readEncodedInt32();
+  sequence->height = stream->readEncodedInt32();
+  sequence->frameRate = stream->readFloat();
+
+  if (hasAlpha) {
+    sequence->alphaStartX = stream->readEncodedInt32();
+    sequence->alphaStartY = stream->readEncodedInt32();
+  }
+
+  // Skips the sps and pps.
+  stream->readBytes(stream->readEncodedUint32());
+  stream->readBytes(stream->readEncodedUint32());
+
+  auto count = stream->readEncodedUint32();
+  for (uint32_t i = 0; i < count; i++) {
+    stream->readBitBoolean();
+  }
+  for (uint32_t i = 0; i < count && !stream->context->hasException(); i++) {
+    ReadTime(stream);
+    stream->readBytes(stream->readEncodedUint32());
+  }
+
+  if (stream->bytesAvailable() > 0) {
+    count = stream->readEncodedUint32();
+    for (uint32_t i = 0; i < count; i++) {
+      TimeRange staticTimeRange = {};
+      staticTimeRange.start = ReadTime(stream);
+      staticTimeRange.end = ReadTime(stream);
+      sequence->staticTimeRanges.push_back(staticTimeRange);
+    }
+  }
+
+  return sequence;
+}
+
 static void WriteByteDataWithoutStartCode(EncodeStream* stream, ByteData* byteData) {
   auto length = static_cast<uint32_t>(byteData->length());
   if (length < 4) {
@@ -109,15 +146,7 @@ TagCode WriteVideoSequence(EncodeStream* stream, std::pair<VideoSequence*, bool>
 }
 
 ByteData* ReadMp4Header(DecodeStream* stream) {
-  auto length = stream->readEncodedUint32();
-  auto bytes = stream->readBytes(length);
-  // must check whether the bytes is valid. otherwise memcpy will crash.
-  if (length == 0 || stream->context->hasException()) {
-    return nullptr;
-  }
-  auto data = new uint8_t[length];
-  memcpy(data, bytes.data(), length);
-  return ByteData::MakeAdopted(data, length).release();
+  return stream->readByteData().release();
 }
 
 TagCode WriteMp4Header(EncodeStream* stream, ByteData* byteData) {
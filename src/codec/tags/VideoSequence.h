@@ -22,6 +22,10 @@
 
 namespace pag {
 VideoSequence* ReadVideoSequence(DecodeStream* stream, bool hasAlpha);
+/**
+ * Reads the attributes of a VideoSequence tag without decoding its frames and headers.
+ */
+VideoSequence* ReadVideoSequenceSummary(DecodeStream* stream, bool hasAlpha);
 TagCode WriteVideoSequence(EncodeStream* stream, std::pair<VideoSequence*, bool>* parameter);
 ByteData* ReadMp4Header(DecodeStream* stream);
 TagCode WriteMp4Header(EncodeStream* stream, ByteData* byteData);
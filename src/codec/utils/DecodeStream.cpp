@@ -17,9 +17,12 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "DecodeStream.h"
+#include <algorithm>
 #include <cstring>
 
 namespace pag {
+// The number of values unpacked into the stack buffer at a time by the bulk float list reader.
+#define BULK_READ_BATCH_SIZE 64
 
 ByteOrder DecodeStream::order() const {
   return _order;
@@ -66,6 +69,9 @@ std::unique_ptr<ByteData> DecodeStream::readByteData() {
   if (length == 0 || context->hasException()) {
     return nullptr;
   }
+  if (context->referenceBytes) {
+    return ByteData::MakeWithoutCopy(const_cast<uint8_t*>(bytes.data()), length);
+  }
   return ByteData::MakeCopy(bytes.data(), length);
 }
 
@@ -147,29 +153,59 @@ int32_t DecodeStream::readBits(uint8_t numBits) {
 }
 
 uint32_t DecodeStream::readUBits(uint8_t numBits) {
-  static const uint8_t bitMasks[9] = {0, 1, 3, 7, 15, 31, 63, 127, 255};
   uint32_t value = 0;
-  if ((_length * 8 >= numBits) && (_bitPosition <= static_cast<uint64_t>(_length) * 8 - numBits)) {
-    uint32_t pos = 0;
-    while (pos < numBits) {
-      auto bytePosition = static_cast<uint32_t>(_bitPosition * 0.125);
-      auto bitPosition = static_cast<uint32_t>(_bitPosition % 8);
-      auto byte = bytes[bytePosition] >> bitPosition;
-      auto bitLength = std::min(8 - bitPosition, numBits - pos);
-      byte &= bitMasks[bitLength];
-      value |= static_cast<uint32_t>(byte) << pos;
-      pos += bitLength;
-      _bitPosition += bitLength;
-    }
-    bitPositionChanged();
+  if (hasBits(numBits)) {
+    unpackBits(&value, 1, numBits);
   } else {
     Throw(context, "End of file was encountered.");
   }
   return value;
 }
 
+uint64_t DecodeStream::readBitWord(uint64_t bitPosition) const {
+  // The bits are packed from the lowest bit of each byte, so the 8 bytes starting at the position
+  // are loaded as a little-endian word, which holds any value of up to 32 bits after shifting.
+  auto bytePosition = static_cast<uint32_t>(bitPosition >> 3);
+  uint64_t word = 0;
+  if (NATIVE_BYTE_ORDER == ByteOrder::LittleEndian && _length - bytePosition >= 8) {
+    memcpy(&word, bytes + bytePosition, sizeof(uint64_t));
+  } else {
+    auto end = std::min(bytePosition + 8, _length);
+    for (auto i = end; i > bytePosition; i--) {
+      word = (word << 8) | bytes[i - 1];
+    }
+  }
+  return word >> (bitPosition & 7);
+}
+
+void DecodeStream::unpackBits(uint32_t* values, uint32_t count, uint8_t numBits) {
+  // The caller has checked that all the bits are within the stream. The loop works on a local bit
+  // position without any branch, which lets the compiler pipeline the loads.
+  auto mask = numBits >= 32 ? UINT32_MAX : (1u << numBits) - 1;
+  auto bitPosition = _bitPosition;
+  for (uint32_t i = 0; i < count; i++) {
+    values[i] = static_cast<uint32_t>(readBitWord(bitPosition)) & mask;
+    bitPosition += numBits;
+  }
+  _bitPosition = bitPosition;
+  bitPositionChanged();
+}
+
+void DecodeStream::unpackSignedBits(int32_t* values, uint32_t count, uint8_t numBits) {
+  // int32_t and uint32_t are allowed to alias each other.
+  unpackBits(reinterpret_cast<uint32_t*>(values), count, numBits);
+  auto shift = 32 - numBits;
+  for (uint32_t i = 0; i < count; i++) {
+    values[i] = static_cast<int32_t>(static_cast<uint32_t>(values[i]) << shift) >> shift;
+  }
+}
+
 void DecodeStream::readInt32List(int32_t* values, uint32_t count) {
   auto numBits = readNumBits();
+  if (hasBits(static_cast<uint64_t>(count) * numBits)) {
+    unpackSignedBits(values, count, numBits);
+    return;
+  }
   for (uint32_t i = 0; i < count; i++) {
     values[i] = readBits(numBits);
   }
@@ -177,6 +213,10 @@ void DecodeStream::readInt32List(int32_t* values, uint32_t count) {
 
 void DecodeStream::readUint32List(uint32_t* values, uint32_t count) {
   auto numBits = readNumBits();
+  if (hasBits(static_cast<uint64_t>(count) * numBits)) {
+    unpackBits(values, count, numBits);
+    return;
+  }
   for (uint32_t i = 0; i < count; i++) {
     values[i] = readUBits(numBits);
   }
@@ -184,6 +224,19 @@ void DecodeStream::readUint32List(uint32_t* values, uint32_t count) {
 
 void DecodeStream::readFloatList(float* values, uint32_t count, float precision) {
   auto numBits = readNumBits();
+  if (hasBits(static_cast<uint64_t>(count) * numBits)) {
+    // Unpacks the integers in batches and converts each batch in a separate loop, which the
+    // compiler vectorizes.
+    int32_t batch[BULK_READ_BATCH_SIZE];
+    for (uint32_t start = 0; start < count; start += BULK_READ_BATCH_SIZE) {
+      auto batchCount = std::min(count - start, static_cast<uint32_t>(BULK_READ_BATCH_SIZE));
+      unpackSignedBits(batch, batchCount, numBits);
+      for (uint32_t i = 0; i < batchCount; i++) {
+        values[start + i] = batch[i] * precision;
+      }
+    }
+    return;
+  }
   for (uint32_t i = 0; i < count; i++) {
     values[i] = readBits(numBits) * precision;
   }
@@ -256,6 +256,14 @@ class DecodeStream final {
     _bitPosition = static_cast<uint64_t>(_position) * 8;
   }
 
+  bool hasBits(uint64_t numBits) const {
+    return _bitPosition + numBits <= static_cast<uint64_t>(_length) * 8;
+  }
+
+  uint64_t readBitWord(uint64_t bitPosition) const;
+  void unpackBits(uint32_t* values, uint32_t count, uint8_t numBits);
+  void unpackSignedBits(int32_t* values, uint32_t count, uint8_t numBits);
+
   Bit8 readBit8();
   Bit16 readBit16();
   Bit32 readBit24();
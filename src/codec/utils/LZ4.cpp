@@ -0,0 +1,189 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "LZ4.h"
+#include <cstring>
+#include <vector>
+
+namespace pag {
+#define LZ4_MIN_MATCH 4
+#define LZ4_HASH_LOG 12
+// The last 5 bytes are always literals, and the last match must start at least 12 bytes before the
+// end of the block, as required by the LZ4 block format.
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MATCH_FIND_LIMIT 12
+#define LZ4_MAX_OFFSET 65535
+// The search step grows by one for every 64 bytes without a match, which skips incompressible data
+// quickly.
+#define LZ4_SKIP_TRIGGER 6
+
+static inline uint32_t Read32(const uint8_t* data) {
+  uint32_t value = 0;
+  memcpy(&value, data, sizeof(uint32_t));
+  return value;
+}
+
+static inline uint32_t Hash(uint32_t value) {
+  return (value * 2654435761U) >> (32 - LZ4_HASH_LOG);
+}
+
+static uint8_t* WriteLength(uint8_t* output, size_t length) {
+  while (length >= 255) {
+    *output++ = 255;
+    length -= 255;
+  }
+  *output++ = static_cast<uint8_t>(length);
+  return output;
+}
+
+static uint8_t* WriteLiterals(uint8_t* output, uint8_t* token, const uint8_t* literals,
+                              size_t length) {
+  if (length >= 15) {
+    *token = 15 << 4;
+    output = WriteLength(output, length - 15);
+  } else {
+    *token = static_cast<uint8_t>(length << 4);
+  }
+  if (length > 0) {
+    memcpy(output, literals, length);
+  }
+  return output + length;
+}
+
+size_t LZ4CompressBound(size_t length) {
+  return length + length / 255 + 16;
+}
+
+size_t LZ4Compress(const uint8_t* src, size_t srcLength, uint8_t* dst, size_t dstCapacity) {
+  if (dstCapacity < LZ4CompressBound(srcLength)) {
+    return 0;
+  }
+  auto output = dst;
+  auto anchor = src;
+  auto end = src + srcLength;
+  if (srcLength > LZ4_MATCH_FIND_LIMIT) {
+    std::vector<uint32_t> hashTable(1 << LZ4_HASH_LOG, 0);
+    auto matchFindLimit = end - LZ4_MATCH_FIND_LIMIT;
+    auto matchLimit = end - LZ4_LAST_LITERALS;
+    auto input = src;
+    while (input < matchFindLimit) {
+      auto sequence = Read32(input);
+      auto hash = Hash(sequence);
+      auto match = src + hashTable[hash];
+      hashTable[hash] = static_cast<uint32_t>(input - src);
+      if (match >= input || input - match > LZ4_MAX_OFFSET || Read32(match) != sequence) {
+        input += 1 + ((input - anchor) >> LZ4_SKIP_TRIGGER);
+        continue;
+      }
+      while (input > anchor && match > src && input[-1] == match[-1]) {
+        input--;
+        match--;
+      }
+      auto matchStart = input;
+      input += LZ4_MIN_MATCH;
+      match += LZ4_MIN_MATCH;
+      while (input < matchLimit && *input == *match) {
+        input++;
+        match++;
+      }
+      auto token = output++;
+      output = WriteLiterals(output, token, anchor, static_cast<size_t>(matchStart - anchor));
+      auto offset = static_cast<uint16_t>(input - match);
+      *output++ = static_cast<uint8_t>(offset & 0xFF);
+      *output++ = static_cast<uint8_t>(offset >> 8);
+      auto matchLength = static_cast<size_t>(input - matchStart) - LZ4_MIN_MATCH;
+      if (matchLength >= 15) {
+        *token |= 15;
+        output = WriteLength(output, matchLength - 15);
+      } else {
+        *token |= static_cast<uint8_t>(matchLength);
+      }
+      anchor = input;
+    }
+  }
+  auto token = output++;
+  output = WriteLiterals(output, token, anchor, static_cast<size_t>(end - anchor));
+  return static_cast<size_t>(output - dst);
+}
+
+static bool ReadLength(const uint8_t** input, const uint8_t* end, size_t* length) {
+  uint8_t value = 0;
+  do {
+    if (*input >= end) {
+      return false;
+    }
+    value = *(*input)++;
+    *length += value;
+  } while (value == 255);
+  return true;
+}
+
+bool LZ4Decompress(const uint8_t* src, size_t srcLength, uint8_t* dst, size_t dstLength) {
+  auto input = src;
+  auto inputEnd = src + srcLength;
+  auto output = dst;
+  auto outputEnd = dst + dstLength;
+  while (input < inputEnd) {
+    auto token = *input++;
+    size_t literalLength = token >> 4;
+    if (literalLength == 15 && !ReadLength(&input, inputEnd, &literalLength)) {
+      return false;
+    }
+    if (literalLength > static_cast<size_t>(inputEnd - input) ||
+        literalLength > static_cast<size_t>(outputEnd - output)) {
+      return false;
+    }
+    if (literalLength > 0) {
+      memcpy(output, input, literalLength);
+    }
+    input += literalLength;
+    output += literalLength;
+    if (input == inputEnd) {
+      // The last sequence contains only literals.
+      break;
+    }
+    if (inputEnd - input < 2) {
+      return false;
+    }
+    size_t offset = input[0] | (input[1] << 8);
+    input += 2;
+    if (offset == 0 || offset > static_cast<size_t>(output - dst)) {
+      return false;
+    }
+    size_t matchLength = token & 15;
+    if (matchLength == 15 && !ReadLength(&input, inputEnd, &matchLength)) {
+      return false;
+    }
+    matchLength += LZ4_MIN_MATCH;
+    if (matchLength > static_cast<size_t>(outputEnd - output)) {
+      return false;
+    }
+    auto match = output - offset;
+    if (offset >= matchLength) {
+      memcpy(output, match, matchLength);
+      output += matchLength;
+    } else {
+      // The match overlaps the output, which repeats the last 'offset' bytes.
+      for (size_t i = 0; i < matchLength; i++) {
+        *output++ = *match++;
+      }
+    }
+  }
+  return output == outputEnd;
+}
+}  // namespace pag
@@ -0,0 +1,42 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pag {
+/**
+ * Returns the maximum number of bytes LZ4Compress() may write for the specified input length.
+ */
+size_t LZ4CompressBound(size_t length);
+
+/**
+ * Compresses the source bytes into the LZ4 block format. The capacity of the destination must be
+ * at least LZ4CompressBound(srcLength). Returns the number of bytes written, or 0 if the capacity
+ * is not enough.
+ */
+size_t LZ4Compress(const uint8_t* src, size_t srcLength, uint8_t* dst, size_t dstCapacity);
+
+/**
+ * Decompresses a LZ4 block, which must decompress to exactly dstLength bytes. Returns false if the
+ * block is malformed. It never reads or writes out of the bounds of the two buffers.
+ */
+bool LZ4Decompress(const uint8_t* src, size_t srcLength, uint8_t* dst, size_t dstLength);
+}  // namespace pag
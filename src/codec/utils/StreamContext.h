@@ -36,6 +36,9 @@ class StreamContext {
   }
 
   std::vector<std::string> errorMessages;
+  // If true, DecodeStream::readByteData() returns ByteData objects referencing the decoded bytes
+  // instead of copies, and the caller must keep the bytes alive as long as the returned objects.
+  bool referenceBytes = false;
 };
 
 #ifdef DEBUG
@@ -123,7 +123,7 @@ VideoSequenceReader::~VideoSequenceReader() {
   }
 }
 
-void VideoSequenceReader::prepare(Frame targetFrame) {
+void VideoSequenceReader::prepare(Frame targetFrame, TaskPriority, int64_t) {
   // Web 端渲染过程不能 await，否则会把渲染一半的 Canvas 上屏。
   if (videoReader.as<bool>()) {
     float playbackRate = 1;
@@ -49,7 +49,7 @@ class VideoSequenceReader : public SequenceReader {
 
   ~VideoSequenceReader() override;
 
-  void prepare(Frame targetFrame) override;
+  void prepare(Frame targetFrame, TaskPriority priority, int64_t deadline) override;
 
  protected:
   bool decodeFrame(Frame) override {
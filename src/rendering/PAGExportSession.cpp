@@ -0,0 +1,269 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <condition_variable>
+#include <map>
+#include <thread>
+#include "base/utils/TGFXCast.h"
+#include "base/utils/TimeUtil.h"
+#include "pag/file.h"
+#include "pag/pag.h"
+#include "rendering/utils/LockGuard.h"
+#include "tgfx/core/ImageInfo.h"
+
+namespace pag {
+// Each worker renders a block of continuous frames at a time, so that the sequence readers of one
+// worker can decode forward without seeking.
+static constexpr Frame FRAMES_PER_BLOCK = 8;
+// The max number of blocks per worker allowed to be rendered ahead of the delivered frame, which
+// limits the memory held by pending frames.
+static constexpr Frame MAX_BLOCKS_AHEAD = 2;
+
+struct ExportWorker {
+  std::shared_ptr<PAGFile> pagFile = nullptr;
+  std::shared_ptr<PAGSurface> pagSurface = nullptr;
+  std::shared_ptr<PAGPlayer> pagPlayer = nullptr;
+};
+
+struct ExportFrame {
+  bool success = false;
+  std::vector<uint8_t> pixels = {};
+};
+
+class ExportContext {
+ public:
+  ExportContext(Frame startFrame, Frame endFrame, Frame totalFrames, const tgfx::ImageInfo& info,
+                ColorType colorType, AlphaType alphaType, Frame maxFramesAhead)
+      : endFrame(endFrame), totalFrames(totalFrames), info(info), colorType(colorType),
+        alphaType(alphaType), maxFramesAhead(maxFramesAhead), nextFrame(startFrame),
+        deliveredFrame(startFrame) {
+  }
+
+  void renderFrame(ExportWorker* worker, Frame frame, ExportFrame* result) const {
+    result->pixels.resize(info.byteSize());
+    worker->pagPlayer->setProgress(FrameToProgress(frame, totalFrames));
+    worker->pagPlayer->flush();
+    result->success = worker->pagSurface->readPixels(colorType, alphaType, result->pixels.data(),
+                                                     info.rowBytes());
+  }
+
+  void runWorker(ExportWorker* worker) {
+    while (true) {
+      Frame blockStart = 0;
+      {
+        std::unique_lock<std::mutex> autoLock(locker);
+        condition.wait(autoLock, [&] {
+          return cancelled || nextFrame > endFrame || nextFrame < deliveredFrame + maxFramesAhead;
+        });
+        if (cancelled || nextFrame > endFrame) {
+          return;
+        }
+        blockStart = nextFrame;
+        nextFrame += FRAMES_PER_BLOCK;
+      }
+      auto blockEnd = std::min(blockStart + FRAMES_PER_BLOCK - 1, endFrame);
+      for (auto frame = blockStart; frame <= blockEnd; frame++) {
+        ExportFrame result = {};
+        {
+          std::lock_guard<std::mutex> autoLock(locker);
+          if (cancelled) {
+            return;
+          }
+          if (!freeBuffers.empty()) {
+            result.pixels = std::move(freeBuffers.back());
+            freeBuffers.pop_back();
+          }
+        }
+        renderFrame(worker, frame, &result);
+        {
+          std::lock_guard<std::mutex> autoLock(locker);
+          finishedFrames[frame] = std::move(result);
+        }
+        condition.notify_all();
+      }
+    }
+  }
+
+  bool deliverFrames(Frame startFrame, const PAGExportSession::FrameCallback& callback) {
+    auto success = true;
+    for (auto frame = startFrame; frame <= endFrame; frame++) {
+      ExportFrame result = {};
+      {
+        std::unique_lock<std::mutex> autoLock(locker);
+        condition.wait(autoLock, [&] { return finishedFrames.count(frame) > 0; });
+        auto position = finishedFrames.find(frame);
+        result = std::move(position->second);
+        finishedFrames.erase(position);
+      }
+      success = result.success && callback(frame, result.pixels.data(), info.rowBytes());
+      {
+        std::lock_guard<std::mutex> autoLock(locker);
+        if (!success) {
+          cancelled = true;
+        } else {
+          deliveredFrame = frame + 1;
+          freeBuffers.push_back(std::move(result.pixels));
+        }
+      }
+      condition.notify_all();
+      if (!success) {
+        break;
+      }
+    }
+    return success;
+  }
+
+ private:
+  Frame endFrame = 0;
+  Frame totalFrames = 0;
+  tgfx::ImageInfo info = {};
+  ColorType colorType = ColorType::RGBA_8888;
+  AlphaType alphaType = AlphaType::Premultiplied;
+  Frame maxFramesAhead = 0;
+  std::mutex locker = {};
+  std::condition_variable condition = {};
+  Frame nextFrame = 0;
+  Frame deliveredFrame = 0;
+  bool cancelled = false;
+  std::map<Frame, ExportFrame> finishedFrames = {};
+  std::vector<std::vector<uint8_t>> freeBuffers = {};
+};
+
+std::shared_ptr<PAGExportSession> PAGExportSession::Make(std::shared_ptr<PAGFile> pagFile,
+                                                         int width, int height, int workerCount) {
+  if (pagFile == nullptr || width <= 0 || height <= 0) {
+    return nullptr;
+  }
+#ifdef PAG_BUILD_FOR_WEB
+  workerCount = 1;
+#else
+  if (workerCount < 1) {
+    workerCount = static_cast<int>(std::thread::hardware_concurrency());
+  }
+#endif
+  workerCount = std::max(workerCount, 1);
+  return std::shared_ptr<PAGExportSession>(
+      new PAGExportSession(std::move(pagFile), width, height, workerCount));
+}
+
+PAGExportSession::PAGExportSession(std::shared_ptr<PAGFile> pagFile, int width, int height,
+                                   int workerCount)
+    : pagFile(std::move(pagFile)), width(width), height(height), _workerCount(workerCount) {
+}
+
+std::shared_ptr<PAGFile> PAGExportSession::copyFile() {
+  auto newFile = pagFile->copyOriginal();
+  if (newFile == nullptr) {
+    return nullptr;
+  }
+  newFile->setTimeStretchMode(pagFile->timeStretchMode());
+  newFile->setDuration(pagFile->duration());
+  for (auto index : pagFile->getEditableIndices(LayerType::Text)) {
+    auto layers = pagFile->getLayersByEditableIndex(index, LayerType::Text);
+    if (layers.empty()) {
+      continue;
+    }
+    auto textLayer = std::static_pointer_cast<PAGTextLayer>(layers.front());
+    std::shared_ptr<TextDocument> textDocument = nullptr;
+    {
+      LockGuard autoLock(textLayer->rootLocker);
+      if (textLayer->replacement != nullptr) {
+        textDocument = std::make_shared<TextDocument>(*textLayer->textDocumentForRead());
+      }
+    }
+    if (textDocument != nullptr) {
+      newFile->replaceText(index, textDocument);
+    }
+  }
+  for (auto index : pagFile->getEditableIndices(LayerType::Image)) {
+    auto layers = pagFile->getLayersByEditableIndex(index, LayerType::Image);
+    if (layers.empty()) {
+      continue;
+    }
+    auto imageLayer = std::static_pointer_cast<PAGImageLayer>(layers.front());
+    std::shared_ptr<PAGImage> image = nullptr;
+    {
+      LockGuard autoLock(imageLayer->rootLocker);
+      if (imageLayer->replacement != nullptr) {
+        image = imageLayer->getPAGImage();
+      }
+    }
+    if (image != nullptr) {
+      newFile->replaceImage(index, image);
+    }
+  }
+  return newFile;
+}
+
+bool PAGExportSession::exportFrames(Frame startFrame, Frame endFrame, ColorType colorType,
+                                    AlphaType alphaType, const FrameCallback& callback) {
+  if (callback == nullptr) {
+    return false;
+  }
+  auto totalFrames = TimeToFrame(pagFile->duration(), pagFile->frameRate());
+  startFrame = std::max(startFrame, static_cast<Frame>(0));
+  endFrame = std::min(endFrame, totalFrames - 1);
+  if (startFrame > endFrame) {
+    return false;
+  }
+  auto info = tgfx::ImageInfo::Make(width, height, ToTGFX(colorType), ToTGFX(alphaType));
+  if (info.isEmpty()) {
+    return false;
+  }
+  auto numBlocks = (endFrame - startFrame) / FRAMES_PER_BLOCK + 1;
+  auto workerCount = static_cast<int>(std::min(static_cast<Frame>(_workerCount), numBlocks));
+  std::vector<ExportWorker> workers = {};
+  for (int i = 0; i < workerCount; i++) {
+    ExportWorker worker = {};
+    worker.pagFile = copyFile();
+    worker.pagSurface = PAGSurface::MakeOffscreen(width, height);
+    if (worker.pagFile == nullptr || worker.pagSurface == nullptr) {
+      return false;
+    }
+    worker.pagPlayer = std::make_shared<PAGPlayer>();
+    worker.pagPlayer->setSurface(worker.pagSurface);
+    worker.pagPlayer->setComposition(worker.pagFile);
+    workers.push_back(std::move(worker));
+  }
+  ExportContext context(startFrame, endFrame, totalFrames, info, colorType, alphaType,
+                        FRAMES_PER_BLOCK * MAX_BLOCKS_AHEAD * workerCount);
+  if (workerCount == 1) {
+    ExportFrame result = {};
+    for (auto frame = startFrame; frame <= endFrame; frame++) {
+      context.renderFrame(&workers[0], frame, &result);
+      if (!result.success || !callback(frame, result.pixels.data(), info.rowBytes())) {
+        return false;
+      }
+    }
+    return true;
+  }
+#ifdef PAG_BUILD_FOR_WEB
+  return false;
+#else
+  std::vector<std::thread> threads = {};
+  for (auto& worker : workers) {
+    threads.emplace_back(&ExportContext::runWorker, &context, &worker);
+  }
+  auto success = context.deliverFrames(startFrame, callback);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return success;
+#endif
+}
+}  // namespace pag
@@ -38,6 +38,22 @@ std::shared_ptr<PAGFile> PAGFile::Load(const std::string& filePath) {
   return MakeFrom(file);
 }
 
+bool PAGFile::MemoryMapEnabled() {
+  return File::MemoryMapEnabled();
+}
+
+void PAGFile::SetMemoryMapEnabled(bool value) {
+  File::SetMemoryMapEnabled(value);
+}
+
+bool PAGFile::LazyDecodingEnabled() {
+  return File::LazyDecodingEnabled();
+}
+
+void PAGFile::SetLazyDecodingEnabled(bool value) {
+  File::SetLazyDecodingEnabled(value);
+}
+
 std::shared_ptr<PAGFile> PAGFile::MakeFrom(std::shared_ptr<File> file) {
   if (file == nullptr) {
     return nullptr;
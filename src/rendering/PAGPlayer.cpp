@@ -20,6 +20,7 @@
 #include "pag/file.h"
 #include "rendering/Drawable.h"
 #include "rendering/FileReporter.h"
+#include "rendering/caches/FrameCache.h"
 #include "rendering/caches/RenderCache.h"
 #include "rendering/layers/PAGStage.h"
 #include "rendering/utils/ApplyScaleMode.h"
@@ -132,6 +133,20 @@ void PAGPlayer::setCacheScale(float value) {
   stage->setCacheScale(value);
 }
 
+std::shared_ptr<PAGThreadPool> PAGPlayer::threadPool() {
+  LockGuard autoLock(rootLocker);
+  return _threadPool;
+}
+
+void PAGPlayer::setThreadPool(std::shared_ptr<PAGThreadPool> pool) {
+  LockGuard autoLock(rootLocker);
+  if (_threadPool == pool) {
+    return;
+  }
+  _threadPool = std::move(pool);
+  renderCache->setTaskGroup(_threadPool ? _threadPool->taskGroup : nullptr);
+}
+
 float PAGPlayer::maxFrameRate() {
   LockGuard autoLock(rootLocker);
   return _maxFrameRate;
@@ -401,7 +416,73 @@ int64_t PAGPlayer::presentingTime() {
 
 int64_t PAGPlayer::graphicsMemory() {
   LockGuard autoLock(rootLocker);
-  return renderCache->memoryUsage();
+  return static_cast<int64_t>(renderCache->memoryUsage() + stage->frameCacheMemory());
+}
+
+PAGCacheBudget PAGPlayer::cacheBudget() {
+  LockGuard autoLock(rootLocker);
+  return renderCache->cacheBudget();
+}
+
+void PAGPlayer::setCacheBudget(const PAGCacheBudget& budget) {
+  LockGuard autoLock(rootLocker);
+  renderCache->setCacheBudget(budget);
+}
+
+PAGCacheUsage PAGPlayer::cacheUsage() {
+  LockGuard autoLock(rootLocker);
+  return renderCache->cacheUsage();
+}
+
+bool PAGPlayer::sharedCacheEnabled() {
+  LockGuard autoLock(rootLocker);
+  return renderCache->sharedCacheEnabled();
+}
+
+void PAGPlayer::setSharedCacheEnabled(bool value) {
+  LockGuard autoLock(rootLocker);
+  renderCache->setSharedCacheEnabled(value);
+}
+
+size_t PAGPlayer::SharedCacheBudget() {
+  return SharedGraphicsCache::GetBudget();
+}
+
+void PAGPlayer::SetSharedCacheBudget(size_t budget) {
+  SharedGraphicsCache::SetBudget(budget);
+}
+
+size_t PAGPlayer::FrameCacheBudget() {
+  return pag::FrameCacheBudget::GetBudget();
+}
+
+void PAGPlayer::SetFrameCacheBudget(size_t budget) {
+  pag::FrameCacheBudget::SetBudget(budget);
+}
+
+PAGSnapshotScaleMode PAGPlayer::snapshotScaleMode() {
+  LockGuard autoLock(rootLocker);
+  return renderCache->snapshotScaleMode();
+}
+
+void PAGPlayer::setSnapshotScaleMode(PAGSnapshotScaleMode mode) {
+  LockGuard autoLock(rootLocker);
+  renderCache->setSnapshotScaleMode(mode);
+}
+
+int PAGPlayer::sequenceLookahead() {
+  LockGuard autoLock(rootLocker);
+  return renderCache->sequenceLookahead();
+}
+
+void PAGPlayer::setSequenceLookahead(int frames) {
+  LockGuard autoLock(rootLocker);
+  renderCache->setSequenceLookahead(frames);
+}
+
+std::unordered_map<ID, int64_t> PAGPlayer::prefetchHorizons() {
+  LockGuard autoLock(rootLocker);
+  return renderCache->prefetchHorizons();
 }
 
 void PAGPlayer::updateStageSize() {
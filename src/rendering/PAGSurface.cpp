@@ -24,6 +24,7 @@
 #include "rendering/graphics/Recorder.h"
 #include "rendering/utils/GLRestorer.h"
 #include "rendering/utils/LockGuard.h"
+#include "rendering/utils/YUVConverter.h"
 #include "rendering/utils/shaper/TextShaper.h"
 #include "tgfx/core/Clock.h"
 #include "tgfx/gpu/opengl/GLDevice.h"
@@ -161,6 +162,54 @@ bool PAGSurface::readPixels(ColorType colorType, AlphaType alphaType, void* dstP
   return result;
 }
 
+bool PAGSurface::readPixelsAsync(
+    ColorType colorType, AlphaType alphaType,
+    std::function<void(const void* pixels, size_t rowBytes)> callback) {
+  LockGuard autoLock(rootLocker);
+  if (surface == nullptr) {
+    return false;
+  }
+  auto context = lockContext();
+  if (!context) {
+    return false;
+  }
+  auto info = tgfx::ImageInfo::Make(surface->width(), surface->height(), ToTGFX(colorType),
+                                    ToTGFX(alphaType));
+  auto result = surface->readPixelsAsync(info, std::move(callback));
+  unlockContext();
+  return result;
+}
+
+void PAGSurface::finishPixelReads() {
+  LockGuard autoLock(rootLocker);
+  if (surface == nullptr) {
+    return;
+  }
+  auto context = lockContext();
+  if (!context) {
+    return;
+  }
+  surface->finishPixelReads();
+  unlockContext();
+}
+
+bool PAGSurface::readYUVPixels(YUVFormat format, YUVColorSpace colorSpace,
+                               YUVColorRange colorRange, uint8_t* const dstPlanes[],
+                               const size_t dstRowBytes[]) {
+  LockGuard autoLock(rootLocker);
+  if (surface == nullptr) {
+    return false;
+  }
+  auto context = lockContext();
+  if (!context) {
+    return false;
+  }
+  auto result = YUVConverter::ReadPixels(surface.get(), format, colorSpace, colorRange, dstPlanes,
+                                         dstRowBytes);
+  unlockContext();
+  return result;
+}
+
 bool PAGSurface::draw(RenderCache* cache, std::shared_ptr<Graphic> graphic,
                       BackendSemaphore* signalSemaphore, bool autoClear) {
   if (!drawable->prepareDevice()) {
@@ -0,0 +1,86 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "base/utils/Task.h"
+#include "pag/pag.h"
+
+namespace pag {
+PAGThreadPool::PAGThreadPool(std::shared_ptr<TaskGroup> taskGroup)
+    : taskGroup(std::move(taskGroup)) {
+}
+
+#ifndef PAG_BUILD_FOR_WEB
+
+std::shared_ptr<PAGThreadPool> PAGThreadPool::Make(const std::string& name, int threadCount,
+                                                   const std::vector<int>& cpuAffinity) {
+  auto taskGroup = TaskGroup::Make(name, threadCount, cpuAffinity);
+  if (taskGroup == nullptr) {
+    return nullptr;
+  }
+  return std::shared_ptr<PAGThreadPool>(new PAGThreadPool(std::move(taskGroup)));
+}
+
+std::string PAGThreadPool::name() const {
+  return taskGroup->name();
+}
+
+int PAGThreadPool::threadCount() const {
+  return taskGroup->threadCount();
+}
+
+int PAGThreadPool::queueDepth() const {
+  return taskGroup->queueDepth();
+}
+
+int64_t PAGThreadPool::busyTime() const {
+  return taskGroup->busyTime();
+}
+
+int64_t PAGThreadPool::completedTasks() const {
+  return taskGroup->completedTasks();
+}
+
+#else
+
+std::shared_ptr<PAGThreadPool> PAGThreadPool::Make(const std::string&, int,
+                                                   const std::vector<int>&) {
+  return nullptr;
+}
+
+std::string PAGThreadPool::name() const {
+  return "";
+}
+
+int PAGThreadPool::threadCount() const {
+  return 0;
+}
+
+int PAGThreadPool::queueDepth() const {
+  return 0;
+}
+
+int64_t PAGThreadPool::busyTime() const {
+  return 0;
+}
+
+int64_t PAGThreadPool::completedTasks() const {
+  return 0;
+}
+
+#endif
+}  // namespace pag
@@ -98,4 +98,9 @@ Content* ContentCache::createCache(Frame layerFrame) {
   }
   return content;
 }
+
+size_t ContentCache::measureMemory(const Content* content) const {
+  auto graphic = static_cast<const GraphicContent*>(content)->graphic;
+  return sizeof(GraphicContent) + (graphic ? graphic->memoryUsage() : 0);
+}
 }  // namespace pag
\ No newline at end of file
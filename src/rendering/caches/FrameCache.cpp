@@ -0,0 +1,139 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FrameCache.h"
+#include <map>
+
+namespace pag {
+static std::atomic<size_t> frameCacheBudget = {67108864};  // 64M
+static std::atomic<size_t> frameCacheMemory = {0};
+static std::atomic<size_t> retiredMemory = {0};
+
+struct RetiredCache {
+  uint64_t epoch = 0;
+  void* cache = nullptr;
+  void (*deleter)(void*) = nullptr;
+  size_t memory = 0;
+};
+
+static std::mutex retireLocker = {};
+// Increases every time a frame is retired, so the scopes opened later never block its deletion.
+static uint64_t currentEpoch = 0;
+// The number of active scopes opened in each epoch.
+static std::map<uint64_t, int> activeScopes = {};
+// The retired frames in epoch order.
+static std::vector<RetiredCache> retiredCaches = {};
+static thread_local int scopeDepth = 0;
+static thread_local uint64_t scopeEpoch = 0;
+
+// Moves the retired frames that can no longer be referenced into expiredCaches. A frame retired in
+// an epoch earlier than the oldest active scope was removed from its FrameCache before any of the
+// active scopes started. Must be called with the retireLocker held.
+static void CollectExpiredCaches(std::vector<RetiredCache>* expiredCaches) {
+  auto oldestEpoch = activeScopes.empty() ? currentEpoch : activeScopes.begin()->first;
+  auto position = retiredCaches.begin();
+  while (position != retiredCaches.end() && position->epoch < oldestEpoch) {
+    position++;
+  }
+  expiredCaches->insert(expiredCaches->end(), retiredCaches.begin(), position);
+  retiredCaches.erase(retiredCaches.begin(), position);
+}
+
+static void DeleteExpiredCaches(const std::vector<RetiredCache>& expiredCaches) {
+  for (auto& item : expiredCaches) {
+    item.deleter(item.cache);
+    retiredMemory -= item.memory;
+    frameCacheMemory -= item.memory;
+  }
+}
+
+FrameCacheScope::FrameCacheScope() {
+  if (scopeDepth++ > 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> autoLock(retireLocker);
+  scopeEpoch = currentEpoch;
+  activeScopes[scopeEpoch]++;
+}
+
+FrameCacheScope::~FrameCacheScope() {
+  if (--scopeDepth > 0) {
+    return;
+  }
+  std::vector<RetiredCache> expiredCaches = {};
+  {
+    std::lock_guard<std::mutex> autoLock(retireLocker);
+    auto result = activeScopes.find(scopeEpoch);
+    if (--result->second == 0) {
+      activeScopes.erase(result);
+    }
+    if (!retiredCaches.empty()) {
+      CollectExpiredCaches(&expiredCaches);
+    }
+  }
+  DeleteExpiredCaches(expiredCaches);
+}
+
+size_t FrameCacheBudget::GetBudget() {
+  return frameCacheBudget;
+}
+
+void FrameCacheBudget::SetBudget(size_t budget) {
+  frameCacheBudget = budget;
+}
+
+size_t FrameCacheBudget::TotalMemory() {
+  return frameCacheMemory;
+}
+
+size_t FrameCacheBudget::RetiredMemory() {
+  return retiredMemory;
+}
+
+void FrameCacheBudget::AddMemory(size_t memory) {
+  frameCacheMemory += memory;
+}
+
+void FrameCacheBudget::RemoveMemory(size_t memory) {
+  frameCacheMemory -= memory;
+}
+
+bool FrameCacheBudget::OverBudget() {
+  return frameCacheMemory > frameCacheBudget;
+}
+
+bool FrameCacheBudget::LiveOverBudget() {
+  size_t totalMemory = frameCacheMemory;
+  size_t retired = retiredMemory;
+  return totalMemory > retired && totalMemory - retired > frameCacheBudget;
+}
+
+void FrameCacheBudget::Retire(void* cache, void (*deleter)(void*), size_t memory) {
+  retiredMemory += memory;
+  std::vector<RetiredCache> expiredCaches = {};
+  {
+    std::lock_guard<std::mutex> autoLock(retireLocker);
+    retiredCaches.push_back({currentEpoch++, cache, deleter, memory});
+    if (activeScopes.empty()) {
+      // Nobody is holding any frame, such as when the caches are used without a FrameCacheScope.
+      CollectExpiredCaches(&expiredCaches);
+    }
+  }
+  DeleteExpiredCaches(expiredCaches);
+}
+}  // namespace pag
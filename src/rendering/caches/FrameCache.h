@@ -18,10 +18,76 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
 #include <unordered_map>
 #include "pag/file.h"
 
 namespace pag {
+// The frames around the requested one are never released, which covers the adjacent frames read by
+// motion blur and PAGPlayers playing the same File at close progresses.
+static constexpr Frame FRAME_CACHE_WINDOW = 30;
+/**
+ * FrameCacheScope marks a period in which the current thread may hold the pointers returned by
+ * FrameCache::getCache(). The frames released by FrameCaches are retired rather than deleted, and
+ * a retired frame is only deleted once every scope that was active when it was released has
+ * ended. Scopes can be nested, and LockGuard opens one for every API call holding the root locker.
+ */
+class FrameCacheScope {
+ public:
+  FrameCacheScope();
+  ~FrameCacheScope();
+
+  FrameCacheScope(const FrameCacheScope&) = delete;
+  FrameCacheScope& operator=(const FrameCacheScope&) = delete;
+};
+
+/**
+ * FrameCacheBudget keeps the total memory usage of all FrameCaches in the process, including the
+ * retired frames waiting to be deleted. Once the total exceeds the budget, the FrameCache creating
+ * a new frame releases its own frames farthest from the new one, except those within
+ * FRAME_CACHE_WINDOW.
+ */
+class FrameCacheBudget {
+ public:
+  /**
+   * Returns the memory limit in bytes of all FrameCaches in the process.
+   */
+  static size_t GetBudget();
+
+  /**
+   * Sets the memory limit in bytes of all FrameCaches in the process.
+   */
+  static void SetBudget(size_t budget);
+
+  /**
+   * Returns the estimated memory usage in bytes of all FrameCaches in the process, including the
+   * retired frames which are not deleted yet.
+   */
+  static size_t TotalMemory();
+
+  /**
+   * Returns the estimated memory usage in bytes of the retired frames which are not deleted yet.
+   */
+  static size_t RetiredMemory();
+
+ private:
+  static void AddMemory(size_t memory);
+  static void RemoveMemory(size_t memory);
+  static bool OverBudget();
+  /**
+   * Returns true if the frames still kept by the FrameCaches exceed the budget. Releasing more
+   * frames does not help once it returns false, the retired ones are deleted when the scopes end.
+   */
+  static bool LiveOverBudget();
+  static void Retire(void* cache, void (*deleter)(void*), size_t memory);
+
+  template <typename T>
+  friend class FrameCache;
+};
+
 template <typename T>
 class FrameCache : public Cache {
  public:
@@ -36,8 +102,9 @@ class FrameCache : public Cache {
 
   ~FrameCache() override {
     for (auto& item : frames) {
-      delete item.second;
+      delete item.second.cache;
     }
+    FrameCacheBudget::RemoveMemory(cacheMemory);
   }
 
   virtual T* getCache(Frame contentFrame) {
@@ -49,10 +116,21 @@ class FrameCache : public Cache {
       contentFrame = 0;
     }
     std::lock_guard<std::mutex> autoLock(locker);
-    auto cache = frames[contentFrame];
-    if (cache == nullptr) {
-      cache = createCache(contentFrame + startTime);
-      frames[contentFrame] = cache;
+    auto result = frames.find(contentFrame);
+    if (result != frames.end() && result->second.cache != nullptr) {
+      return result->second.cache;
+    }
+    auto cache = createCache(contentFrame + startTime);
+    auto memory = cache ? measureMemory(cache) : 0;
+    if (result != frames.end()) {
+      result->second = {cache, memory};
+    } else {
+      frames[contentFrame] = {cache, memory};
+    }
+    cacheMemory += memory;
+    FrameCacheBudget::AddMemory(memory);
+    if (FrameCacheBudget::OverBudget()) {
+      releaseFrames(contentFrame);
     }
     return cache;
   }
@@ -61,6 +139,14 @@ class FrameCache : public Cache {
     return &staticTimeRanges;
   }
 
+  /**
+   * Returns the estimated memory usage in bytes of the frames kept by this cache.
+   */
+  size_t memoryUsage() const {
+    std::lock_guard<std::mutex> autoLock(locker);
+    return cacheMemory;
+  }
+
  protected:
   Frame startTime = 0;
   Frame duration = 1;
@@ -68,8 +154,56 @@ class FrameCache : public Cache {
 
   virtual T* createCache(Frame layerFrame) = 0;
 
+  /**
+   * Returns the estimated memory usage in bytes of the specified frame.
+   */
+  virtual size_t measureMemory(const T*) const {
+    return sizeof(T);
+  }
+
  private:
-  std::mutex locker = {};
-  std::unordered_map<Frame, T*> frames;
+  struct FrameEntry {
+    T* cache = nullptr;
+    size_t memory = 0;
+  };
+
+  mutable std::mutex locker = {};
+  std::unordered_map<Frame, FrameEntry> frames;
+  size_t cacheMemory = 0;
+
+  static void DeleteCache(void* cache) {
+    delete static_cast<T*>(cache);
+  }
+
+  void releaseFrames(Frame currentFrame) {
+    if (!FrameCacheBudget::LiveOverBudget()) {
+      // Only the retired frames exceed the budget, they are deleted when the current scopes end.
+      return;
+    }
+    std::vector<Frame> candidates = {};
+    for (auto& item : frames) {
+      if (std::abs(item.first - currentFrame) > FRAME_CACHE_WINDOW) {
+        candidates.push_back(item.first);
+      }
+    }
+    std::sort(candidates.begin(), candidates.end(), [currentFrame](Frame a, Frame b) {
+      return std::abs(a - currentFrame) > std::abs(b - currentFrame);
+    });
+    for (auto frame : candidates) {
+      auto result = frames.find(frame);
+      cacheMemory -= result->second.memory;
+      if (result->second.cache != nullptr) {
+        // The pointer may still be held by the callers of getCache() on other threads, so it is
+        // deleted after their scopes end. Its memory stays in the budget until then.
+        FrameCacheBudget::Retire(result->second.cache, DeleteCache, result->second.memory);
+      } else {
+        FrameCacheBudget::RemoveMemory(result->second.memory);
+      }
+      frames.erase(result);
+      if (!FrameCacheBudget::LiveOverBudget()) {
+        break;
+      }
+    }
+  }
 };
 }  // namespace pag
@@ -103,6 +103,17 @@ Layer* LayerCache::getLayer() const {
   return layer;
 }
 
+size_t LayerCache::memoryUsage() const {
+  auto usage = contentCache->memoryUsage() + transformCache->memoryUsage();
+  if (maskCache) {
+    usage += maskCache->memoryUsage();
+  }
+  if (featherMaskCache) {
+    usage += featherMaskCache->memoryUsage();
+  }
+  return usage;
+}
+
 tgfx::Point LayerCache::getMaxScaleFactor() const {
   return maxScaleFactor;
 }
@@ -41,6 +41,11 @@ class LayerCache : public Cache {
 
   Layer* getLayer() const;
 
+  /**
+   * Returns the estimated memory usage in bytes of the frames kept by this cache.
+   */
+  size_t memoryUsage() const;
+
   tgfx::Point getMaxScaleFactor() const;
 
   bool checkFrameChanged(Frame contentFrame, Frame lastContentFrame);
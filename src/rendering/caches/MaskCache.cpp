@@ -36,6 +36,11 @@ tgfx::Path* MaskCache::createCache(Frame layerFrame) {
   return maskContent;
 }
 
+size_t MaskCache::measureMemory(const tgfx::Path* path) const {
+  return sizeof(tgfx::Path) + static_cast<size_t>(path->countPoints()) * sizeof(tgfx::Point) +
+         static_cast<size_t>(path->countVerbs());
+}
+
 FeatherMaskCache::FeatherMaskCache(Layer* layer)
     : FrameCache<GraphicContent>(layer->startTime, layer->duration), layer(layer) {
   std::vector<TimeRange> timeRanges = {layer->visibleRange()};
@@ -49,4 +54,8 @@ GraphicContent* FeatherMaskCache::createCache(Frame layerFrame) {
   auto featherMask = FeatherMask::MakeFrom(layer->masks, layerFrame);
   return new GraphicContent(featherMask);
 }
+
+size_t FeatherMaskCache::measureMemory(const GraphicContent* content) const {
+  return sizeof(GraphicContent) + (content->graphic ? content->graphic->memoryUsage() : 0);
+}
 }  // namespace pag
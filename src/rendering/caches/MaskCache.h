@@ -30,6 +30,8 @@ class MaskCache : public FrameCache<tgfx::Path> {
  protected:
   tgfx::Path* createCache(Frame layerFrame) override;
 
+  size_t measureMemory(const tgfx::Path* path) const override;
+
  private:
   Layer* layer = nullptr;
 };
@@ -41,6 +43,8 @@ class FeatherMaskCache : public FrameCache<GraphicContent> {
  protected:
   GraphicContent* createCache(Frame layerFrame) override;
 
+  size_t measureMemory(const GraphicContent* content) const override;
+
  private:
   Layer* layer = nullptr;
 };
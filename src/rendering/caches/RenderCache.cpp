@@ -17,6 +17,7 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "RenderCache.h"
+#include <algorithm>
 #include <functional>
 #include "base/utils/TimeUtil.h"
 #include "base/utils/UniqueID.h"
@@ -27,6 +28,7 @@
 #include "rendering/sequences/VideoReader.h"
 #include "rendering/sequences/VideoSequenceDemuxer.h"
 #include "rendering/video/VideoDecoder.h"
+#include "rendering/video/VideoDecoderPool.h"
 #include "tgfx/core/Clock.h"
 
 #ifdef PAG_BUILD_FOR_WEB
@@ -34,21 +36,25 @@
 #endif
 
 namespace pag {
-// 300M设置的大一些用于兜底，通常在大于20M时就开始随时清理。
-#define MAX_GRAPHICS_MEMORY 314572800
-#define PURGEABLE_GRAPHICS_MEMORY 20971520  // 20M
-#define PURGEABLE_EXPIRED_FRAME 10
 #define SCALE_FACTOR_PRECISION 0.001f
+#define PREFETCH_SAFETY_FACTOR 3
+#define MIN_PLAYBACK_RATE 0.25f
+#define MAX_PLAYBACK_RATE 4.0f
+// The longer intervals between two prepareLayers() calls are pauses rather than playing.
+#define MAX_PREPARE_INTERVAL 100000
+#define MAX_LOOP_CACHE_DURATION 3000000
 
 class ImageTask : public Executor {
  public:
   static std::shared_ptr<Task> MakeAndRun(std::shared_ptr<tgfx::ImageCodec> codec,
-                                          std::shared_ptr<File> file) {
+                                          std::shared_ptr<File> file, TaskPriority priority,
+                                          int64_t deadline, std::shared_ptr<TaskGroup> taskGroup) {
     if (codec == nullptr) {
       return nullptr;
     }
     auto bitmap = new ImageTask(std::move(codec), file);
-    auto task = Task::Make(std::unique_ptr<ImageTask>(bitmap));
+    auto task =
+        Task::Make(std::unique_ptr<ImageTask>(bitmap), priority, deadline, std::move(taskGroup));
     task->run();
     return task;
   }
@@ -57,8 +63,13 @@ class ImageTask : public Executor {
     return buffer;
   }
 
+  int64_t getDecodingTime() const {
+    return decodingTime;
+  }
+
  private:
   std::shared_ptr<tgfx::ImageBuffer> buffer = {};
+  int64_t decodingTime = 0;
   std::shared_ptr<tgfx::ImageCodec> codec = nullptr;
   // Make a reference to file when image made from imageByte of file.
   std::shared_ptr<File> file = nullptr;
@@ -68,7 +79,9 @@ class ImageTask : public Executor {
   }
 
   void execute() override {
+    tgfx::Clock clock = {};
     buffer = codec->makeBuffer();
+    decodingTime = clock.measure();
   }
 };
 
@@ -95,6 +108,41 @@ void RenderCache::setVideoEnabled(bool value) {
   clearAllSequenceCaches();
 }
 
+void RenderCache::setTaskGroup(std::shared_ptr<TaskGroup> group) {
+  if (taskGroup == group) {
+    return;
+  }
+  taskGroup = std::move(group);
+  imageTasks.clear();
+  clearAllSequenceCaches();
+}
+
+void RenderCache::setCacheBudget(const PAGCacheBudget& value) {
+  auto loopCacheRaised = value.loopingVideoFrames > budget.loopingVideoFrames;
+  budget = value;
+  if (loopCacheRaised) {
+    // Turns the loop caches purged by a lower budget back on while they fit.
+    for (auto& item : sequenceCaches) {
+      for (auto reader : item.second) {
+        if (reader->loopCacheAllowed && reader->loopCacheMemory() == 0) {
+          enableLoopCache(static_cast<VideoReader*>(reader));
+        }
+      }
+    }
+  } else {
+    purgeLoopCaches();
+  }
+}
+
+PAGCacheUsage RenderCache::cacheUsage() const {
+  PAGCacheUsage usage = {};
+  usage.snapshots = snapshotMemory;
+  usage.textAtlases = textAtlasMemory;
+  usage.sequenceReaders = sequenceMemory();
+  usage.filterBuffers = filterMemory();
+  return usage;
+}
+
 bool RenderCache::initFilter(Filter* filter) {
   tgfx::Clock clock = {};
   auto result = filter->initialize(getContext());
@@ -102,10 +150,59 @@ bool RenderCache::initFilter(Filter* filter) {
   return result;
 }
 
+ID RenderCache::GetPrefetchAssetID(PAGLayer* pagLayer) {
+  if (pagLayer->layerType() == LayerType::PreCompose) {
+    return static_cast<PreComposeLayer*>(pagLayer->layer)->composition->uniqueID;
+  }
+  auto pagImage = static_cast<PAGImageLayer*>(pagLayer)->getPAGImage();
+  if (pagImage != nullptr) {
+    return pagImage->uniqueID();
+  }
+  return static_cast<ImageLayer*>(pagLayer->layer)->imageBytes->uniqueID;
+}
+
+size_t RenderCache::EstimateDecodedMemory(PAGLayer* pagLayer) {
+  int width = 0;
+  int height = 0;
+  if (pagLayer->layerType() == LayerType::PreCompose) {
+    auto composition = static_cast<PreComposeLayer*>(pagLayer->layer)->composition;
+    width = composition->width;
+    height = composition->height;
+  } else if (auto pagImage = static_cast<PAGImageLayer*>(pagLayer)->getPAGImage()) {
+    width = pagImage->width();
+    height = pagImage->height();
+  } else {
+    auto bounds = pagLayer->layer->getBounds();
+    width = static_cast<int>(ceilf(bounds.width()));
+    height = static_cast<int>(ceilf(bounds.height()));
+  }
+  return static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
+}
+
 void RenderCache::prepareLayers(int64_t timeDistance) {
+  auto adaptive = timeDistance == ADAPTIVE_VISIBLE_DISTANCE;
+  if (adaptive) {
+    updatePlaybackRate();
+    updateDecodingCosts();
+    timeDistance = MAX_DECODING_VISIBLE_DISTANCE;
+  }
   auto layerDistances = stage->findNearlyVisibleLayersIn(timeDistance);
+  auto now = tgfx::Clock::Now();
+  layerHorizons = {};
+  size_t prefetchMemory = 0;
+  // The layers are not visible yet, so the decoding tasks are speculative and should never delay
+  // the tasks needed by the current frame. The closer layers get the earlier deadlines, and the
+  // farther ones are skipped once the decoded frames may exceed the budget.
+  taskPriority = TaskPriority::Prefetch;
   for (auto& item : layerDistances) {
+    taskDeadline = now + item.first;
     for (auto pagLayer : item.second) {
+      auto horizon = adaptive ? prefetchHorizon(GetPrefetchAssetID(pagLayer)) : timeDistance;
+      layerHorizons[pagLayer->uniqueID()] = horizon;
+      if (item.first > horizon || prefetchMemory >= budget.prefetchMemory) {
+        continue;
+      }
+      prefetchMemory += EstimateDecodedMemory(pagLayer);
       if (pagLayer->layerType() == LayerType::PreCompose) {
         preparePreComposeLayer(static_cast<PreComposeLayer*>(pagLayer->layer));
       } else if (pagLayer->layerType() == LayerType::Image) {
@@ -113,6 +210,70 @@ void RenderCache::prepareLayers(int64_t timeDistance) {
       }
     }
   }
+  taskPriority = TaskPriority::Immediate;
+  taskDeadline = NO_DEADLINE;
+}
+
+void RenderCache::updatePlaybackRate() {
+  auto root = stage->getRootComposition();
+  if (root == nullptr) {
+    return;
+  }
+  auto now = tgfx::Clock::Now();
+  auto globalFrame = root->localFrameToGlobal(root->currentFrameInternal());
+  auto contentTime = FrameToTime(globalFrame, stage->frameRateInternal());
+  auto interval = now - lastPrepareTimestamp;
+  if (lastPrepareTimestamp > 0 && interval > 0 && interval < MAX_PREPARE_INTERVAL) {
+    auto distance = contentTime - lastContentTime;
+    if (distance < 0) {
+      // The playing has looped back to the start.
+      distance += root->durationInternal();
+    }
+    auto rate = static_cast<float>(distance) / static_cast<float>(interval);
+    rate = std::max(MIN_PLAYBACK_RATE, std::min(rate, MAX_PLAYBACK_RATE));
+    playbackRate = playbackRate * 0.75f + rate * 0.25f;
+    prepareInterval = prepareInterval > 0 ? (prepareInterval * 3 + interval) / 4 : interval;
+  }
+  lastPrepareTimestamp = now;
+  lastContentTime = contentTime;
+}
+
+void RenderCache::updateDecodingCosts() {
+  for (auto& item : decodingCosts) {
+    auto& cost = item.second;
+    if (cost.pendingTime == 0) {
+      continue;
+    }
+    // The lookahead tasks may decode several frames between two calls.
+    auto frameTime = cost.pendingTime / std::max(cost.pendingFrames, static_cast<int64_t>(1));
+    // Rises immediately to cover the slow frames, such as the ones decoded from a keyframe after
+    // seeking, but decays slowly.
+    if (frameTime > cost.perFrame) {
+      cost.perFrame = frameTime;
+    } else {
+      cost.perFrame = (cost.perFrame * 7 + frameTime) / 8;
+    }
+    cost.pendingTime = 0;
+    cost.pendingFrames = 0;
+  }
+}
+
+int64_t RenderCache::prefetchHorizon(ID assetID) const {
+  auto result = decodingCosts.find(assetID);
+  if (result == decodingCosts.end() || result->second.perFrame <= 0) {
+    return DECODING_VISIBLE_DISTANCE;
+  }
+  // The decoding task may wait behind the others for a while, and it has to start at least one
+  // prepareLayers() call before the layer becomes visible.
+  auto wallTime = result->second.perFrame * PREFETCH_SAFETY_FACTOR + prepareInterval;
+  auto horizon = static_cast<int64_t>(static_cast<float>(wallTime) * playbackRate);
+  return std::min(horizon, MAX_DECODING_VISIBLE_DISTANCE);
+}
+
+void RenderCache::recordDecodingCost(ID assetID, int64_t time, int64_t frames) {
+  auto& cost = decodingCosts[assetID];
+  cost.pendingTime += time;
+  cost.pendingFrames += frames;
 }
 
 void RenderCache::preparePreComposeLayer(PreComposeLayer* layer) {
@@ -136,6 +297,9 @@ void RenderCache::preparePreComposeLayer(PreComposeLayer* layer) {
     return;
   }
   auto sequence = Sequence::Get(composition);
+  if (sequence == nullptr) {
+    return;
+  }
   auto targetFrame = sequence->toSequenceFrame(compositionFrame);
   auto result = sequenceCaches.find(assetID);
   if (result != sequenceCaches.end()) {
@@ -146,7 +310,7 @@ void RenderCache::preparePreComposeLayer(PreComposeLayer* layer) {
   }
   auto reader = makeSequenceReader(sequence);
   if (reader) {
-    reader->prepare(targetFrame);
+    reader->prepare(targetFrame, taskPriority, taskDeadline);
   }
 }
 
@@ -174,6 +338,18 @@ void RenderCache::clearExpiredSequences() {
   for (auto& id : expiredSequences) {
     clearSequenceCache(id);
   }
+  VideoDecoderPool::GetInstance()->purgeExpired();
+}
+
+void RenderCache::setSharedCacheEnabled(bool value) {
+  if (_sharedCacheEnabled == value) {
+    return;
+  }
+  _sharedCacheEnabled = value;
+  clearAllSnapshots();
+  clearAllTextAtlas();
+  // The shared cache is retrieved again in the next attachToContext() call.
+  sharedCache = nullptr;
 }
 
 bool RenderCache::snapshotEnabled() const {
@@ -188,9 +364,41 @@ void RenderCache::setSnapshotEnabled(bool value) {
   clearAllSnapshots();
 }
 
+void RenderCache::setSnapshotScaleMode(PAGSnapshotScaleMode mode) {
+  if (_snapshotScaleMode == mode) {
+    return;
+  }
+  _snapshotScaleMode = mode;
+  clearAllSnapshots();
+}
+
+float RenderCache::getSnapshotScale(float scaleFactor) const {
+  if (_snapshotScaleMode == PAGSnapshotScaleMode::Exact || scaleFactor < SCALE_FACTOR_PRECISION) {
+    return scaleFactor;
+  }
+  // Rounds up to the nearest power of √2, the epsilon keeps the exact powers in their own buckets.
+  auto level = ceilf(2 * log2f(scaleFactor) - 1e-3f);
+  return exp2f(level * 0.5f);
+}
+
+bool RenderCache::canReuseSnapshot(const Snapshot* snapshot, float scaleFactor) const {
+  auto snapshotScale = snapshot->scaleFactor();
+  if (fabsf(snapshotScale - scaleFactor) <= SCALE_FACTOR_PRECISION) {
+    return true;
+  }
+  if (_snapshotScaleMode == PAGSnapshotScaleMode::Exact || snapshotScale < scaleFactor) {
+    return false;
+  }
+  // A larger bucket is sampled down with mipmaps, but no further than half of its scale, which
+  // keeps the wasted memory and sampling cost low.
+  return snapshotScale <= scaleFactor * 2 + SCALE_FACTOR_PRECISION;
+}
+
 void RenderCache::beginFrame() {
+  frameCount++;
   usedAssets = {};
   usedSequences = {};
+  usedFilters = {};
   resetPerformance();
 }
 
@@ -202,6 +410,9 @@ void RenderCache::attachToContext(tgfx::Context* current, bool forHitTest) {
   }
   context = current;
   deviceID = context->device()->uniqueID();
+  if (_sharedCacheEnabled && sharedCache == nullptr) {
+    sharedCache = SharedGraphicsCache::Get(deviceID);
+  }
   hitTestOnly = forHitTest;
   if (hitTestOnly) {
     return;
@@ -220,14 +431,17 @@ void RenderCache::attachToContext(tgfx::Context* current, bool forHitTest) {
 void RenderCache::releaseAll() {
   clearAllSnapshots();
   clearAllTextAtlas();
-  graphicsMemory = 0;
+  snapshotMemory = 0;
+  textAtlasMemory = 0;
   clearAllSequenceCaches();
   for (auto& item : filterCaches) {
     delete item.second;
   }
   filterCaches.clear();
+  filterUsedFrames.clear();
   delete motionBlurFilter;
   motionBlurFilter = nullptr;
+  sharedCache = nullptr;
   deviceID = 0;
 }
 
@@ -237,8 +451,11 @@ void RenderCache::detachFromContext() {
     return;
   }
   clearExpiredSequences();
+  purgeUnusedSequences();
   clearExpiredBitmaps();
   clearExpiredSnapshots();
+  purgeUnusedTextAtlases();
+  purgeUnusedFilters();
   context->purgeResourcesNotUsedSince(lastTimestamp);
   lastTimestamp = tgfx::Clock::Now();
   context = nullptr;
@@ -256,15 +473,23 @@ Snapshot* RenderCache::getSnapshot(ID assetID) const {
 }
 
 Snapshot* RenderCache::makeSnapshot(float scaleFactor, const std::function<Snapshot*()>& maker) {
-  if (scaleFactor < SCALE_FACTOR_PRECISION || graphicsMemory >= MAX_GRAPHICS_MEMORY) {
+  if (scaleFactor < SCALE_FACTOR_PRECISION) {
     return nullptr;
   }
+  purgeUnusedSnapshots();
+  if (snapshotMemory >= budget.snapshots) {
+    return nullptr;
+  }
+  tgfx::Clock clock = {};
   auto snapshot = maker();
   if (snapshot == nullptr) {
     return nullptr;
   }
-  graphicsMemory += snapshot->memoryUsage();
+  snapshot->makingTime = clock.measure();
+  snapshotMemory += snapshot->memoryUsage();
   snapshotLRU.push_front(snapshot);
+  snapshot->lruPosition = snapshotLRU.begin();
+  updateSnapshotPriority(snapshot);
   return snapshot;
 }
 
@@ -272,27 +497,94 @@ Snapshot* RenderCache::getSnapshot(const Picture* image) {
   if (!_snapshotEnabled) {
     return nullptr;
   }
-  usedAssets.insert(image->assetID);
-  auto maxScaleFactor = stage->getAssetMaxScale(image->assetID);
+  auto assetID = image->assetID;
+  usedAssets.insert(assetID);
+  auto maxScaleFactor = getSnapshotScale(stage->getAssetMaxScale(assetID));
   auto scaleFactor = image->getScaleFactor(maxScaleFactor);
-  auto snapshot = getSnapshot(image->assetID);
-  if (snapshot && (snapshot->makerKey != image->uniqueKey ||
-                   fabsf(snapshot->scaleFactor() - scaleFactor) > SCALE_FACTOR_PRECISION)) {
-    removeSnapshot(image->assetID);
+  auto snapshot = getSnapshot(assetID);
+  if (snapshot && snapshot->makerKey != image->uniqueKey) {
+    removeSnapshot(assetID);
     snapshot = nullptr;
   }
-  if (snapshot) {
+  if (snapshot && canReuseSnapshot(snapshot, scaleFactor)) {
     moveSnapshotToHead(snapshot);
     return snapshot;
   }
-  snapshot =
-      makeSnapshot(scaleFactor, [&]() { return image->makeSnapshot(this, scaleFactor).release(); });
+  auto result = downscaledSnapshots.find(assetID);
+  if (result != downscaledSnapshots.end()) {
+    // The second snapshot is stale too if the image was replaced.
+    if (result->second->makerKey == image->uniqueKey &&
+        canReuseSnapshot(result->second, scaleFactor)) {
+      moveSnapshotToHead(result->second);
+      return result->second;
+    }
+    removeSnapshot(&downscaledSnapshots, assetID);
+  }
+  bool downscaled = false;
+  if (snapshot) {
+    if (_snapshotScaleMode != PAGSnapshotScaleMode::BucketedWithDownscale) {
+      removeSnapshot(assetID);
+    } else if (scaleFactor < snapshot->scaleFactor()) {
+      // Keeps the larger one, the new snapshot becomes the second one.
+      downscaled = true;
+    } else {
+      // Zooming in, the current snapshot becomes the second one.
+      downscaledSnapshots[assetID] = snapshot;
+      snapshotCaches.erase(assetID);
+    }
+  }
+  snapshot = makeSnapshot(scaleFactor, [&]() { return makePictureSnapshot(image, scaleFactor); });
   if (snapshot == nullptr) {
     return nullptr;
   }
-  snapshot->assetID = image->assetID;
+  snapshot->assetID = assetID;
   snapshot->makerKey = image->uniqueKey;
-  snapshotCaches[image->assetID] = snapshot;
+  if (downscaled) {
+    downscaledSnapshots[assetID] = snapshot;
+  } else {
+    snapshotCaches[assetID] = snapshot;
+  }
+  return snapshot;
+}
+
+static uint32_t QuantizeScaleFactor(float scaleFactor) {
+  return static_cast<uint32_t>(roundf(scaleFactor / SCALE_FACTOR_PRECISION));
+}
+
+Snapshot* RenderCache::makePictureSnapshot(const Picture* image, float scaleFactor) {
+  if (sharedCache == nullptr) {
+    _snapshotRasterizingCount++;
+    auto snapshot = image->makeSnapshot(this, scaleFactor).release();
+    if (snapshot != nullptr && _snapshotScaleMode != PAGSnapshotScaleMode::Exact) {
+      snapshot->generateMipmaps();
+    }
+    return snapshot;
+  }
+  // The assetID and uniqueKey of a picture are the same in all PAGPlayers if they render the same
+  // File without replacements.
+  tgfx::BytesKey key = {};
+  key.write(static_cast<uint32_t>(LayerType::Image));
+  key.write(image->assetID);
+  key.write(static_cast<uint32_t>(image->uniqueKey));
+  key.write(static_cast<uint32_t>(image->uniqueKey >> 32));
+  key.write(QuantizeScaleFactor(scaleFactor));
+  // The snapshots have mipmaps in the bucketed modes only, players in different modes must not
+  // share them.
+  key.write(static_cast<uint32_t>(_snapshotScaleMode));
+  tgfx::Matrix matrix = {};
+  auto texture = sharedCache->getSnapshot(key, &matrix);
+  if (texture != nullptr) {
+    return new Snapshot(texture, matrix);
+  }
+  _snapshotRasterizingCount++;
+  auto snapshot = image->makeSnapshot(this, scaleFactor).release();
+  if (snapshot != nullptr && _snapshotScaleMode != PAGSnapshotScaleMode::Exact) {
+    snapshot->generateMipmaps();
+  }
+  if (snapshot != nullptr && snapshot->getTexture() != nullptr) {
+    sharedCache->addSnapshot(key, snapshot->getTexture(), snapshot->getMatrix(),
+                             snapshot->memoryUsage());
+  }
   return snapshot;
 }
 
@@ -315,9 +607,9 @@ Snapshot* RenderCache::getSnapshot(const Shape* shape) {
     return nullptr;
   }
   usedAssets.insert(shape->assetID);
-  auto scaleFactor = stage->getAssetMaxScale(shape->assetID);
+  auto scaleFactor = getSnapshotScale(stage->getAssetMaxScale(shape->assetID));
   auto snapshot = getSnapshot(shape->assetID, shape->path);
-  if (snapshot && fabsf(snapshot->scaleFactor() - scaleFactor) > SCALE_FACTOR_PRECISION) {
+  if (snapshot && !canReuseSnapshot(snapshot, scaleFactor)) {
     removeSnapshot(shape->assetID, shape->path);
     snapshot = nullptr;
   }
@@ -325,8 +617,13 @@ Snapshot* RenderCache::getSnapshot(const Shape* shape) {
     moveSnapshotToHead(snapshot);
     return snapshot;
   }
-  snapshot =
-      makeSnapshot(scaleFactor, [&]() { return shape->makeSnapshot(this, scaleFactor).release(); });
+  snapshot = makeSnapshot(scaleFactor, [&]() {
+    auto shapeSnapshot = shape->makeSnapshot(this, scaleFactor).release();
+    if (shapeSnapshot != nullptr && _snapshotScaleMode != PAGSnapshotScaleMode::Exact) {
+      shapeSnapshot->generateMipmaps();
+    }
+    return shapeSnapshot;
+  });
   if (snapshot == nullptr) {
     return nullptr;
   }
@@ -346,7 +643,7 @@ void RenderCache::removeSnapshot(ID assetID, const tgfx::Path& path) {
     return;
   }
   removeSnapshotFromLRU(snapshot->second);
-  graphicsMemory -= snapshot->second->memoryUsage();
+  snapshotMemory -= snapshot->second->memoryUsage();
   delete snapshot->second;
   snapshotCache->second.erase(snapshot);
   if (snapshotCache->second.empty()) {
@@ -359,7 +656,7 @@ void RenderCache::removePathSnapshots(ID assetID) {
   if (snapshotCache != pathCaches.end()) {
     for (const auto& pair : snapshotCache->second) {
       removeSnapshotFromLRU(pair.second);
-      graphicsMemory -= pair.second->memoryUsage();
+      snapshotMemory -= pair.second->memoryUsage();
       delete pair.second;
     }
     pathCaches.erase(assetID);
@@ -367,27 +664,39 @@ void RenderCache::removePathSnapshots(ID assetID) {
 }
 
 void RenderCache::removeSnapshot(ID assetID) {
-  auto snapshot = snapshotCaches.find(assetID);
-  if (snapshot == snapshotCaches.end()) {
+  removeSnapshot(&snapshotCaches, assetID);
+  removeSnapshot(&downscaledSnapshots, assetID);
+}
+
+void RenderCache::removeSnapshot(std::unordered_map<ID, Snapshot*>* caches, ID assetID) {
+  auto snapshot = caches->find(assetID);
+  if (snapshot == caches->end()) {
     return;
   }
   removeSnapshotFromLRU(snapshot->second);
-  graphicsMemory -= snapshot->second->memoryUsage();
+  snapshotMemory -= snapshot->second->memoryUsage();
   delete snapshot->second;
-  snapshotCaches.erase(assetID);
+  caches->erase(snapshot);
 }
 
 void RenderCache::moveSnapshotToHead(Snapshot* snapshot) {
-  removeSnapshotFromLRU(snapshot);
+  // splice() keeps the lruPosition of the snapshot valid.
+  snapshotLRU.splice(snapshotLRU.begin(), snapshotLRU, snapshot->lruPosition);
   snapshot->idleFrames = 0;
-  snapshotLRU.push_front(snapshot);
+  updateSnapshotPriority(snapshot);
 }
 
 void RenderCache::removeSnapshotFromLRU(Snapshot* snapshot) {
-  auto position = std::find(snapshotLRU.begin(), snapshotLRU.end(), snapshot);
-  if (position != snapshotLRU.end()) {
-    snapshotLRU.erase(position);
-  }
+  snapshotLRU.erase(snapshot->lruPosition);
+  snapshot->lruPosition = snapshotLRU.end();
+}
+
+void RenderCache::updateSnapshotPriority(Snapshot* snapshot) {
+  // GreedyDual-Size: the snapshots which are expensive to remake and take up less memory are kept
+  // longer. The inflation value ages the snapshots that have not been used for a while.
+  auto memory = std::max(snapshot->memoryUsage(), static_cast<size_t>(1));
+  snapshot->priority = snapshotInflation + static_cast<double>(snapshot->makingTime + 1) /
+                                               static_cast<double>(memory);
 }
 
 TextAtlas* RenderCache::getTextAtlas(ID assetID) const {
@@ -395,10 +704,11 @@ TextAtlas* RenderCache::getTextAtlas(ID assetID) const {
   if (textAtlas == textAtlases.end()) {
     return nullptr;
   }
-  return textAtlas->second;
+  return textAtlas->second.get();
 }
 
 TextAtlas* RenderCache::getTextAtlas(const TextBlock* textBlock) {
+  usedAssets.insert(textBlock->assetID());
   auto maxScaleFactor = stage->getAssetMaxScale(textBlock->assetID());
   auto textAtlas = getTextAtlas(textBlock->assetID());
   if (textAtlas && (textAtlas->textGlyphsID() != textBlock->id() ||
@@ -407,17 +717,39 @@ TextAtlas* RenderCache::getTextAtlas(const TextBlock* textBlock) {
     textAtlas = nullptr;
   }
   if (textAtlas) {
+    textAtlasUsedFrames[textBlock->assetID()] = frameCount;
     return textAtlas;
   }
   if (maxScaleFactor < SCALE_FACTOR_PRECISION) {
     return nullptr;
   }
-  textAtlas = TextAtlas::Make(textBlock, this, maxScaleFactor).release();
-  if (textAtlas) {
-    graphicsMemory += textAtlas->memoryUsage();
-    textAtlases[textBlock->assetID()] = textAtlas;
+  purgeUnusedTextAtlases();
+  if (textAtlasMemory >= budget.textAtlases) {
+    // The text is drawn glyph by glyph without an atlas.
+    return nullptr;
+  }
+  std::shared_ptr<TextAtlas> sharedAtlas = nullptr;
+  tgfx::BytesKey key = {};
+  if (sharedCache != nullptr) {
+    key.write(static_cast<uint32_t>(LayerType::Text));
+    key.write(textBlock->assetID());
+    key.write(textBlock->id());
+    key.write(QuantizeScaleFactor(maxScaleFactor));
+    sharedAtlas = sharedCache->getTextAtlas(key);
+  }
+  if (sharedAtlas == nullptr) {
+    sharedAtlas = TextAtlas::Make(textBlock, this, maxScaleFactor);
+    if (sharedAtlas != nullptr && sharedCache != nullptr) {
+      sharedCache->addTextAtlas(key, sharedAtlas);
+    }
   }
-  return textAtlas;
+  if (sharedAtlas == nullptr) {
+    return nullptr;
+  }
+  textAtlasMemory += sharedAtlas->memoryUsage();
+  textAtlases[textBlock->assetID()] = sharedAtlas;
+  textAtlasUsedFrames[textBlock->assetID()] = frameCount;
+  return sharedAtlas.get();
 }
 
 void RenderCache::removeTextAtlas(ID assetID) {
@@ -425,28 +757,54 @@ void RenderCache::removeTextAtlas(ID assetID) {
   if (textAtlas == textAtlases.end()) {
     return;
   }
-  graphicsMemory -= textAtlas->second->memoryUsage();
-  delete textAtlas->second;
+  textAtlasMemory -= textAtlas->second->memoryUsage();
   textAtlases.erase(textAtlas);
+  textAtlasUsedFrames.erase(assetID);
+}
+
+void RenderCache::purgeUnusedTextAtlases() {
+  if (textAtlasMemory < budget.textAtlases) {
+    return;
+  }
+  std::vector<ID> unusedAtlases = {};
+  for (auto& item : textAtlases) {
+    if (usedAssets.count(item.first) == 0) {
+      unusedAtlases.push_back(item.first);
+    }
+  }
+  std::sort(unusedAtlases.begin(), unusedAtlases.end(), [this](ID a, ID b) {
+    return textAtlasUsedFrames[a] < textAtlasUsedFrames[b];
+  });
+  for (auto assetID : unusedAtlases) {
+    if (textAtlasMemory < budget.textAtlases) {
+      break;
+    }
+    removeTextAtlas(assetID);
+  }
 }
 
 void RenderCache::clearAllTextAtlas() {
-  for (auto atlas : textAtlases) {
-    graphicsMemory -= atlas.second->memoryUsage();
-    delete atlas.second;
+  for (auto& atlas : textAtlases) {
+    textAtlasMemory -= atlas.second->memoryUsage();
   }
   textAtlases.clear();
+  textAtlasUsedFrames.clear();
 }
 
 void RenderCache::clearAllSnapshots() {
   for (auto& item : snapshotCaches) {
-    graphicsMemory -= item.second->memoryUsage();
+    snapshotMemory -= item.second->memoryUsage();
     delete item.second;
   }
   snapshotCaches.clear();
+  for (auto& item : downscaledSnapshots) {
+    snapshotMemory -= item.second->memoryUsage();
+    delete item.second;
+  }
+  downscaledSnapshots.clear();
   for (auto& item : pathCaches) {
     for (auto& snapshot : item.second) {
-      graphicsMemory -= snapshot.second->memoryUsage();
+      snapshotMemory -= snapshot.second->memoryUsage();
       delete snapshot.second;
     }
   }
@@ -454,9 +812,8 @@ void RenderCache::clearAllSnapshots() {
   snapshotLRU.clear();
 }
 
-void RenderCache::clearExpiredSnapshots() {
-  std::vector<Snapshot*> expiredSnapshots;
-  size_t releaseMemory = 0;
+std::vector<Snapshot*> RenderCache::getUnusedSnapshots() const {
+  std::vector<Snapshot*> unusedSnapshots = {};
   for (auto snapshotIter = snapshotLRU.rbegin(); snapshotIter != snapshotLRU.rend();
        snapshotIter++) {
     auto* snapshot = *snapshotIter;
@@ -465,21 +822,81 @@ void RenderCache::clearExpiredSnapshots() {
     if (usedAssets.count(snapshot->assetID) > 0) {
       break;
     }
+    unusedSnapshots.push_back(snapshot);
+  }
+  return unusedSnapshots;
+}
+
+void RenderCache::SortByPriority(std::vector<Snapshot*>* snapshots) {
+  // The snapshots are in LRU order, the ones with the same priority are still released in LRU
+  // order.
+  std::stable_sort(snapshots->begin(), snapshots->end(),
+                   [](Snapshot* a, Snapshot* b) { return a->priority < b->priority; });
+}
+
+void RenderCache::releaseSnapshot(Snapshot* snapshot) {
+  snapshotInflation = std::max(snapshotInflation, snapshot->priority);
+  // Only removes the released one, the other snapshot of the same asset may be in the releasing
+  // list too.
+  auto result = downscaledSnapshots.find(snapshot->assetID);
+  if (result != downscaledSnapshots.end() && result->second == snapshot) {
+    removeSnapshot(&downscaledSnapshots, snapshot->assetID);
+  } else if (snapshot->path.isEmpty()) {
+    removeSnapshot(&snapshotCaches, snapshot->assetID);
+  } else {
+    removeSnapshot(snapshot->assetID, snapshot->path);
+  }
+}
+
+void RenderCache::clearExpiredSnapshots() {
+  auto unusedSnapshots = getUnusedSnapshots();
+  std::vector<Snapshot*> expiredSnapshots;
+  std::vector<Snapshot*> idleSnapshots;
+  size_t releaseMemory = 0;
+  for (auto snapshot : unusedSnapshots) {
     snapshot->idleFrames++;
-    if (snapshot->idleFrames < PURGEABLE_EXPIRED_FRAME &&
-        graphicsMemory + releaseMemory < PURGEABLE_GRAPHICS_MEMORY) {
-      // 总显存占用未超过20M且所有缓存均未超过10帧未使用，跳过清理。
-      continue;
+    // 超过 expiredFrames 帧未使用的缓存总是被清理。
+    if (snapshot->idleFrames >= budget.expiredFrames) {
+      releaseMemory += snapshot->memoryUsage();
+      expiredSnapshots.push_back(snapshot);
+    } else {
+      idleSnapshots.push_back(snapshot);
     }
-    releaseMemory += snapshot->memoryUsage();
-    expiredSnapshots.push_back(snapshot);
   }
-  for (const auto& snapshot : expiredSnapshots) {
-    if (snapshot->path.isEmpty()) {
-      removeSnapshot(snapshot->assetID);
-    } else {
-      removeSnapshot(snapshot->assetID, snapshot->path);
+  auto totalMemory = memoryUsage();
+  auto overBudget = [&]() {
+    return snapshotMemory - releaseMemory > budget.snapshots ||
+           totalMemory - releaseMemory >= budget.purgeableMemory;
+  };
+  if (overBudget()) {
+    // Only sorts the snapshots when some of them have to be evicted, which is rare once the cache
+    // has warmed up.
+    SortByPriority(&idleSnapshots);
+    for (auto snapshot : idleSnapshots) {
+      if (!overBudget()) {
+        break;
+      }
+      releaseMemory += snapshot->memoryUsage();
+      expiredSnapshots.push_back(snapshot);
+    }
+  }
+  for (auto snapshot : expiredSnapshots) {
+    releaseSnapshot(snapshot);
+  }
+}
+
+void RenderCache::purgeUnusedSnapshots() {
+  if (snapshotMemory < budget.snapshots) {
+    return;
+  }
+  // Releases the snapshots not used by the current frame to make room for the new one.
+  auto unusedSnapshots = getUnusedSnapshots();
+  SortByPriority(&unusedSnapshots);
+  for (auto snapshot : unusedSnapshots) {
+    if (snapshotMemory < budget.snapshots) {
+      break;
     }
+    releaseSnapshot(snapshot);
   }
 }
 
@@ -489,7 +906,8 @@ void RenderCache::prepareImage(ID assetID, std::shared_ptr<tgfx::ImageCodec> cod
     return;
   }
   auto layer = stage->getLayerFromReferenceMap(assetID);
-  auto task = ImageTask::MakeAndRun(std::move(codec), layer->getFile());
+  auto task = ImageTask::MakeAndRun(std::move(codec), layer->getFile(), taskPriority, taskDeadline,
+                                    taskGroup);
   if (task) {
     imageTasks[assetID] = task;
   }
@@ -501,6 +919,7 @@ std::shared_ptr<tgfx::ImageBuffer> RenderCache::getImageBuffer(ID assetID) {
   if (result != imageTasks.end()) {
     auto executor = result->second->wait();
     auto buffer = static_cast<ImageTask*>(executor)->getBuffer();
+    recordDecodingCost(assetID, static_cast<ImageTask*>(executor)->getDecodingTime(), 1);
     // 预测生成的 Bitmap 取了一次就应该销毁，上层会进行缓存。
     imageTasks.erase(result);
     return buffer;
@@ -533,7 +952,7 @@ void RenderCache::prepareSequence(Sequence* sequence, Frame targetFrame) {
   }
   auto reader = getSequenceReader(sequence, targetFrame);
   if (reader) {
-    reader->prepare(targetFrame);
+    reader->prepare(targetFrame, taskPriority, taskDeadline);
   }
 }
 
@@ -547,7 +966,17 @@ std::shared_ptr<tgfx::Texture> RenderCache::getSequenceFrame(Sequence* sequence,
     return nullptr;
   }
   auto composition = sequence->composition;
+  auto uploadingTime = textureUploadingTime;
   auto texture = reader->readTexture(targetFrame, this);
+  // Includes the frames decoded in background since the last call.
+  auto decodingTime = reader->decodingTime();
+  auto decodedFrames = reader->decodedFrames();
+  recordDecodingCost(composition->uniqueID,
+                     decodingTime - reader->reportedDecodingTime + textureUploadingTime -
+                         uploadingTime,
+                     decodedFrames - reader->reportedDecodedFrames);
+  reader->reportedDecodingTime = decodingTime;
+  reader->reportedDecodedFrames = decodedFrames;
   if (composition->staticContent()) {
     // There is no need to cache a reader for the static sequence, it has already been cached as
     // a snapshot. We get here because the reader was created by prepare() methods.
@@ -558,6 +987,7 @@ std::shared_ptr<tgfx::Texture> RenderCache::getSequenceFrame(Sequence* sequence,
       }
       sequenceCaches.erase(result);
     }
+    decodingCosts.erase(composition->uniqueID);
   }
   return texture;
 }
@@ -578,6 +1008,7 @@ SequenceReader* RenderCache::getSequenceReader(Sequence* sequence, Frame targetF
     reader = makeSequenceReader(sequence);
   }
   if (reader != nullptr) {
+    reader->lastUsedFrame = frameCount;
     sequenceMap[targetFrame] = reader;
   }
   return reader;
@@ -626,6 +1057,11 @@ SequenceReader* RenderCache::findNearestSequenceReader(Sequence* sequence, Frame
   return reader;
 }
 
+static bool LoopCacheAllowed(VideoSequence* sequence) {
+  return !sequence->composition->staticContent() &&
+         FrameToTime(sequence->duration(), sequence->frameRate) <= MAX_LOOP_CACHE_DURATION;
+}
+
 SequenceReader* RenderCache::makeSequenceReader(Sequence* sequence) {
   SequenceReader* reader = nullptr;
   auto composition = sequence->composition;
@@ -641,15 +1077,23 @@ SequenceReader* RenderCache::makeSequenceReader(Sequence* sequence) {
     if (VideoDecoder::HasExternalSoftwareDecoder()) {
       auto demuxer =
           std::make_unique<VideoSequenceDemuxer>(layer->rootFile->getFile(), videoSequence);
-      reader = new VideoReader(std::move(demuxer));
+      auto videoReader = new VideoReader(std::move(demuxer));
+      videoReader->loopCacheAllowed = LoopCacheAllowed(videoSequence);
+      enableLoopCache(videoReader);
+      reader = videoReader;
     } else {
       reader = new VideoSequenceReader(layer, videoSequence);
     }
 #else
     auto demuxer = std::make_unique<VideoSequenceDemuxer>(layer->getFile(), videoSequence);
-    reader = new VideoReader(std::move(demuxer));
+    auto videoReader = new VideoReader(std::move(demuxer));
+    videoReader->loopCacheAllowed = LoopCacheAllowed(videoSequence);
+    enableLoopCache(videoReader);
+    reader = videoReader;
 #endif
   }
+  reader->taskGroup = taskGroup;
+  reader->setLookaheadDepth(_sequenceLookahead);
   auto assetID = sequence->composition->uniqueID;
   auto result = sequenceCaches.find(assetID);
   if (result == sequenceCaches.end()) {
@@ -660,12 +1104,22 @@ SequenceReader* RenderCache::makeSequenceReader(Sequence* sequence) {
   return reader;
 }
 
+void RenderCache::setSequenceLookahead(int frames) {
+  _sequenceLookahead = std::max(frames, 1);
+  for (auto& item : sequenceCaches) {
+    for (auto reader : item.second) {
+      reader->setLookaheadDepth(_sequenceLookahead);
+    }
+  }
+}
+
 void RenderCache::clearAllSequenceCaches() {
   for (auto& item : sequenceCaches) {
     removeSnapshot(item.first);
     for (auto reader : item.second) {
       delete reader;
     }
+    decodingCosts.erase(item.first);
   }
   sequenceCaches.clear();
 }
@@ -679,6 +1133,97 @@ void RenderCache::clearSequenceCache(ID uniqueID) {
     }
     sequenceCaches.erase(result);
   }
+  decodingCosts.erase(uniqueID);
+}
+
+size_t RenderCache::sequenceMemory() const {
+  size_t usage = 0;
+  for (auto& item : sequenceCaches) {
+    for (auto reader : item.second) {
+      usage += reader->memoryUsage();
+    }
+  }
+  return usage;
+}
+
+size_t RenderCache::loopCacheMemory() const {
+  size_t usage = 0;
+  for (auto& item : sequenceCaches) {
+    for (auto reader : item.second) {
+      usage += reader->loopCacheMemory();
+    }
+  }
+  return usage;
+}
+
+void RenderCache::enableLoopCache(VideoReader* reader) {
+  if (budget.loopingVideoFrames == 0 || !reader->loopCacheAllowed) {
+    return;
+  }
+  // The memory of all frames is reserved up front, so that the looping sequences never exceed the
+  // budget together.
+  if (loopCacheMemory() + reader->loopCacheSize() > budget.loopingVideoFrames) {
+    return;
+  }
+  reader->setLoopCacheEnabled(true);
+}
+
+void RenderCache::purgeLoopCaches() {
+  auto usage = loopCacheMemory();
+  for (auto& item : sequenceCaches) {
+    for (auto reader : item.second) {
+      if (usage <= budget.loopingVideoFrames) {
+        return;
+      }
+      auto memory = reader->loopCacheMemory();
+      if (memory > 0) {
+        // Only the VideoReaders keep frames across loops.
+        static_cast<VideoReader*>(reader)->setLoopCacheEnabled(false);
+        usage -= memory;
+      }
+    }
+  }
+}
+
+void RenderCache::purgeUnusedSequences() {
+  auto usage = sequenceMemory();
+  if (usage < budget.sequenceReaders) {
+    return;
+  }
+  // This is called in detachFromContext(), after every frame is drawn, so the readers prepared for
+  // the frame are never released halfway and decoded again. The readers not used by the frame
+  // are either spare ones or created for prefetching, releasing them never blocks the next frame.
+  std::unordered_set<SequenceReader*> usedReaders = {};
+  for (auto& item : usedSequences) {
+    for (auto& pair : item.second) {
+      usedReaders.insert(pair.second);
+    }
+  }
+  std::vector<std::pair<ID, SequenceReader*>> unusedReaders = {};
+  for (auto& item : sequenceCaches) {
+    for (auto reader : item.second) {
+      if (usedReaders.count(reader) == 0) {
+        unusedReaders.emplace_back(item.first, reader);
+      }
+    }
+  }
+  std::sort(unusedReaders.begin(), unusedReaders.end(),
+            [](const std::pair<ID, SequenceReader*>& a, const std::pair<ID, SequenceReader*>& b) {
+              return a.second->lastUsedFrame < b.second->lastUsedFrame;
+            });
+  for (auto& item : unusedReaders) {
+    if (usage < budget.sequenceReaders) {
+      break;
+    }
+    usage -= std::min(usage, item.second->memoryUsage());
+    auto& readers = sequenceCaches[item.first];
+    readers.erase(std::find(readers.begin(), readers.end(), item.second));
+    delete item.second;
+    if (readers.empty()) {
+      decodingCosts.erase(item.first);
+      sequenceCaches.erase(item.first);
+    }
+  }
 }
 
 //===================================== filter caches =====================================
@@ -696,6 +1241,8 @@ LayerFilter* RenderCache::getFilterCache(Effect* effect) {
 
 LayerFilter* RenderCache::getLayerFilterCache(ID uniqueID,
                                               const std::function<LayerFilter*()>& makeFilter) {
+  usedFilters.insert(uniqueID);
+  filterUsedFrames[uniqueID] = frameCount;
   LayerFilter* filter = nullptr;
   auto result = filterCaches.find(uniqueID);
   if (result == filterCaches.end()) {
@@ -714,6 +1261,7 @@ LayerFilter* RenderCache::getLayerFilterCache(ID uniqueID,
 }
 
 MotionBlurFilter* RenderCache::getMotionBlurFilter() {
+  motionBlurUsedFrame = frameCount;
   if (motionBlurFilter == nullptr) {
     motionBlurFilter = new MotionBlurFilter();
     if (!initFilter(motionBlurFilter)) {
@@ -725,6 +1273,8 @@ MotionBlurFilter* RenderCache::getMotionBlurFilter() {
 }
 
 LayerStylesFilter* RenderCache::getLayerStylesFilter(Layer* layer) {
+  usedFilters.insert(layer->uniqueID);
+  filterUsedFrames[layer->uniqueID] = frameCount;
   LayerStylesFilter* filter = nullptr;
   auto result = filterCaches.find(layer->uniqueID);
   if (result == filterCaches.end()) {
@@ -747,6 +1297,58 @@ void RenderCache::clearFilterCache(ID uniqueID) {
     delete result->second;
     filterCaches.erase(result);
   }
+  filterUsedFrames.erase(uniqueID);
+}
+
+size_t RenderCache::filterMemory() const {
+  size_t usage = 0;
+  for (auto& item : filterCaches) {
+    usage += item.second->memoryUsage();
+  }
+  if (motionBlurFilter != nullptr) {
+    usage += motionBlurFilter->memoryUsage();
+  }
+  return usage;
+}
+
+void RenderCache::purgeUnusedFilters() {
+  auto usage = filterMemory();
+  if (usage < budget.filterBuffers) {
+    return;
+  }
+  std::vector<std::pair<int64_t, Filter*>> unusedFilters = {};
+  for (auto& item : filterCaches) {
+    if (usedFilters.count(item.first) == 0) {
+      unusedFilters.emplace_back(filterUsedFrames[item.first], item.second);
+    }
+  }
+  // The MotionBlurFilter is shared by all layers, it is unused if no layer drew with it this frame.
+  if (motionBlurFilter != nullptr && motionBlurUsedFrame < frameCount) {
+    unusedFilters.emplace_back(motionBlurUsedFrame, motionBlurFilter);
+  }
+  std::sort(unusedFilters.begin(), unusedFilters.end(),
+            [](const std::pair<int64_t, Filter*>& a, const std::pair<int64_t, Filter*>& b) {
+              return a.first < b.first;
+            });
+  for (auto& item : unusedFilters) {
+    if (usage < budget.filterBuffers) {
+      break;
+    }
+    auto filter = item.second;
+    usage -= std::min(usage, filter->memoryUsage());
+    if (filter == motionBlurFilter) {
+      motionBlurFilter = nullptr;
+    } else {
+      for (auto& cache : filterCaches) {
+        if (cache.second == filter) {
+          filterUsedFrames.erase(cache.first);
+          filterCaches.erase(cache.first);
+          break;
+        }
+      }
+    }
+    delete filter;
+  }
 }
 
 void RenderCache::recordImageDecodingTime(int64_t decodingTime) {
@@ -21,6 +21,7 @@
 #include <list>
 #include <memory>
 #include <unordered_set>
+#include "SharedGraphicsCache.h"
 #include "TextAtlas.h"
 #include "TextBlock.h"
 #include "pag/file.h"
@@ -34,10 +35,13 @@
 #include "rendering/graphics/Snapshot.h"
 #include "rendering/layers/PAGStage.h"
 #include "rendering/sequences/SequenceReader.h"
+#include "rendering/sequences/VideoReader.h"
 #include "tgfx/gpu/Device.h"
 
 namespace pag {
-static constexpr int64_t DECODING_VISIBLE_DISTANCE = 500000;  // 提前 500ms 开始解码。
+static constexpr int64_t DECODING_VISIBLE_DISTANCE = 500000;  // 默认提前 500ms 开始解码。
+static constexpr int64_t MAX_DECODING_VISIBLE_DISTANCE = 3000000;  // 最多提前 3s 开始解码。
+static constexpr int64_t ADAPTIVE_VISIBLE_DISTANCE = -1;
 
 class RenderCache : public Performance {
  public:
@@ -59,9 +63,27 @@ class RenderCache : public Performance {
    * Returns the total memory usage of this cache.
    */
   size_t memoryUsage() const {
-    return graphicsMemory;
+    return snapshotMemory + textAtlasMemory;
   }
 
+  /**
+   * Returns the memory limits of each category of caches.
+   */
+  PAGCacheBudget cacheBudget() const {
+    return budget;
+  }
+
+  /**
+   * Sets the memory limits of each category of caches. The caches exceeding the new limits are
+   * released on the next detachFromContext() call.
+   */
+  void setCacheBudget(const PAGCacheBudget& value);
+
+  /**
+   * Returns the memory usage of each category of caches.
+   */
+  PAGCacheUsage cacheUsage() const;
+
   /**
    * Returns the GPU context associated with this cache.
    */
@@ -79,6 +101,39 @@ class RenderCache : public Performance {
    */
   void setSnapshotEnabled(bool value);
 
+  /**
+   * If set to true, the snapshots of pictures and the text atlases are shared with other
+   * RenderCaches of the same device. The default value is false.
+   */
+  bool sharedCacheEnabled() const {
+    return _sharedCacheEnabled;
+  }
+
+  /**
+   * Set the value of sharedCacheEnabled property.
+   */
+  void setSharedCacheEnabled(bool value);
+
+  /**
+   * Returns how the snapshots of pictures and shapes follow the changes of their scale factors.
+   */
+  PAGSnapshotScaleMode snapshotScaleMode() const {
+    return _snapshotScaleMode;
+  }
+
+  /**
+   * Set the value of snapshotScaleMode property, all snapshots are released if it changes.
+   */
+  void setSnapshotScaleMode(PAGSnapshotScaleMode mode);
+
+  /**
+   * Returns the number of picture snapshots rasterized since this cache was created. The snapshots
+   * of shapes and the ones reused from the shared cache are not counted.
+   */
+  size_t snapshotRasterizingCount() const {
+    return _snapshotRasterizingCount;
+  }
+
   /**
    * Returns true if there is snapshot cache available for specified asset ID.
    */
@@ -125,6 +180,54 @@ class RenderCache : public Performance {
 
   void setVideoEnabled(bool value);
 
+  /**
+   * Returns the TaskGroup used by this cache for background decoding. Returns nullptr if it uses
+   * the default TaskGroup.
+   */
+  std::shared_ptr<TaskGroup> getTaskGroup() const {
+    return taskGroup;
+  }
+
+  /**
+   * Sets the TaskGroup for background decoding, all pending decoding tasks and sequence caches are
+   * released if the TaskGroup changes.
+   */
+  void setTaskGroup(std::shared_ptr<TaskGroup> group);
+
+  /**
+   * Returns the number of frames decoded ahead by each sequence reader.
+   */
+  int sequenceLookahead() const {
+    return _sequenceLookahead;
+  }
+
+  /**
+   * Sets the number of frames decoded ahead by each sequence reader.
+   */
+  void setSequenceLookahead(int frames);
+
+  /**
+   * Returns the time distance in microseconds ahead of which the upcoming layers of the specified
+   * asset start decoding. It is estimated from the measured decoding and uploading time of the
+   * asset and the current playback rate. Returns DECODING_VISIBLE_DISTANCE if the asset has never
+   * been decoded.
+   */
+  int64_t prefetchHorizon(ID assetID) const;
+
+  /**
+   * Returns the prefetch horizons of the upcoming layers chosen by the last prepareLayers() call,
+   * keyed by the uniqueID of the layers.
+   */
+  std::unordered_map<ID, int64_t> prefetchHorizons() const {
+    return layerHorizons;
+  }
+
+  /**
+   * Records the time spent on decoding and uploading the specified number of frames of an asset.
+   * The time spent only on uploading is recorded with zero frames.
+   */
+  void recordDecodingCost(ID assetID, int64_t time, int64_t frames);
+
   void prepareSequence(Sequence* sequence, Frame targetFrame);
 
   std::shared_ptr<tgfx::Texture> getSequenceFrame(Sequence* sequence, Frame targetFrame);
@@ -152,18 +255,56 @@ class RenderCache : public Performance {
   tgfx::Context* context = nullptr;
   int64_t lastTimestamp = 0;
   bool hitTestOnly = false;
-  size_t graphicsMemory = 0;
+  PAGCacheBudget budget = {};
+  size_t snapshotMemory = 0;
+  size_t textAtlasMemory = 0;
   bool _videoEnabled = true;
   bool _snapshotEnabled = true;
+  bool _sharedCacheEnabled = false;
+  PAGSnapshotScaleMode _snapshotScaleMode = PAGSnapshotScaleMode::Exact;
+  size_t _snapshotRasterizingCount = 0;
+  int _sequenceLookahead = 1;
+  std::shared_ptr<SharedGraphicsCache> sharedCache = nullptr;
+  std::shared_ptr<TaskGroup> taskGroup = nullptr;
+  // The priority and deadline of the decoding tasks created by the prepare methods.
+  TaskPriority taskPriority = TaskPriority::Immediate;
+  int64_t taskDeadline = NO_DEADLINE;
   std::unordered_set<ID> usedAssets = {};
+  // Increases by one every frame. The text atlases, sequence readers and filters record it when
+  // used, so that the least recently used ones are purged first.
+  int64_t frameCount = 0;
   std::unordered_map<ID, Snapshot*> snapshotCaches = {};
+  // The second snapshots of pictures at smaller scales, only used in the
+  // PAGSnapshotScaleMode::BucketedWithDownscale mode.
+  std::unordered_map<ID, Snapshot*> downscaledSnapshots = {};
   std::list<Snapshot*> snapshotLRU = {};
-  std::unordered_map<ID, TextAtlas*> textAtlases = {};
+  // The GreedyDual-Size inflation value, which is the priority of the last released snapshot.
+  double snapshotInflation = 0;
+  std::unordered_map<ID, std::shared_ptr<TextAtlas>> textAtlases = {};
+  std::unordered_map<ID, int64_t> textAtlasUsedFrames = {};
   std::unordered_map<ID, std::shared_ptr<Task>> imageTasks;
   std::unordered_map<ID, std::vector<SequenceReader*>> sequenceCaches = {};
   std::unordered_map<ID, std::unordered_map<Frame, SequenceReader*>> usedSequences = {};
   std::unordered_map<ID, Filter*> filterCaches;
+  std::unordered_set<ID> usedFilters = {};
+  std::unordered_map<ID, int64_t> filterUsedFrames = {};
   MotionBlurFilter* motionBlurFilter = nullptr;
+  int64_t motionBlurUsedFrame = 0;
+  struct DecodingCost {
+    // The estimated time to decode and upload one frame of the asset.
+    int64_t perFrame = 0;
+    // The time and the number of frames recorded since the last prepareLayers() call.
+    int64_t pendingTime = 0;
+    int64_t pendingFrames = 0;
+  };
+  std::unordered_map<ID, DecodingCost> decodingCosts = {};
+  std::unordered_map<ID, int64_t> layerHorizons = {};
+  // The content time advanced per unit of wall time, and the wall time between two prepareLayers()
+  // calls, both are smoothed over the recent calls.
+  float playbackRate = 1.0f;
+  int64_t prepareInterval = 0;
+  int64_t lastPrepareTimestamp = 0;
+  int64_t lastContentTime = 0;
   std::unordered_map<ID, std::unordered_map<tgfx::Path, Snapshot*, tgfx::PathHash>> pathCaches;
 
   // bitmap caches:
@@ -172,36 +313,61 @@ class RenderCache : public Performance {
   // snapshot caches:
   void clearAllSnapshots();
   void clearExpiredSnapshots();
+  void purgeUnusedSnapshots();
+  std::vector<Snapshot*> getUnusedSnapshots() const;
+  void releaseSnapshot(Snapshot* snapshot);
+  static void SortByPriority(std::vector<Snapshot*>* snapshots);
+  float getSnapshotScale(float scaleFactor) const;
+  bool canReuseSnapshot(const Snapshot* snapshot, float scaleFactor) const;
+  void removeSnapshot(std::unordered_map<ID, Snapshot*>* caches, ID assetID);
 
   // sequence caches:
   void clearAllSequenceCaches();
   void clearSequenceCache(ID uniqueID);
   void clearExpiredSequences();
+  size_t sequenceMemory() const;
+  size_t loopCacheMemory() const;
+  void enableLoopCache(VideoReader* reader);
+  void purgeLoopCaches();
+  void purgeUnusedSequences();
 
   // filter caches:
   LayerFilter* getLayerFilterCache(ID uniqueID, const std::function<LayerFilter*()>& makeFilter);
   void clearFilterCache(ID uniqueID);
   bool initFilter(Filter* filter);
+  size_t filterMemory() const;
+  void purgeUnusedFilters();
 
   // text atlas caches:
   void clearAllTextAtlas();
   void removeTextAtlas(ID assetID);
   TextAtlas* getTextAtlas(ID assetID) const;
+  void purgeUnusedTextAtlases();
 
   // path snapshot caches:
   Snapshot* getSnapshot(ID assetID, const tgfx::Path& path) const;
   void removeSnapshot(ID assetID, const tgfx::Path& path);
   void removePathSnapshots(ID assetID);
 
-  void prepareLayers(int64_t timeDistance = DECODING_VISIBLE_DISTANCE);
+  /**
+   * Starts decoding the upcoming layers. The layers of each asset are prepared within its own
+   * prefetch horizon if timeDistance is ADAPTIVE_VISIBLE_DISTANCE, otherwise within timeDistance.
+   */
+  void prepareLayers(int64_t timeDistance = ADAPTIVE_VISIBLE_DISTANCE);
+  void updatePlaybackRate();
+  void updateDecodingCosts();
+  static ID GetPrefetchAssetID(PAGLayer* pagLayer);
+  static size_t EstimateDecodedMemory(PAGLayer* pagLayer);
   void preparePreComposeLayer(PreComposeLayer* layer);
   void prepareImageLayer(PAGImageLayer* layer);
   SequenceReader* getSequenceReader(Sequence* sequence, Frame targetFrame);
   SequenceReader* findNearestSequenceReader(Sequence* sequence, Frame targetFrame);
   SequenceReader* makeSequenceReader(Sequence* sequence);
   Snapshot* makeSnapshot(float scaleFactor, const std::function<Snapshot*()>& maker);
+  Snapshot* makePictureSnapshot(const Picture* image, float scaleFactor);
   void moveSnapshotToHead(Snapshot* snapshot);
   void removeSnapshotFromLRU(Snapshot* snapshot);
+  void updateSnapshotPriority(Snapshot* snapshot);
 
   friend class PAGPlayer;
 };
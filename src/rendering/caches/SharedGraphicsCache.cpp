@@ -0,0 +1,139 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "SharedGraphicsCache.h"
+#include <atomic>
+
+namespace pag {
+static std::mutex sharedCacheLocker = {};
+static std::unordered_map<uint32_t, std::weak_ptr<SharedGraphicsCache>> sharedCacheMap = {};
+static std::atomic<size_t> sharedCacheBudget = {67108864};  // 64M
+
+std::shared_ptr<SharedGraphicsCache> SharedGraphicsCache::Get(uint32_t deviceID) {
+  std::lock_guard<std::mutex> autoLock(sharedCacheLocker);
+  auto result = sharedCacheMap.find(deviceID);
+  if (result != sharedCacheMap.end()) {
+    auto cache = result->second.lock();
+    if (cache != nullptr) {
+      return cache;
+    }
+  }
+  for (auto iter = sharedCacheMap.begin(); iter != sharedCacheMap.end();) {
+    if (iter->second.expired()) {
+      iter = sharedCacheMap.erase(iter);
+    } else {
+      iter++;
+    }
+  }
+  auto cache = std::make_shared<SharedGraphicsCache>();
+  sharedCacheMap[deviceID] = cache;
+  return cache;
+}
+
+size_t SharedGraphicsCache::GetBudget() {
+  return sharedCacheBudget;
+}
+
+void SharedGraphicsCache::SetBudget(size_t budget) {
+  sharedCacheBudget = budget;
+}
+
+std::shared_ptr<tgfx::Texture> SharedGraphicsCache::getSnapshot(const tgfx::BytesKey& key,
+                                                                tgfx::Matrix* matrix) {
+  std::lock_guard<std::mutex> autoLock(locker);
+  auto entry = findEntry(key);
+  if (entry == nullptr || entry->texture == nullptr) {
+    return nullptr;
+  }
+  *matrix = entry->matrix;
+  return entry->texture;
+}
+
+void SharedGraphicsCache::addSnapshot(const tgfx::BytesKey& key,
+                                      std::shared_ptr<tgfx::Texture> texture,
+                                      const tgfx::Matrix& matrix, size_t memoryUsage) {
+  Entry entry = {};
+  entry.texture = std::move(texture);
+  entry.matrix = matrix;
+  entry.memoryUsage = memoryUsage;
+  std::lock_guard<std::mutex> autoLock(locker);
+  addEntry(key, std::move(entry));
+}
+
+std::shared_ptr<TextAtlas> SharedGraphicsCache::getTextAtlas(const tgfx::BytesKey& key) {
+  std::lock_guard<std::mutex> autoLock(locker);
+  auto entry = findEntry(key);
+  if (entry == nullptr) {
+    return nullptr;
+  }
+  return entry->textAtlas;
+}
+
+void SharedGraphicsCache::addTextAtlas(const tgfx::BytesKey& key,
+                                       std::shared_ptr<TextAtlas> textAtlas) {
+  Entry entry = {};
+  entry.memoryUsage = textAtlas->memoryUsage();
+  entry.textAtlas = std::move(textAtlas);
+  std::lock_guard<std::mutex> autoLock(locker);
+  addEntry(key, std::move(entry));
+}
+
+size_t SharedGraphicsCache::memoryUsage() const {
+  std::lock_guard<std::mutex> autoLock(locker);
+  return totalMemory;
+}
+
+SharedGraphicsCache::Entry* SharedGraphicsCache::findEntry(const tgfx::BytesKey& key) {
+  auto result = entries.find(key);
+  if (result == entries.end()) {
+    return nullptr;
+  }
+  auto entry = &result->second;
+  entryLRU.splice(entryLRU.begin(), entryLRU, entry->lruPosition);
+  return entry;
+}
+
+void SharedGraphicsCache::addEntry(const tgfx::BytesKey& key, Entry entry) {
+  if (entries.count(key) > 0 || !purge(entry.memoryUsage)) {
+    return;
+  }
+  entryLRU.push_front(key);
+  entry.lruPosition = entryLRU.begin();
+  totalMemory += entry.memoryUsage;
+  entries[key] = std::move(entry);
+}
+
+bool SharedGraphicsCache::purge(size_t newMemory) {
+  size_t budget = sharedCacheBudget;
+  auto position = entryLRU.end();
+  while (totalMemory + newMemory > budget && position != entryLRU.begin()) {
+    position--;
+    auto result = entries.find(*position);
+    auto& entry = result->second;
+    // The entries still held by any RenderCache can not be released, their GPU memory would not be
+    // freed anyway.
+    if (entry.texture.use_count() > 1 || entry.textAtlas.use_count() > 1) {
+      continue;
+    }
+    totalMemory -= entry.memoryUsage;
+    position = entryLRU.erase(position);
+    entries.erase(result);
+  }
+  return totalMemory + newMemory <= budget;
+}
+}  // namespace pag
@@ -0,0 +1,102 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include "TextAtlas.h"
+#include "tgfx/core/BytesKey.h"
+#include "tgfx/core/Matrix.h"
+#include "tgfx/gpu/Texture.h"
+
+namespace pag {
+/**
+ * SharedGraphicsCache keeps the snapshot textures and text atlases made by the RenderCaches of the
+ * same GPU device, so that PAGPlayers rendering the same content can reuse them instead of
+ * rasterizing again. An entry is referenced as long as any RenderCache still holds it, and only the
+ * unreferenced ones are released when the total memory exceeds the global budget.
+ */
+class SharedGraphicsCache {
+ public:
+  /**
+   * Returns the SharedGraphicsCache of the specified device, a new one is created if there is no
+   * RenderCache holding it.
+   */
+  static std::shared_ptr<SharedGraphicsCache> Get(uint32_t deviceID);
+
+  /**
+   * Returns the memory limit in bytes of the SharedGraphicsCache of each device.
+   */
+  static size_t GetBudget();
+
+  /**
+   * Sets the memory limit in bytes of the SharedGraphicsCache of each device.
+   */
+  static void SetBudget(size_t budget);
+
+  /**
+   * Returns the snapshot texture associated with the specified key and copies its matrix. Returns
+   * nullptr if there is no such texture.
+   */
+  std::shared_ptr<tgfx::Texture> getSnapshot(const tgfx::BytesKey& key, tgfx::Matrix* matrix);
+
+  /**
+   * Shares the snapshot texture with other RenderCaches. Does nothing if the texture can not fit
+   * into the budget.
+   */
+  void addSnapshot(const tgfx::BytesKey& key, std::shared_ptr<tgfx::Texture> texture,
+                   const tgfx::Matrix& matrix, size_t memoryUsage);
+
+  /**
+   * Returns the text atlas associated with the specified key. Returns nullptr if there is no such
+   * text atlas.
+   */
+  std::shared_ptr<TextAtlas> getTextAtlas(const tgfx::BytesKey& key);
+
+  /**
+   * Shares the text atlas with other RenderCaches. Does nothing if the text atlas can not fit into
+   * the budget.
+   */
+  void addTextAtlas(const tgfx::BytesKey& key, std::shared_ptr<TextAtlas> textAtlas);
+
+  /**
+   * Returns the total memory usage of the shared entries.
+   */
+  size_t memoryUsage() const;
+
+ private:
+  struct Entry {
+    std::shared_ptr<tgfx::Texture> texture = nullptr;
+    tgfx::Matrix matrix = tgfx::Matrix::I();
+    std::shared_ptr<TextAtlas> textAtlas = nullptr;
+    size_t memoryUsage = 0;
+    std::list<tgfx::BytesKey>::iterator lruPosition = {};
+  };
+
+  mutable std::mutex locker = {};
+  size_t totalMemory = 0;
+  std::unordered_map<tgfx::BytesKey, Entry, tgfx::BytesHasher> entries = {};
+  std::list<tgfx::BytesKey> entryLRU = {};
+
+  Entry* findEntry(const tgfx::BytesKey& key);
+  void addEntry(const tgfx::BytesKey& key, Entry entry);
+  bool purge(size_t newMemory);
+};
+}  // namespace pag
@@ -199,4 +199,10 @@ GraphicContent* TextContentCache::createContent(Frame layerFrame) const {
   }
   return content;
 }
+
+size_t TextContentCache::measureMemory(const Content* content) const {
+  auto colorGlyphs = static_cast<const TextContent*>(content)->colorGlyphs;
+  return ContentCache::measureMemory(content) + sizeof(TextContent) - sizeof(GraphicContent) +
+         (colorGlyphs ? colorGlyphs->memoryUsage() : 0);
+}
 }  // namespace pag
@@ -34,6 +34,7 @@ class TextContentCache : public ContentCache {
   void excludeVaryingRanges(std::vector<TimeRange>* timeRanges) const override;
   ID getCacheID() const override;
   GraphicContent* createContent(Frame layerFrame) const override;
+  size_t measureMemory(const Content* content) const override;
 
  private:
   void initTextGlyphs(const std::vector<std::vector<GlyphHandle>>* glyphLines = nullptr);
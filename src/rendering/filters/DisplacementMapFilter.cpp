@@ -118,6 +118,14 @@ void DisplacementMapFilter::updateMapTexture(RenderCache* cache, const Graphic*
   mapSurface->getCanvas()->flush();
 }
 
+size_t DisplacementMapFilter::memoryUsage() const {
+  if (mapSurface == nullptr) {
+    return 0;
+  }
+  // The map surface is a single-sampled RGBA surface.
+  return static_cast<size_t>(mapSurface->width()) * mapSurface->height() * 4;
+}
+
 void DisplacementMapFilter::onUpdateParams(tgfx::Context* context, const tgfx::Rect& contentBounds,
                                            const tgfx::Point&) {
   auto* pagEffect = reinterpret_cast<const DisplacementMapEffect*>(effect);
@@ -96,5 +96,14 @@ class Filter {
   virtual bool needsMSAA() const {
     return false;
   }
+
+  /**
+   * Returns the memory usage of the frame buffers and textures this filter keeps between frames.
+   * Every filter that holds FilterBuffers or surfaces across frames must override it, otherwise
+   * they are not counted against the filter budget of the RenderCache.
+   */
+  virtual size_t memoryUsage() const {
+    return 0;
+  }
 };
 }  // namespace pag
@@ -34,6 +34,10 @@ DropShadowFilter::~DropShadowFilter() {
   delete spreadThickFilter;
 }
 
+size_t DropShadowFilter::memoryUsage() const {
+  return spreadFilterBuffer ? spreadFilterBuffer->memoryUsage() : 0;
+}
+
 bool DropShadowFilter::initialize(tgfx::Context* context) {
   if (!spreadFilter->initialize(context) || !spreadThickFilter->initialize(context)) {
     return false;
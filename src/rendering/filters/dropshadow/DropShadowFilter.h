@@ -41,6 +41,8 @@ class DropShadowFilter : public LayerFilter {
   void draw(tgfx::Context* context, const FilterSource* source,
             const FilterTarget* target) override;
 
+  size_t memoryUsage() const override;
+
  private:
   void updateParamModeNotFullSpread(const tgfx::Rect& contentBounds);
   void updateParamModeFullSpread(const tgfx::Rect& contentBounds);
@@ -33,6 +33,17 @@ GlowFilter::~GlowFilter() {
   delete targetFilter;
 }
 
+size_t GlowFilter::memoryUsage() const {
+  size_t usage = 0;
+  if (blurFilterBufferH) {
+    usage += blurFilterBufferH->memoryUsage();
+  }
+  if (blurFilterBufferV) {
+    usage += blurFilterBufferV->memoryUsage();
+  }
+  return usage;
+}
+
 bool GlowFilter::initialize(tgfx::Context* context) {
   if (!blurFilterH->initialize(context)) {
     return false;
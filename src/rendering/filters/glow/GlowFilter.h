@@ -37,6 +37,8 @@ class GlowFilter : public LayerFilter {
   void update(Frame frame, const tgfx::Rect& contentBounds, const tgfx::Rect& transformedBounds,
               const tgfx::Point& filterScale) override;
 
+  size_t memoryUsage() const override;
+
  private:
   Effect* effect = nullptr;
 
@@ -42,6 +42,12 @@ tgfx::GLSampler FilterBuffer::getTexture() const {
   return texture->glSampler();
 }
 
+size_t FilterBuffer::memoryUsage() const {
+  auto textureSize = static_cast<size_t>(surface->width()) * surface->height() * 4;
+  auto sampleCount = surface->getRenderTarget()->sampleCount();
+  return sampleCount > 1 ? textureSize * (sampleCount + 1) : textureSize;
+}
+
 void FilterBuffer::clearColor() const {
   surface->getCanvas()->clear();
 }
@@ -48,6 +48,11 @@ class FilterBuffer {
     return surface->getRenderTarget()->sampleCount() > 1;
   }
 
+  /**
+   * Returns the memory usage of the texture and the multisample render buffer if it has one.
+   */
+  size_t memoryUsage() const;
+
   tgfx::GLFrameBuffer getFramebuffer() const;
 
   tgfx::GLSampler getTexture() const;
@@ -148,4 +148,8 @@ void FeatherMask::draw(tgfx::Canvas* canvas, RenderCache* renderCache) const {
   auto snapshot = drawFeatherMask(masks, layerFrame, renderCache);
   canvas->drawTexture(snapshot->getTexture());
 }
+
+size_t FeatherMask::memoryUsage() const {
+  return sizeof(FeatherMask) + masks.size() * sizeof(MaskData*);
+}
 }  // namespace pag
@@ -40,6 +40,7 @@ class FeatherMask : public Graphic {
   bool getPath(tgfx::Path* result) const override;
   void prepare(RenderCache* cache) const override;
   void draw(tgfx::Canvas* canvas, RenderCache* cache) const override;
+  size_t memoryUsage() const override;
 
  private:
   FeatherMask(const std::vector<MaskData*>& masks, Frame layerFrame);
@@ -97,5 +97,11 @@ class Graphic {
    * Draw this Graphic into specified Canvas.
    */
   virtual void draw(tgfx::Canvas* canvas, RenderCache* cache) const = 0;
+
+  /**
+   * Returns an estimate of the CPU memory in bytes used by this Graphic. The pixels of images are
+   * excluded, which are counted by the RenderCache once decoded.
+   */
+  virtual size_t memoryUsage() const = 0;
 };
 }  // namespace pag
@@ -144,6 +144,10 @@ class TextureProxyPicture : public Picture {
     canvas->setMatrix(oldMatrix);
   }
 
+  size_t memoryUsage() const override {
+    return sizeof(TextureProxyPicture);
+  }
+
  private:
   TextureProxy* proxy = nullptr;
   bool externalMemory = false;
@@ -234,6 +238,10 @@ class RGBAAAPicture : public Picture {
     DrawDirectly(canvas, proxy->getTexture(cache), &layout);
   }
 
+  size_t memoryUsage() const override {
+    return sizeof(RGBAAAPicture);
+  }
+
  private:
   TextureProxy* proxy = nullptr;
   tgfx::RGBAAALayout layout = {};
@@ -308,6 +316,10 @@ class SnapshotPicture : public Picture {
     canvas->drawTexture(snapshot->getTexture(), snapshot->getMatrix());
   }
 
+  size_t memoryUsage() const override {
+    return sizeof(SnapshotPicture) + graphic->memoryUsage();
+  }
+
  protected:
   float getScaleFactor(float maxScaleFactor) const override {
     return maxScaleFactor;
@@ -386,6 +398,7 @@ class ImageTextureProxy : public TextureProxy {
     auto buffer = cache->getImageBuffer(assetID);
     if (buffer == nullptr) {
       buffer = image->makeBuffer();
+      cache->recordDecodingCost(assetID, clock.measure(), 1);
     }
     cache->recordImageDecodingTime(clock.measure());
     if (buffer == nullptr) {
@@ -393,7 +406,9 @@ class ImageTextureProxy : public TextureProxy {
     }
     clock.reset();
     auto texture = buffer->makeTexture(cache->getContext());
-    cache->recordTextureUploadingTime(clock.measure());
+    auto uploadingTime = clock.measure();
+    cache->recordTextureUploadingTime(uploadingTime);
+    cache->recordDecodingCost(assetID, uploadingTime, 0);
     return texture;
   }
 
@@ -91,6 +91,11 @@ void Shape::draw(tgfx::Canvas* canvas, RenderCache* renderCache) const {
   canvas->drawPath(path, paint);
 }
 
+size_t Shape::memoryUsage() const {
+  return sizeof(Shape) + static_cast<size_t>(path.countPoints()) * sizeof(tgfx::Point) +
+         static_cast<size_t>(path.countVerbs());
+}
+
 std::unique_ptr<Snapshot> MakeMeshSnapshot(tgfx::Path path, RenderCache*, float scaleFactor) {
   auto matrix = tgfx::Matrix::MakeScale(scaleFactor);
   path.transform(matrix);
@@ -45,6 +45,7 @@ class Shape : public Graphic {
   bool getPath(tgfx::Path* result) const override;
   void prepare(RenderCache* cache) const override;
   void draw(tgfx::Canvas* canvas, RenderCache* cache) const override;
+  size_t memoryUsage() const override;
 
  private:
   Shape(ID assetID, tgfx::Path path, std::shared_ptr<tgfx::Shader> shader);
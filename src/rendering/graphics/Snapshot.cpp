@@ -32,10 +32,20 @@ size_t Snapshot::memoryUsage() const {
   } else {
     bytesPerPixels = texture->getSampler()->format == tgfx::PixelFormat::ALPHA_8 ? 1 : 4;
   }
+  if (texture->getSampler()->maxMipMapLevel > 0) {
+    // The mipmaps take up one third more memory.
+    bytesPerPixels *= 4.0f / 3.0f;
+  }
   return static_cast<size_t>(static_cast<float>(texture->width() * texture->height()) *
                              bytesPerPixels);
 }
 
+void Snapshot::generateMipmaps() {
+  if (texture != nullptr) {
+    texture->generateMipmaps();
+  }
+}
+
 bool Snapshot::hitTest(RenderCache* cache, float x, float y) const {
   tgfx::Point local = {x, y};
   if (!MapPointInverted(matrix, &local)) {
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <list>
 #include "pag/types.h"
 #include "tgfx/core/Matrix.h"
 #include "tgfx/core/Mesh.h"
@@ -68,6 +69,12 @@ class Snapshot {
    */
   size_t memoryUsage() const;
 
+  /**
+   * Generates the mipmaps of the texture, which makes the snapshot look smoother when drawn at
+   * smaller sizes. Does nothing if the snapshot has no texture.
+   */
+  void generateMipmaps();
+
   /**
    * Evaluates the Snapshot to see if it overlaps or intersects with the specified point. The point
    * is in the coordinate space of the Snapshot. This method always checks against the actual pixels
@@ -83,6 +90,12 @@ class Snapshot {
   tgfx::Path path = {};
   Frame idleFrames = 0;
   std::unique_ptr<tgfx::Mesh> mesh;
+  // The position in the LRU list of RenderCache, which makes moving and removing O(1).
+  std::list<Snapshot*>::iterator lruPosition = {};
+  // The time cost in microseconds of making this snapshot.
+  int64_t makingTime = 0;
+  // The GreedyDual-Size priority, snapshots with lower priorities are released first.
+  double priority = 0;
 
   friend class RenderCache;
 };
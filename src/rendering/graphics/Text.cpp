@@ -265,6 +265,15 @@ void Text::draw(tgfx::Canvas* canvas, RenderCache* renderCache) const {
   }
 }
 
+size_t Text::memoryUsage() const {
+  auto usage = sizeof(Text) + glyphs.size() * sizeof(GlyphHandle);
+  for (auto textRun : textRuns) {
+    usage += sizeof(TextRun) + textRun->glyphIDs.size() * sizeof(tgfx::GlyphID) +
+             textRun->positions.size() * sizeof(tgfx::Point);
+  }
+  return usage;
+}
+
 struct Parameters {
   size_t textureIndex = 0;
   std::vector<tgfx::Matrix> matrices;
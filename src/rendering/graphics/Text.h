@@ -59,6 +59,7 @@ class Text : public Graphic {
   bool getPath(tgfx::Path* path) const override;
   void prepare(RenderCache* cache) const override;
   void draw(tgfx::Canvas* canvas, RenderCache* cache) const override;
+  size_t memoryUsage() const override;
 
  private:
   Text(std::vector<GlyphHandle> glyphs, std::vector<TextRun*> textRuns, const tgfx::Rect& bounds,
@@ -276,6 +276,22 @@ float PAGStage::getAssetMaxScale(ID referenceID) {
   return getMaxScaleFactor(referenceID) * _cacheScale;
 }
 
+size_t PAGStage::frameCacheMemory() {
+  std::unordered_set<LayerCache*> layerCaches = {};
+  for (auto& item : layerReferenceMap) {
+    for (auto pagLayer : item.second) {
+      if (pagLayer->layerCache != nullptr) {
+        layerCaches.insert(pagLayer->layerCache);
+      }
+    }
+  }
+  size_t usage = 0;
+  for (auto layerCache : layerCaches) {
+    usage += layerCache->memoryUsage();
+  }
+  return usage;
+}
+
 float PAGStage::getMaxScaleFactor(ID referenceID) {
   auto result = scaleFactorCache.find(referenceID);
   if (result != scaleFactorCache.end()) {
@@ -337,6 +353,9 @@ tgfx::Point PAGStage::GetLayerContentScaleFactor(PAGLayer* pagLayer, bool isPAGI
     if (composition->type() == CompositionType::Video ||
         composition->type() == CompositionType::Bitmap) {
       auto sequence = Sequence::Get(composition);
+      if (sequence == nullptr) {
+        return scale;
+      }
       scale.x = static_cast<float>(composition->width) / static_cast<float>(sequence->width);
       scale.y = static_cast<float>(composition->height) / static_cast<float>(sequence->height);
     }
@@ -95,6 +95,12 @@ class PAGStage : public PAGComposition {
 
   float getAssetMaxScale(ID referenceID);
 
+  /**
+   * Returns the estimated memory usage in bytes of the frame caches of all layers on this stage.
+   * The caches shared with other stages are counted in each of them.
+   */
+  size_t frameCacheMemory();
+
  protected:
   void invalidateCacheScale() override {
     PAGComposition::invalidateCacheScale();
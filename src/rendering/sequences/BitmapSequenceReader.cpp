@@ -17,9 +17,42 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "BitmapSequenceReader.h"
+#include <algorithm>
 #include "tgfx/core/ImageCodec.h"
 
 namespace pag {
+// The maximum number of frames whose images are decoded in parallel at a time, which limits the
+// memory of the intermediate buffers.
+static constexpr Frame PARALLEL_DECODING_FRAMES = 8;
+
+class BitmapRectTask : public Executor {
+ public:
+  explicit BitmapRectTask(BitmapRect* bitmapRect) : bitmapRect(bitmapRect) {
+  }
+
+  bool success = false;
+  std::shared_ptr<tgfx::PixelBuffer> pixelBuffer = nullptr;
+
+ private:
+  BitmapRect* bitmapRect = nullptr;
+
+  void execute() override {
+    auto imageBytes = tgfx::Data::MakeWithoutCopy(bitmapRect->fileBytes->data(),
+                                                  bitmapRect->fileBytes->length());
+    auto codec = tgfx::ImageCodec::MakeFrom(imageBytes);
+    if (codec == nullptr) {
+      success = true;
+      return;
+    }
+    pixelBuffer = tgfx::PixelBuffer::Make(codec->width(), codec->height(), false, false);
+    if (pixelBuffer == nullptr) {
+      return;
+    }
+    tgfx::Bitmap bitmap(pixelBuffer);
+    success = codec->readPixels(bitmap.info(), bitmap.writablePixels());
+  }
+};
+
 BitmapSequenceReader::BitmapSequenceReader(std::shared_ptr<File> file, BitmapSequence* sequence)
     : SequenceReader(sequence->duration(), sequence->composition->staticContent()),
       file(std::move(file)), sequence(sequence) {
@@ -28,10 +61,25 @@ BitmapSequenceReader::BitmapSequenceReader(std::shared_ptr<File> file, BitmapSeq
   auto staticContent = sequence->composition->staticContent();
   pixelBuffer = tgfx::PixelBuffer::Make(sequence->width, sequence->height, false, staticContent);
   tgfx::Bitmap(pixelBuffer).eraseAll();
+  auto& frames = sequence->frames;
+  for (size_t i = 0; i < frames.size(); i++) {
+    if (frames[i]->isKeyframe) {
+      keyframes.push_back(static_cast<Frame>(i));
+    }
+  }
 }
 
 BitmapSequenceReader::~BitmapSequenceReader() {
-  lastTask = nullptr;
+  cancelTasks();
+}
+
+size_t BitmapSequenceReader::memoryUsage() const {
+  // The pixelBuffer is allocated once in the constructor, so no locker is needed here.
+  auto usage = SequenceReader::memoryUsage();
+  if (pixelBuffer != nullptr) {
+    usage += pixelBuffer->byteSize();
+  }
+  return usage;
 }
 
 bool BitmapSequenceReader::decodeFrame(Frame targetFrame) {
@@ -45,33 +93,89 @@ bool BitmapSequenceReader::decodeFrame(Frame targetFrame) {
   }
   auto startFrame = findStartFrame(targetFrame);
   lastDecodeFrame = -1;
-  auto& bitmapFrames = static_cast<BitmapSequence*>(sequence)->frames;
   tgfx::Bitmap bitmap(pixelBuffer);
-  for (Frame frame = startFrame; frame <= targetFrame; frame++) {
-    auto bitmapFrame = bitmapFrames[frame];
+  if (startFrame == targetFrame) {
+    if (!decodeBitmapFrame(&bitmap, targetFrame)) {
+      return false;
+    }
+  } else {
+    // Replaying a run of frames usually happens after seeking, decode the images of the run in
+    // parallel and draw them in order.
+    for (Frame frame = startFrame; frame <= targetFrame; frame += PARALLEL_DECODING_FRAMES) {
+      auto endFrame = std::min(frame + PARALLEL_DECODING_FRAMES - 1, targetFrame);
+      if (!decodeBitmapFrames(&bitmap, frame, endFrame)) {
+        return false;
+      }
+    }
+  }
+  lastDecodeFrame = targetFrame;
+  return true;
+}
+
+bool BitmapSequenceReader::decodeBitmapFrame(tgfx::Bitmap* bitmap, Frame frame) {
+  auto bitmapFrame = sequence->frames[static_cast<size_t>(frame)];
+  auto firstRead = true;
+  for (auto bitmapRect : bitmapFrame->bitmaps) {
+    auto imageBytes = tgfx::Data::MakeWithoutCopy(bitmapRect->fileBytes->data(),
+                                                  bitmapRect->fileBytes->length());
+    auto codec = tgfx::ImageCodec::MakeFrom(imageBytes);
+    // The returned image could be nullptr if the frame is an empty frame.
+    if (codec != nullptr) {
+      if (firstRead && bitmapFrame->isKeyframe &&
+          !(codec->width() == bitmap->width() && codec->height() == bitmap->height())) {
+        // clear the whole screen if the size of the key frame is smaller than the screen.
+        bitmap->eraseAll();
+      }
+      auto offset = bitmap->rowBytes() * bitmapRect->y + bitmapRect->x * 4;
+      auto result = codec->readPixels(
+          bitmap->info(), reinterpret_cast<uint8_t*>(bitmap->writablePixels()) + offset);
+      if (!result) {
+        return false;
+      }
+      firstRead = false;
+    }
+  }
+  return true;
+}
+
+bool BitmapSequenceReader::decodeBitmapFrames(tgfx::Bitmap* bitmap, Frame startFrame,
+                                              Frame endFrame) {
+  std::vector<std::shared_ptr<Task>> tasks = {};
+  for (Frame frame = startFrame; frame <= endFrame; frame++) {
+    for (auto bitmapRect : sequence->frames[static_cast<size_t>(frame)]->bitmaps) {
+      auto task = Task::Make(std::unique_ptr<BitmapRectTask>(new BitmapRectTask(bitmapRect)),
+                             TaskPriority::Immediate, NO_DEADLINE, taskGroup);
+      task->run();
+      tasks.push_back(task);
+    }
+  }
+  auto index = 0;
+  for (Frame frame = startFrame; frame <= endFrame; frame++) {
+    auto bitmapFrame = sequence->frames[static_cast<size_t>(frame)];
     auto firstRead = true;
     for (auto bitmapRect : bitmapFrame->bitmaps) {
-      auto imageBytes = tgfx::Data::MakeWithoutCopy(bitmapRect->fileBytes->data(),
-                                                    bitmapRect->fileBytes->length());
-      auto codec = tgfx::ImageCodec::MakeFrom(imageBytes);
-      // The returned image could be nullptr if the frame is an empty frame.
-      if (codec != nullptr) {
-        if (firstRead && bitmapFrame->isKeyframe &&
-            !(codec->width() == bitmap.width() && codec->height() == bitmap.height())) {
-          // clear the whole screen if the size of the key frame is smaller than the screen.
-          bitmap.eraseAll();
-        }
-        auto offset = bitmap.rowBytes() * bitmapRect->y + bitmapRect->x * 4;
-        auto result = codec->readPixels(
-            bitmap.info(), reinterpret_cast<uint8_t*>(bitmap.writablePixels()) + offset);
-        if (!result) {
-          return false;
-        }
-        firstRead = false;
+      auto executor = static_cast<BitmapRectTask*>(tasks[index++]->wait());
+      if (!executor->success) {
+        return false;
+      }
+      auto& buffer = executor->pixelBuffer;
+      // The buffer is nullptr if the frame is an empty frame.
+      if (buffer == nullptr) {
+        continue;
+      }
+      if (firstRead && bitmapFrame->isKeyframe &&
+          !(buffer->width() == bitmap->width() && buffer->height() == bitmap->height())) {
+        // clear the whole screen if the size of the key frame is smaller than the screen.
+        bitmap->eraseAll();
+      }
+      tgfx::Bitmap rectBitmap(buffer);
+      if (!bitmap->writePixels(rectBitmap.info(), rectBitmap.pixels(), bitmapRect->x,
+                               bitmapRect->y)) {
+        return false;
       }
+      firstRead = false;
     }
   }
-  lastDecodeFrame = targetFrame;
   return true;
 }
 
@@ -83,17 +187,60 @@ std::shared_ptr<tgfx::Texture> BitmapSequenceReader::makeTexture(tgfx::Context*
 }
 
 Frame BitmapSequenceReader::findStartFrame(Frame targetFrame) {
-  Frame startFrame = 0;
-  auto& bitmapFrames = static_cast<BitmapSequence*>(sequence)->frames;
-  for (Frame frame = targetFrame; frame >= 0; frame--) {
-    if (frame == lastDecodeFrame + 1 || bitmapFrames[static_cast<size_t>(frame)]->isKeyframe) {
-      startFrame = frame;
-      break;
-    }
+  auto position = std::upper_bound(keyframes.begin(), keyframes.end(), targetFrame);
+  Frame startFrame = position == keyframes.begin() ? 0 : *(position - 1);
+  // Continue from the last decoded frame if it is in the same run as the target frame.
+  if (lastDecodeFrame + 1 > startFrame && lastDecodeFrame < targetFrame) {
+    startFrame = lastDecodeFrame + 1;
   }
   return startFrame;
 }
 
+std::shared_ptr<tgfx::ImageBuffer> BitmapSequenceReader::copyFrame(
+    std::shared_ptr<tgfx::ImageBuffer> reusableBuffer) {
+  std::lock_guard<std::mutex> autoLock(locker);
+  if (lastDecodeFrame == -1 || pixelBuffer == nullptr) {
+    return nullptr;
+  }
+  // The reusable buffers are always raster PixelBuffers made below.
+  auto buffer = std::static_pointer_cast<tgfx::PixelBuffer>(reusableBuffer);
+  if (buffer == nullptr) {
+    buffer = tgfx::PixelBuffer::Make(pixelBuffer->width(), pixelBuffer->height(), false, false);
+    if (buffer == nullptr) {
+      return nullptr;
+    }
+  }
+  tgfx::Bitmap srcBitmap(pixelBuffer);
+  tgfx::Bitmap dstBitmap(buffer);
+  if (!srcBitmap.readPixels(dstBitmap.info(), dstBitmap.writablePixels())) {
+    return nullptr;
+  }
+  return buffer;
+}
+
+size_t BitmapSequenceReader::frameBufferSize() const {
+  return pixelBuffer ? pixelBuffer->byteSize() : 0;
+}
+
+size_t BitmapSequenceReader::uploadBufferSize(const tgfx::ImageBuffer* buffer) const {
+  return static_cast<size_t>(buffer->width()) * buffer->height() * 4;
+}
+
+bool BitmapSequenceReader::writeToUploadBuffer(std::shared_ptr<tgfx::ImageBuffer> buffer,
+                                               void* pixels) const {
+  // The buffers are always the raster PixelBuffers made by copyFrame().
+  tgfx::Bitmap bitmap(std::static_pointer_cast<tgfx::PixelBuffer>(buffer));
+  auto info = tgfx::ImageInfo::Make(bitmap.width(), bitmap.height(), tgfx::ColorType::RGBA_8888,
+                                    tgfx::AlphaType::Premultiplied);
+  return bitmap.readPixels(info, pixels);
+}
+
+std::shared_ptr<tgfx::Texture> BitmapSequenceReader::makeUploadedTexture(
+    const tgfx::ImageBuffer* buffer, tgfx::UploadBuffer* uploadBuffer) const {
+  auto rowBytes = static_cast<size_t>(buffer->width()) * 4;
+  return uploadBuffer->makeRGBATexture(buffer->width(), buffer->height(), rowBytes);
+}
+
 void BitmapSequenceReader::recordPerformance(Performance* performance, int64_t decodingTime) {
   performance->imageDecodingTime += decodingTime;
 }
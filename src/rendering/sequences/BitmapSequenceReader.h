@@ -32,6 +32,8 @@ class BitmapSequenceReader : public SequenceReader {
 
   ~BitmapSequenceReader() override;
 
+  size_t memoryUsage() const override;
+
  protected:
   bool decodeFrame(Frame targetFrame) override;
 
@@ -39,12 +41,31 @@ class BitmapSequenceReader : public SequenceReader {
 
   void recordPerformance(Performance* performance, int64_t decodingTime) override;
 
+  std::shared_ptr<tgfx::ImageBuffer> copyFrame(
+      std::shared_ptr<tgfx::ImageBuffer> reusableBuffer) override;
+
+  size_t frameBufferSize() const override;
+
+  size_t uploadBufferSize(const tgfx::ImageBuffer* buffer) const override;
+
+  bool writeToUploadBuffer(std::shared_ptr<tgfx::ImageBuffer> buffer,
+                           void* pixels) const override;
+
+  std::shared_ptr<tgfx::Texture> makeUploadedTexture(
+      const tgfx::ImageBuffer* buffer, tgfx::UploadBuffer* uploadBuffer) const override;
+
   Frame findStartFrame(Frame targetFrame);
 
+  bool decodeBitmapFrame(tgfx::Bitmap* bitmap, Frame frame);
+
+  bool decodeBitmapFrames(tgfx::Bitmap* bitmap, Frame startFrame, Frame endFrame);
+
   std::mutex locker = {};
   // Keep a reference to the File in case the Sequence object is released while we are using it.
   std::shared_ptr<File> file = nullptr;
   BitmapSequence* sequence = nullptr;
+  // The indices of the keyframes in ascending order.
+  std::vector<Frame> keyframes = {};
   Frame lastDecodeFrame = -1;
   std::shared_ptr<tgfx::PixelBuffer> pixelBuffer = nullptr;
 };
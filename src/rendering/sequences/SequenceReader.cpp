@@ -17,13 +17,16 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "SequenceReader.h"
+#include <algorithm>
 #include "rendering/caches/RenderCache.h"
 
 namespace pag {
 class SequenceTask : public Executor {
  public:
-  static std::shared_ptr<Task> MakeAndRun(SequenceReader* reader, Frame targetFrame) {
-    auto task = Task::Make(std::unique_ptr<SequenceTask>(new SequenceTask(reader, targetFrame)));
+  static std::shared_ptr<Task> MakeAndRun(SequenceReader* reader, Frame targetFrame,
+                                          TaskPriority priority, int64_t deadline) {
+    auto task = Task::Make(std::unique_ptr<SequenceTask>(new SequenceTask(reader, targetFrame)),
+                           priority, deadline, reader->taskGroup);
     task->run();
     return task;
   }
@@ -37,7 +40,63 @@ class SequenceTask : public Executor {
   }
 
   void execute() override {
+    tgfx::Clock clock = {};
     reader->decodeFrame(targetFrame);
+    reader->_decodingTime += clock.measure();
+    reader->_decodedFrames++;
+  }
+};
+
+class LookaheadTask : public Executor {
+ public:
+  static std::shared_ptr<Task> MakeAndRun(SequenceReader* reader, Frame startFrame,
+                                          Frame loopFrame) {
+    auto task = Task::Make(
+        std::unique_ptr<LookaheadTask>(new LookaheadTask(reader, startFrame, loopFrame)),
+        TaskPriority::NextFrame, NO_DEADLINE, reader->taskGroup);
+    task->run();
+    return task;
+  }
+
+ private:
+  SequenceReader* reader = nullptr;
+  Frame startFrame = 0;
+  Frame loopFrame = -1;
+
+  LookaheadTask(SequenceReader* reader, Frame startFrame, Frame loopFrame)
+      : reader(reader), startFrame(startFrame), loopFrame(loopFrame) {
+  }
+
+  void execute() override {
+    reader->decodeAhead(startFrame, loopFrame);
+  }
+};
+
+class UploadTask : public Executor {
+ public:
+  static std::shared_ptr<Task> MakeAndRun(SequenceReader* reader,
+                                          std::shared_ptr<tgfx::ImageBuffer> buffer,
+                                          void* pixels) {
+    auto task = Task::Make(
+        std::unique_ptr<UploadTask>(new UploadTask(reader, std::move(buffer), pixels)),
+        TaskPriority::NextFrame, NO_DEADLINE, reader->taskGroup);
+    task->run();
+    return task;
+  }
+
+  bool success = false;
+  std::shared_ptr<tgfx::ImageBuffer> buffer = nullptr;
+
+ private:
+  SequenceReader* reader = nullptr;
+  void* pixels = nullptr;
+
+  UploadTask(SequenceReader* reader, std::shared_ptr<tgfx::ImageBuffer> buffer, void* pixels)
+      : buffer(std::move(buffer)), reader(reader), pixels(pixels) {
+  }
+
+  void execute() override {
+    success = reader->writeToUploadBuffer(buffer, pixels);
   }
 };
 
@@ -47,17 +106,21 @@ SequenceReader::~SequenceReader() {
   DEBUG_ASSERT(lastTask == nullptr || !lastTask->isRunning());
 }
 
-void SequenceReader::prepare(Frame targetFrame) {
+void SequenceReader::prepare(Frame targetFrame, TaskPriority priority, int64_t deadline) {
   if (staticContent) {
     targetFrame = 0;
   }
   if (lastTask == nullptr && targetFrame >= 0 && targetFrame < totalFrames) {
     preparedFrame = targetFrame;
-    lastTask = SequenceTask::MakeAndRun(this, targetFrame);
+    lastTask = SequenceTask::MakeAndRun(this, targetFrame, priority, deadline);
   }
 }
 
 void SequenceReader::prepareNext(Frame targetFrame) {
+  if (_lookaheadDepth > 1 && lookaheadSupported) {
+    prepareAhead(targetFrame);
+    return;
+  }
   if (!staticContent) {
     auto nextFrame = targetFrame + 1;
     if (nextFrame >= totalFrames && pendingFirstFrame >= 0) {
@@ -65,8 +128,189 @@ void SequenceReader::prepareNext(Frame targetFrame) {
       nextFrame = pendingFirstFrame;
       pendingFirstFrame = -1;
     }
-    prepare(nextFrame);
+    prepare(nextFrame, TaskPriority::NextFrame, NO_DEADLINE);
+  }
+}
+
+size_t SequenceReader::memoryUsage() const {
+  size_t usage = 0;
+  if (lastTexture != nullptr) {
+    usage += static_cast<size_t>(lastTexture->width()) * lastTexture->height() * 4;
+  }
+  std::lock_guard<std::mutex> autoLock(bufferLocker);
+  usage += (bufferedFrames.size() + freeBuffers.size()) * frameBufferSize();
+  return usage;
+}
+
+void SequenceReader::setLookaheadDepth(int depth) {
+  depth = std::max(depth, 1);
+  if (_lookaheadDepth == depth) {
+    return;
+  }
+  _lookaheadDepth = depth;
+  std::lock_guard<std::mutex> autoLock(bufferLocker);
+  while (bufferedFrames.size() > static_cast<size_t>(depth)) {
+    bufferedFrames.pop_back();
+  }
+  if (freeBuffers.size() > static_cast<size_t>(depth)) {
+    freeBuffers.resize(static_cast<size_t>(depth));
+  }
+}
+
+void SequenceReader::cancelTasks() {
+  // The uploadBuffer stays mapped until the uploadTask finishes.
+  uploadTask = nullptr;
+  uploadBuffer = nullptr;
+  uploadFrame = -1;
+  lookaheadStopped = true;
+  // Setting the lastTask to nullptr triggers cancel(), which waits for the running one to finish.
+  lastTask = nullptr;
+  lookaheadStopped = false;
+}
+
+void SequenceReader::prepareAhead(Frame targetFrame) {
+  if (staticContent || (lastTask != nullptr && lastTask->isRunning())) {
+    return;
+  }
+  Frame startFrame = targetFrame + 1;
+  {
+    std::lock_guard<std::mutex> autoLock(bufferLocker);
+    if (bufferedFrames.size() >= static_cast<size_t>(_lookaheadDepth.load())) {
+      return;
+    }
+    if (!bufferedFrames.empty()) {
+      startFrame = bufferedFrames.back().frame + 1;
+    }
+  }
+  Frame loopFrame = -1;
+  if (startFrame + _lookaheadDepth > totalFrames) {
+    // The decoding ahead reaches the end, continue from the first frame of the next loop.
+    loopFrame = pendingFirstFrame;
+    pendingFirstFrame = -1;
+  }
+  if (startFrame >= totalFrames) {
+    if (loopFrame < 0) {
+      return;
+    }
+    startFrame = loopFrame;
+    loopFrame = -1;
+  }
+  lastTask = LookaheadTask::MakeAndRun(this, startFrame, loopFrame);
+}
+
+void SequenceReader::decodeAhead(Frame startFrame, Frame loopFrame) {
+  auto frame = startFrame;
+  while (!lookaheadStopped) {
+    std::shared_ptr<tgfx::ImageBuffer> reusableBuffer = nullptr;
+    {
+      std::lock_guard<std::mutex> autoLock(bufferLocker);
+      if (bufferedFrames.size() >= static_cast<size_t>(_lookaheadDepth.load())) {
+        break;
+      }
+      if (!freeBuffers.empty()) {
+        reusableBuffer = freeBuffers.back();
+        freeBuffers.pop_back();
+      }
+    }
+    if (frame >= totalFrames) {
+      if (loopFrame < 0) {
+        break;
+      }
+      frame = loopFrame;
+      loopFrame = -1;
+    }
+    tgfx::Clock clock = {};
+    if (!decodeFrame(frame)) {
+      break;
+    }
+    auto buffer = copyFrame(std::move(reusableBuffer));
+    _decodingTime += clock.measure();
+    _decodedFrames++;
+    if (buffer == nullptr) {
+      // The decoded frame stays in the reader, it is the same as prepareNext() without lookahead.
+      lookaheadSupported = false;
+      break;
+    }
+    std::lock_guard<std::mutex> autoLock(bufferLocker);
+    bufferedFrames.push_back({frame, std::move(buffer)});
+    frame++;
+  }
+}
+
+std::shared_ptr<tgfx::ImageBuffer> SequenceReader::takeBufferedFrame(Frame targetFrame) {
+  std::lock_guard<std::mutex> autoLock(bufferLocker);
+  auto position = std::find_if(bufferedFrames.begin(), bufferedFrames.end(),
+                               [=](const BufferedFrame& item) { return item.frame == targetFrame; });
+  if (position == bufferedFrames.end()) {
+    return nullptr;
+  }
+  // The frames before the target one are skipped.
+  for (auto item = bufferedFrames.begin(); item != position; item++) {
+    freeBuffers.push_back(std::move(item->buffer));
+  }
+  auto buffer = std::move(position->buffer);
+  bufferedFrames.erase(bufferedFrames.begin(), position + 1);
+  bufferedFrameHits++;
+  return buffer;
+}
+
+void SequenceReader::recycleBuffer(std::shared_ptr<tgfx::ImageBuffer> buffer) {
+  std::lock_guard<std::mutex> autoLock(bufferLocker);
+  if (freeBuffers.size() < static_cast<size_t>(_lookaheadDepth.load())) {
+    freeBuffers.push_back(std::move(buffer));
+  }
+}
+
+void SequenceReader::clearBufferedFrames() {
+  std::lock_guard<std::mutex> autoLock(bufferLocker);
+  for (auto& item : bufferedFrames) {
+    if (freeBuffers.size() < static_cast<size_t>(_lookaheadDepth.load())) {
+      freeBuffers.push_back(std::move(item.buffer));
+    }
+  }
+  bufferedFrames.clear();
+}
+
+void SequenceReader::stageNextFrame(tgfx::Context* context) {
+  if (uploadTask != nullptr || context == nullptr) {
+    return;
+  }
+  Frame frame = -1;
+  std::shared_ptr<tgfx::ImageBuffer> buffer = nullptr;
+  {
+    std::lock_guard<std::mutex> autoLock(bufferLocker);
+    if (bufferedFrames.empty()) {
+      return;
+    }
+    frame = bufferedFrames.front().frame;
+    buffer = bufferedFrames.front().buffer;
+  }
+  auto size = uploadBufferSize(buffer.get());
+  if (size == 0) {
+    return;
+  }
+  uploadBuffer = tgfx::UploadBuffer::Make(context, size);
+  if (uploadBuffer == nullptr) {
+    return;
   }
+  uploadFrame = frame;
+  uploadTask = UploadTask::MakeAndRun(this, std::move(buffer), uploadBuffer->data());
+}
+
+std::shared_ptr<tgfx::Texture> SequenceReader::takeUploadedTexture(Frame targetFrame) {
+  if (uploadTask == nullptr) {
+    return nullptr;
+  }
+  std::shared_ptr<tgfx::Texture> texture = nullptr;
+  // The buffer being copied must not be recycled before the uploadTask finishes.
+  auto executor = static_cast<UploadTask*>(uploadTask->wait());
+  if (executor->success && uploadFrame == targetFrame) {
+    texture = makeUploadedTexture(executor->buffer.get(), uploadBuffer.get());
+  }
+  uploadTask = nullptr;
+  uploadBuffer = nullptr;
+  uploadFrame = -1;
+  return texture;
 }
 
 std::shared_ptr<tgfx::Texture> SequenceReader::readTexture(Frame targetFrame, RenderCache* cache) {
@@ -76,15 +320,35 @@ std::shared_ptr<tgfx::Texture> SequenceReader::readTexture(Frame targetFrame, Re
   if (lastFrame == targetFrame) {
     return lastTexture;
   }
+  // Release the last texture for immediately reusing.
+  lastTexture = nullptr;
+  lastFrame = -1;
   tgfx::Clock clock = {};
-  // Setting the lastTask to nullptr triggers cancel().
-  lastTask = nullptr;
+  auto texture = takeUploadedTexture(targetFrame);
+  auto buffer = takeBufferedFrame(targetFrame);
+  if (buffer != nullptr) {
+    if (texture == nullptr) {
+      texture = buffer->makeTexture(cache->getContext());
+    }
+    cache->textureUploadingTime += clock.measure();
+    recycleBuffer(std::move(buffer));
+    lastTexture = texture;
+    lastFrame = lastTexture ? targetFrame : -1;
+    preparedFrame = targetFrame;
+    prepareNext(targetFrame);
+    // The pixels of the next frame are copied into the staging memory in background, then only
+    // the GPU copy is left for the next call.
+    stageNextFrame(cache->getContext());
+    return lastTexture;
+  }
+  // The target frame is not decoded ahead, which means a seeking happened.
+  cancelTasks();
+  clearBufferedFrames();
   auto success = decodeFrame(targetFrame);
   auto decodingTime = clock.measure();
+  _decodingTime += decodingTime;
+  _decodedFrames++;
   recordPerformance(cache, decodingTime);
-  // Release the last texture for immediately reusing.
-  lastTexture = nullptr;
-  lastFrame = -1;
   if (success) {
     clock.reset();
     lastTexture = makeTexture(cache->getContext());
@@ -18,9 +18,13 @@
 
 #pragma once
 
+#include <atomic>
+#include <deque>
 #include "base/utils/Task.h"
 #include "rendering/Performance.h"
+#include "tgfx/core/ImageBuffer.h"
 #include "tgfx/gpu/Texture.h"
+#include "tgfx/gpu/UploadBuffer.h"
 
 namespace pag {
 class RenderCache;
@@ -34,15 +38,58 @@ class SequenceReader {
   virtual ~SequenceReader();
 
   /**
-   * Decodes the specified target frame asynchronously.
+   * Decodes the specified target frame asynchronously with the given task priority and deadline.
    */
-  virtual void prepare(Frame targetFrame);
+  virtual void prepare(Frame targetFrame, TaskPriority priority, int64_t deadline);
 
   /**
    * Returns the texture of specified target frame.
    */
   std::shared_ptr<tgfx::Texture> readTexture(Frame targetFrame, RenderCache* cache);
 
+  /**
+   * Returns the memory usage of the decoded frames held by this reader.
+   */
+  virtual size_t memoryUsage() const;
+
+  /**
+   * Returns the memory reserved for the frames kept resident across loops. Returns 0 if the reader
+   * does not keep them.
+   */
+  virtual size_t loopCacheMemory() const {
+    return 0;
+  }
+
+  /**
+   * Returns the number of frames decoded ahead of the current one. The default value is 1.
+   */
+  int lookaheadDepth() const {
+    return _lookaheadDepth;
+  }
+
+  /**
+   * Sets the number of frames decoded ahead of the current one. If it is greater than 1, the
+   * decoded frames are copied into a ring of buffers in background, so that a slow frame does not
+   * stall readTexture(). Only takes effect if the subclass supports copyFrame().
+   */
+  void setLookaheadDepth(int depth);
+
+  /**
+   * Returns the total time in microseconds spent on decoding frames by this reader, including the
+   * frames decoded in background.
+   */
+  int64_t decodingTime() const {
+    return _decodingTime;
+  }
+
+  /**
+   * Returns the number of frames decoded by this reader, including the frames decoded in
+   * background.
+   */
+  int64_t decodedFrames() const {
+    return _decodedFrames;
+  }
+
  protected:
   /**
    * Decodes the closest frame to the specified targetTime.
@@ -64,19 +111,108 @@ class SequenceReader {
    */
   virtual void prepareNext(Frame targetFrame);
 
+  /**
+   * Copies the current decoded frame into a buffer which stays valid after decoding other frames.
+   * The reusableBuffer is a buffer returned by this method before and no longer used, it can be
+   * reused if it is not nullptr. Returns nullptr if the frame can not be copied, such as a frame
+   * decoded by a hardware decoder.
+   */
+  virtual std::shared_ptr<tgfx::ImageBuffer> copyFrame(std::shared_ptr<tgfx::ImageBuffer>) {
+    return nullptr;
+  }
+
+  /**
+   * Returns the byte size of a buffer returned by copyFrame().
+   */
+  virtual size_t frameBufferSize() const {
+    return 0;
+  }
+
+  /**
+   * Returns the byte size of the UploadBuffer to stage a buffer returned by copyFrame(). Returns 0
+   * if the buffer can not be staged, then it is uploaded by calling its makeTexture() directly.
+   */
+  virtual size_t uploadBufferSize(const tgfx::ImageBuffer*) const {
+    return 0;
+  }
+
+  /**
+   * Copies a buffer returned by copyFrame() into the mapped memory of an UploadBuffer. It is called
+   * from a worker thread.
+   */
+  virtual bool writeToUploadBuffer(std::shared_ptr<tgfx::ImageBuffer>, void*) const {
+    return false;
+  }
+
+  /**
+   * Creates a texture from an UploadBuffer filled by writeToUploadBuffer().
+   */
+  virtual std::shared_ptr<tgfx::Texture> makeUploadedTexture(const tgfx::ImageBuffer*,
+                                                             tgfx::UploadBuffer*) const {
+    return nullptr;
+  }
+
+  /**
+   * Stops the decoding ahead and cancels the last task. The subclass must call it in their
+   * destructor.
+   */
+  void cancelTasks();
+
  protected:
   std::shared_ptr<Task> lastTask = nullptr;
+  // The TaskGroup to run the decoding tasks, nullptr means the default one.
+  std::shared_ptr<TaskGroup> taskGroup = nullptr;
 
  private:
+  struct BufferedFrame {
+    Frame frame = 0;
+    std::shared_ptr<tgfx::ImageBuffer> buffer = nullptr;
+  };
+
   Frame totalFrames = 0;
   bool staticContent = false;
   Frame pendingFirstFrame = -1;
   Frame lastFrame = -1;
   Frame preparedFrame = -1;
   std::shared_ptr<tgfx::Texture> lastTexture = nullptr;
+  std::atomic<int> _lookaheadDepth = {1};
+  std::atomic<int64_t> _decodingTime = {0};
+  std::atomic<int64_t> _decodedFrames = {0};
+  // The decodingTime() and decodedFrames() already reported to the RenderCache.
+  int64_t reportedDecodingTime = 0;
+  int64_t reportedDecodedFrames = 0;
+  // Set by the RenderCache if this is a VideoReader of a sequence short enough for the loop cache.
+  bool loopCacheAllowed = false;
+  // The frameCount of the RenderCache when this reader was last used.
+  int64_t lastUsedFrame = 0;
+  // Becomes false once copyFrame() fails, then only one frame is decoded ahead.
+  std::atomic<bool> lookaheadSupported = {true};
+  std::atomic<bool> lookaheadStopped = {false};
+  mutable std::mutex bufferLocker = {};
+  // The ring of frames decoded ahead, in playing order.
+  std::deque<BufferedFrame> bufferedFrames = {};
+  // The number of frames read from the bufferedFrames.
+  size_t bufferedFrameHits = 0;
+  std::vector<std::shared_ptr<tgfx::ImageBuffer>> freeBuffers = {};
+  // The next buffered frame being copied into the uploadBuffer by the uploadTask.
+  Frame uploadFrame = -1;
+  std::shared_ptr<tgfx::UploadBuffer> uploadBuffer = nullptr;
+  std::shared_ptr<Task> uploadTask = nullptr;
+
+  void prepareAhead(Frame targetFrame);
+  void decodeAhead(Frame startFrame, Frame loopFrame);
+  std::shared_ptr<tgfx::ImageBuffer> takeBufferedFrame(Frame targetFrame);
+  void recycleBuffer(std::shared_ptr<tgfx::ImageBuffer> buffer);
+  void clearBufferedFrames();
+  void stageNextFrame(tgfx::Context* context);
+  std::shared_ptr<tgfx::Texture> takeUploadedTexture(Frame targetFrame);
 
   friend class SequenceTask;
 
+  friend class LookaheadTask;
+
+  friend class UploadTask;
+
   friend class RenderCache;
 };
 }  // namespace pag
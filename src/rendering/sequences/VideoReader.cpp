@@ -17,7 +17,10 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "VideoReader.h"
+#include <algorithm>
+#include <unordered_set>
 #include "base/utils/TimeUtil.h"
+#include "rendering/video/VideoDecoderPool.h"
 #include "tgfx/core/Clock.h"
 
 namespace pag {
@@ -26,11 +29,14 @@ namespace pag {
 #define DECODER_TYPE_FAIL 3
 #define MAX_TRY_DECODE_COUNT 100
 #define FORCE_SOFTWARE_SIZE 160000  // 400x400
+#define MAX_RECENT_FRAMES 4
 
 class GPUDecoderTask : public Executor {
  public:
   static std::shared_ptr<Task> MakeAndRun(const VideoFormat& format) {
-    auto task = Task::Make(std::unique_ptr<GPUDecoderTask>(new GPUDecoderTask(format)));
+    // A software decoder is used until the GPU decoder is ready, so it is not frame-critical.
+    auto task = Task::Make(std::unique_ptr<GPUDecoderTask>(new GPUDecoderTask(format)),
+                           TaskPriority::Prefetch);
     task->run();
     return task;
   }
@@ -61,6 +67,8 @@ VideoReader::VideoReader(std::unique_ptr<VideoDemuxer> videoDemuxer)
       demuxer(videoDemuxer.release()) {
   auto videoFormat = demuxer->getFormat();
   frameRate = videoFormat.frameRate;
+  // The copied frames are in I420 format.
+  frameSize = static_cast<size_t>(videoFormat.width) * videoFormat.height * 3 / 2;
   decoderTypeIndex = DECODER_TYPE_HARDWARE;
   auto forceSoftware =
       (demuxer->staticContent() || videoFormat.width * videoFormat.height <= FORCE_SOFTWARE_SIZE);
@@ -72,7 +80,7 @@ VideoReader::VideoReader(std::unique_ptr<VideoDemuxer> videoDemuxer)
 }
 
 VideoReader::~VideoReader() {
-  lastTask = nullptr;
+  cancelTasks();
   destroyVideoDecoder();
   delete demuxer;
 }
@@ -82,7 +90,8 @@ bool VideoReader::decodeFrame(Frame targetFrame) {
   std::lock_guard<std::mutex> autoLock(locker);
   auto targetTime = FrameToTime(targetFrame, frameRate);
   auto sampleTime = demuxer->getSampleTimeAt(targetTime);
-  if (sampleTime == currentRenderedTime) {
+  if (sampleTime == currentRenderedTime || findLoopFrame(sampleTime) ||
+      findRecentFrame(sampleTime)) {
     return true;
   }
   lastBuffer = nullptr;
@@ -97,7 +106,7 @@ bool VideoReader::decodeFrame(Frame targetFrame) {
     success = onDecodeFrame(sampleTime);
     if (!success) {
       // fallback to software decoder.
-      destroyVideoDecoder();
+      destroyVideoDecoder(false);
       decoderTypeIndex++;
       if (checkVideoDecoder()) {
         success = onDecodeFrame(sampleTime);
@@ -112,11 +121,136 @@ bool VideoReader::decodeFrame(Frame targetFrame) {
     lastBuffer = videoDecoder->onRenderFrame();
     if (lastBuffer) {
       currentRenderedTime = currentDecodedTime;
+      keepRecentFrame();
     }
   }
   return lastBuffer != nullptr;
 }
 
+size_t VideoReader::memoryUsage() const {
+  auto usage = SequenceReader::memoryUsage();
+  std::lock_guard<std::mutex> autoLock(locker);
+  return usage + (recentFrames.size() + loopFrames.size()) * frameSize;
+}
+
+size_t VideoReader::loopCacheMemory() const {
+  std::lock_guard<std::mutex> autoLock(locker);
+  return loopCacheEnabled ? sampleCount * frameSize : 0;
+}
+
+size_t VideoReader::loopCacheSize() {
+  std::lock_guard<std::mutex> autoLock(locker);
+  return countSamples() * frameSize;
+}
+
+void VideoReader::setLoopCacheEnabled(bool value) {
+  std::lock_guard<std::mutex> autoLock(locker);
+  if (!recentFramesSupported) {
+    value = false;
+  }
+  if (loopCacheEnabled == value) {
+    return;
+  }
+  loopCacheEnabled = value;
+  if (loopCacheEnabled) {
+    countSamples();
+    recentFrames.clear();
+  } else {
+    loopFrames.clear();
+  }
+}
+
+size_t VideoReader::countSamples() {
+  if (sampleCount == 0) {
+    std::unordered_set<int64_t> sampleTimes = {};
+    auto totalFrames = TotalFrames(demuxer);
+    for (Frame frame = 0; frame < totalFrames; frame++) {
+      sampleTimes.insert(demuxer->getSampleTimeAt(FrameToTime(frame, frameRate)));
+    }
+    sampleCount = sampleTimes.size();
+  }
+  return sampleCount;
+}
+
+bool VideoReader::findLoopFrame(int64_t sampleTime) {
+  auto result = loopFrames.find(sampleTime);
+  if (result == loopFrames.end()) {
+    return false;
+  }
+  if (videoDecoder != nullptr && loopFrames.size() >= sampleCount) {
+    // All frames are resident, the decoder is no longer needed.
+    destroyVideoDecoder();
+  }
+  lastBuffer = result->second;
+  currentRenderedTime = sampleTime;
+  return true;
+}
+
+void VideoReader::keepLoopFrame() {
+  if (loopFrames.count(currentRenderedTime) > 0) {
+    return;
+  }
+  auto buffer = lastBuffer->makeCopy(nullptr);
+  if (buffer == nullptr) {
+    recentFramesSupported = false;
+    loopCacheEnabled = false;
+    loopFrames.clear();
+    return;
+  }
+  loopFrames[currentRenderedTime] = std::move(buffer);
+}
+
+bool VideoReader::findRecentFrame(int64_t sampleTime) {
+  for (auto item = recentFrames.begin(); item != recentFrames.end(); item++) {
+    if (item->time == sampleTime) {
+      recentFrames.splice(recentFrames.begin(), recentFrames, item);
+      lastBuffer = item->buffer;
+      currentRenderedTime = sampleTime;
+      recentFrameHits++;
+      return true;
+    }
+  }
+  return false;
+}
+
+void VideoReader::keepRecentFrame() {
+  if (!recentFramesSupported) {
+    return;
+  }
+  if (loopCacheEnabled) {
+    keepLoopFrame();
+    return;
+  }
+  if (!recentFramesActive) {
+    auto position = std::find(recentTimes.begin(), recentTimes.end(), currentRenderedTime);
+    if (position == recentTimes.end()) {
+      recentTimes.push_front(currentRenderedTime);
+      if (recentTimes.size() > MAX_RECENT_FRAMES) {
+        recentTimes.pop_back();
+      }
+      return;
+    }
+    // A recently rendered frame is decoded again, such as by a backward step or a ping-pong loop.
+    recentFramesActive = true;
+    recentTimes.clear();
+  }
+  std::shared_ptr<VideoBuffer> reusableBuffer = nullptr;
+  if (recentFrames.size() >= MAX_RECENT_FRAMES) {
+    // Reuse the buffer of the least recently used frame if it is not referenced anywhere else.
+    if (recentFrames.back().buffer.use_count() == 1) {
+      reusableBuffer = std::move(recentFrames.back().buffer);
+    }
+    recentFrames.pop_back();
+  }
+  auto buffer = lastBuffer->makeCopy(std::move(reusableBuffer));
+  if (buffer == nullptr) {
+    recentFramesSupported = false;
+    recentFrames.clear();
+    return;
+  }
+  recentFrames.push_front({currentRenderedTime, std::move(buffer)});
+}
+
 std::shared_ptr<tgfx::Texture> VideoReader::makeTexture(tgfx::Context* context) {
   if (lastBuffer == nullptr) {
     return nullptr;
@@ -138,6 +272,35 @@ void VideoReader::recordPerformance(Performance* performance, int64_t decodingTi
   }
 }
 
+std::shared_ptr<tgfx::ImageBuffer> VideoReader::copyFrame(
+    std::shared_ptr<tgfx::ImageBuffer> reusableBuffer) {
+  std::lock_guard<std::mutex> autoLock(locker);
+  if (lastBuffer == nullptr) {
+    return nullptr;
+  }
+  // The reusable buffers are always the VideoBuffers copied below.
+  return lastBuffer->makeCopy(std::static_pointer_cast<VideoBuffer>(reusableBuffer));
+}
+
+size_t VideoReader::frameBufferSize() const {
+  return frameSize;
+}
+
+// The buffers passed to the upload methods are always the VideoBuffers made by copyFrame().
+size_t VideoReader::uploadBufferSize(const tgfx::ImageBuffer* buffer) const {
+  return static_cast<const VideoBuffer*>(buffer)->uploadBufferSize();
+}
+
+bool VideoReader::writeToUploadBuffer(std::shared_ptr<tgfx::ImageBuffer> buffer,
+                                      void* pixels) const {
+  return std::static_pointer_cast<VideoBuffer>(buffer)->writeToUploadBuffer(pixels);
+}
+
+std::shared_ptr<tgfx::Texture> VideoReader::makeUploadedTexture(
+    const tgfx::ImageBuffer* buffer, tgfx::UploadBuffer* uploadBuffer) const {
+  return static_cast<const VideoBuffer*>(buffer)->makeUploadedTexture(uploadBuffer);
+}
+
 bool VideoReader::sendSampleData() {
   if (inputEndOfStream) {
     return true;
@@ -216,11 +379,16 @@ bool VideoReader::checkVideoDecoder() {
   return false;
 }
 
-void VideoReader::destroyVideoDecoder() {
+void VideoReader::destroyVideoDecoder(bool reusable) {
   if (videoDecoder == nullptr) {
     return;
   }
-  delete videoDecoder;
+  if (reusable) {
+    VideoDecoderPool::GetInstance()->checkIn(demuxer->getFormat(),
+                                             std::unique_ptr<VideoDecoder>(videoDecoder));
+  } else {
+    delete videoDecoder;
+  }
   videoDecoder = nullptr;
   lastBuffer = nullptr;
   currentRenderedTime = INT64_MIN;
@@ -236,19 +404,31 @@ void VideoReader::resetParams() {
 }
 
 bool VideoReader::switchToGPUDecoderOfTask() {
-  destroyVideoDecoder();
   auto executor = gpuDecoderTask->wait();
-  videoDecoder = static_cast<GPUDecoderTask*>(executor)->getDecoder().release();
+  auto gpuDecoder = static_cast<GPUDecoderTask*>(executor)->getDecoder();
   gpuDecoderTask = nullptr;
-  if (videoDecoder) {
-    decoderTypeIndex = DECODER_TYPE_HARDWARE;
-    return true;
+  if (gpuDecoder == nullptr) {
+    // Keeps the current decoder.
+    return false;
   }
-  return false;
+  destroyVideoDecoder();
+  videoDecoder = gpuDecoder.release();
+  decoderTypeIndex = DECODER_TYPE_HARDWARE;
+  return true;
 }
 
 VideoDecoder* VideoReader::makeVideoDecoder() {
   VideoDecoder* decoder = nullptr;
+  if (decoderTypeIndex <= DECODER_TYPE_HARDWARE && gpuDecoderTask == nullptr) {
+    // An idle software decoder starts decoding right away, while the hardware decoder is made in
+    // the background and replaces it once ready.
+    decoder = VideoDecoderPool::GetInstance()->checkOut(demuxer->getFormat()).release();
+    if (decoder) {
+      gpuDecoderTask = GPUDecoderTask::MakeAndRun(demuxer->getFormat());
+      decoderTypeIndex = DECODER_TYPE_SOFTWARE;
+      return decoder;
+    }
+  }
   if (decoderTypeIndex <= DECODER_TYPE_HARDWARE) {
     tgfx::Clock clock = {};
     // try hardware decoder.
@@ -261,8 +441,11 @@ VideoDecoder* VideoReader::makeVideoDecoder() {
   }
   if (decoderTypeIndex <= DECODER_TYPE_SOFTWARE) {
     tgfx::Clock clock = {};
-    // try software decoder.
-    decoder = VideoDecoder::Make(demuxer->getFormat(), false).release();
+    // try an idle software decoder first.
+    decoder = VideoDecoderPool::GetInstance()->checkOut(demuxer->getFormat()).release();
+    if (decoder == nullptr) {
+      decoder = VideoDecoder::Make(demuxer->getFormat(), false).release();
+    }
     softDecodingInitialTime = clock.measure();
     if (decoder) {
       decoderTypeIndex = DECODER_TYPE_SOFTWARE;
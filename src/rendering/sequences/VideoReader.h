@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <list>
+#include <unordered_map>
 #include "SequenceReader.h"
 #include "rendering/video/VideoDecoder.h"
 #include "rendering/video/VideoDemuxer.h"
@@ -29,6 +31,23 @@ class VideoReader : public SequenceReader {
 
   ~VideoReader() override;
 
+  size_t memoryUsage() const override;
+
+  size_t loopCacheMemory() const override;
+
+  /**
+   * Returns the memory needed to keep all frames of the video resident.
+   */
+  size_t loopCacheSize();
+
+  /**
+   * If set to true, every decoded frame is copied into a compact I420 buffer and kept resident, so
+   * the later loops of the video cost no decoding, and the decoder is released once all frames are
+   * kept. It is turned off automatically if the decoded frames can not be copied, such as the ones
+   * decoded by hardware decoders. The default value is false.
+   */
+  void setLoopCacheEnabled(bool value);
+
  protected:
   bool decodeFrame(Frame targetFrame) override;
 
@@ -36,10 +55,29 @@ class VideoReader : public SequenceReader {
 
   void recordPerformance(Performance* performance, int64_t decodingTime) override;
 
+  std::shared_ptr<tgfx::ImageBuffer> copyFrame(
+      std::shared_ptr<tgfx::ImageBuffer> reusableBuffer) override;
+
+  size_t frameBufferSize() const override;
+
+  size_t uploadBufferSize(const tgfx::ImageBuffer* buffer) const override;
+
+  bool writeToUploadBuffer(std::shared_ptr<tgfx::ImageBuffer> buffer,
+                           void* pixels) const override;
+
+  std::shared_ptr<tgfx::Texture> makeUploadedTexture(
+      const tgfx::ImageBuffer* buffer, tgfx::UploadBuffer* uploadBuffer) const override;
+
  private:
-  std::mutex locker = {};
+  struct RecentFrame {
+    int64_t time = 0;
+    std::shared_ptr<VideoBuffer> buffer = nullptr;
+  };
+
+  mutable std::mutex locker = {};
   VideoDemuxer* demuxer = nullptr;
   float frameRate = 0.0;
+  size_t frameSize = 0;
   int decoderTypeIndex = 0;
   std::shared_ptr<Task> gpuDecoderTask = nullptr;
   VideoDecoder* videoDecoder = nullptr;
@@ -51,8 +89,26 @@ class VideoReader : public SequenceReader {
   int64_t currentRenderedTime = INT64_MIN;
   int64_t hardDecodingInitialTime = 0;
   int64_t softDecodingInitialTime = 0;
+  // The copies of the recently decoded frames, most recently used first. They serve the short
+  // backward steps and ping-pong loops without seeking the decoder.
+  std::list<RecentFrame> recentFrames = {};
+  // The sample times of the recently rendered frames before any frame is copied. The copying
+  // starts once one of them is requested again, so the forward playback never pays for it.
+  std::list<int64_t> recentTimes = {};
+  bool recentFramesActive = false;
+  size_t recentFrameHits = 0;
+  // Becomes false once the decoded frames fail to be copied, such as the hardware decoded ones.
+  bool recentFramesSupported = true;
+  bool loopCacheEnabled = false;
+  // The number of distinct samples played by the frames, 0 if not counted yet.
+  size_t sampleCount = 0;
+  // The copies of all decoded frames kept across loops, keyed by their sample time.
+  std::unordered_map<int64_t, std::shared_ptr<VideoBuffer>> loopFrames = {};
 
-  void destroyVideoDecoder();
+  /**
+   * Destroys the current decoder, or returns it to the VideoDecoderPool if it is reusable.
+   */
+  void destroyVideoDecoder(bool reusable = true);
 
   bool checkVideoDecoder();
 
@@ -62,6 +118,16 @@ class VideoReader : public SequenceReader {
 
   bool onDecodeFrame(int64_t sampleTime);
 
+  bool findRecentFrame(int64_t sampleTime);
+
+  void keepRecentFrame();
+
+  bool findLoopFrame(int64_t sampleTime);
+
+  void keepLoopFrame();
+
+  size_t countSamples();
+
   bool switchToGPUDecoderOfTask();
 
   VideoDecoder* makeVideoDecoder();
@@ -17,6 +17,7 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "VideoSequenceDemuxer.h"
+#include <algorithm>
 #include "base/utils/TimeUtil.h"
 
 namespace pag {
@@ -70,30 +71,22 @@ bool VideoSequenceDemuxer::needSeeking(int64_t currentTime, int64_t targetTime)
   if (target <= maxPTSFrame) {
     return false;
   }
-  const auto& frames = sequence->frames;
-  for (Frame frame = target; frame > current + 1; frame--) {
-    // DTS == PTS when the frame is key frame.
-    if (frames[frame]->isKeyframe) {
-      return true;
-    }
-  }
-  return false;
+  // Seeking is faster if there is a keyframe between the current frame and the target frame.
+  return findKeyframe(target) > current + 1;
 }
 
 void VideoSequenceDemuxer::seekTo(int64_t targetTime) {
   auto targetFrame = TimeToFrame(targetTime, sequence->frameRate);
-  int start = 0;
-  int end = static_cast<int>(keyframes.size()) - 1;
-  while (start < end - 1) {
-    int middle = (start + end) / 2;
-    if (keyframes[middle] <= targetFrame) {
-      start = middle;
-    } else {
-      end = middle;
-    }
-  }
   // DTS == PTS when the frame is key frame.
-  maxPTSFrame = sampleIndex = keyframes[start];
+  maxPTSFrame = sampleIndex = std::max(findKeyframe(targetFrame), static_cast<Frame>(0));
+}
+
+Frame VideoSequenceDemuxer::findKeyframe(Frame targetFrame) const {
+  auto position = std::upper_bound(keyframes.begin(), keyframes.end(), targetFrame);
+  if (position == keyframes.begin()) {
+    return -1;
+  }
+  return *(position - 1);
 }
 
 void VideoSequenceDemuxer::reset() {
@@ -46,6 +46,7 @@ class VideoSequenceDemuxer : public VideoDemuxer {
   std::shared_ptr<File> file = nullptr;
   VideoSequence* sequence = nullptr;
   VideoFormat format = {};
+  // The presentation frames of the keyframes in ascending order.
   std::vector<Frame> keyframes = {};
   Frame maxPTSFrame = -1;
   Frame sampleIndex = 0;
@@ -53,5 +54,10 @@ class VideoSequenceDemuxer : public VideoDemuxer {
   bool staticContent() const override {
     return sequence->composition->staticContent();
   }
+
+  /**
+   * Returns the last keyframe at or before the target frame, or -1 if there is none.
+   */
+  Frame findKeyframe(Frame targetFrame) const;
 };
 }  // namespace pag
@@ -20,9 +20,14 @@
 
 #include <memory>
 #include <mutex>
+#include "rendering/caches/FrameCache.h"
 
 namespace pag {
-
+/**
+ * LockGuard locks the root locker of a PAGPlayer or a layer tree during an API call. It also opens
+ * a FrameCacheScope, so the frames returned by the FrameCaches of layers stay valid until the call
+ * returns.
+ */
 class LockGuard {
  public:
   explicit LockGuard(std::shared_ptr<std::mutex> locker) : mutex(std::move(locker)) {
@@ -38,6 +43,7 @@ class LockGuard {
   }
 
  private:
+  FrameCacheScope frameCacheScope = {};
   std::shared_ptr<std::mutex> mutex;
 };
 
@@ -118,8 +118,10 @@ void MemoryCalculator::FillVideoGraphicsMemories(
     Composition* composition,
     std::unordered_map<void*, std::vector<TimeRange>*>& resourcesTimeRangesMap,
     std::vector<int64_t>& memoriesPreFrame, int64_t& graphicsMemory) {
-  // Just use the last one for best rendering quality, ignore all others.
-  auto sequence = static_cast<VideoComposition*>(composition)->sequences.back();
+  auto sequence = static_cast<VideoSequence*>(Sequence::Get(composition));
+  if (sequence == nullptr) {
+    return;
+  }
   auto factor = sequence->alphaStartX > 0 || sequence->alphaStartY > 0 ? 3 : 2;
   graphicsMemory += sequence->width * sequence->height * 4 * factor;
   FillGraphicsMemories(composition, resourcesTimeRangesMap, memoriesPreFrame, graphicsMemory);
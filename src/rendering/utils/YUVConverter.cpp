@@ -0,0 +1,220 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "YUVConverter.h"
+#include <algorithm>
+#include <array>
+#include "tgfx/core/Buffer.h"
+#include "tgfx/gpu/Canvas.h"
+
+namespace pag {
+/**
+ * The coefficients of one YUV component: the weights of R, G, B and the offset, all of them in
+ * the normalized [0, 1] range.
+ */
+using YUVRow = std::array<float, 4>;
+
+struct YUVMatrix {
+  YUVRow y = {};
+  YUVRow u = {};
+  YUVRow v = {};
+};
+
+static YUVMatrix MakeYUVMatrix(YUVColorSpace colorSpace, YUVColorRange colorRange) {
+  auto kr = colorSpace == YUVColorSpace::Rec709 ? 0.2126f : 0.299f;
+  auto kb = colorSpace == YUVColorSpace::Rec709 ? 0.0722f : 0.114f;
+  auto kg = 1.0f - kr - kb;
+  auto limited = colorRange == YUVColorRange::MPEG;
+  auto yScale = limited ? 219.0f / 255.0f : 1.0f;
+  auto yOffset = limited ? 16.0f / 255.0f : 0.0f;
+  auto chromaScale = limited ? 224.0f / 255.0f : 1.0f;
+  auto chromaOffset = 128.0f / 255.0f;
+  auto uScale = chromaScale / (2.0f * (1.0f - kb));
+  auto vScale = chromaScale / (2.0f * (1.0f - kr));
+  YUVMatrix matrix = {};
+  matrix.y = {kr * yScale, kg * yScale, kb * yScale, yOffset};
+  matrix.u = {-kr * uScale, -kg * uScale, (1.0f - kb) * uScale, chromaOffset};
+  matrix.v = {(1.0f - kr) * vScale, -kg * vScale, -kb * vScale, chromaOffset};
+  return matrix;
+}
+
+static void InterleavePlanes(const uint8_t* uPlane, const uint8_t* vPlane, size_t srcRowBytes,
+                             int width, int height, uint8_t* dstPlane, size_t dstRowBytes) {
+  for (int y = 0; y < height; y++) {
+    auto u = uPlane + static_cast<size_t>(y) * srcRowBytes;
+    auto v = vPlane + static_cast<size_t>(y) * srcRowBytes;
+    auto dst = dstPlane + static_cast<size_t>(y) * dstRowBytes;
+    for (int x = 0; x < width; x++) {
+      dst[2 * x] = u[x];
+      dst[2 * x + 1] = v[x];
+    }
+  }
+}
+
+static bool DrawPlane(tgfx::Context* context, std::shared_ptr<tgfx::Texture> texture, int width,
+                      int height, float scale, const YUVRow& row, uint8_t* dstPixels,
+                      size_t dstRowBytes) {
+  auto surface = tgfx::Surface::Make(context, width, height, true);
+  if (surface == nullptr) {
+    return false;
+  }
+  // Writes the component into the alpha channel, which is the only channel of the surface.
+  std::array<float, 20> colorMatrix = {};
+  colorMatrix[15] = row[0];
+  colorMatrix[16] = row[1];
+  colorMatrix[17] = row[2];
+  colorMatrix[19] = row[3];
+  tgfx::Paint paint = {};
+  paint.setColorFilter(tgfx::ColorFilter::Matrix(colorMatrix));
+  auto canvas = surface->getCanvas();
+  canvas->setMatrix(tgfx::Matrix::MakeScale(scale));
+  canvas->drawTexture(std::move(texture), &paint);
+  auto info = tgfx::ImageInfo::Make(width, height, tgfx::ColorType::ALPHA_8,
+                                    tgfx::AlphaType::Premultiplied, dstRowBytes);
+  return surface->readPixels(info, dstPixels);
+}
+
+static bool ConvertOnGPU(tgfx::Surface* surface, YUVFormat format, const YUVMatrix& matrix,
+                         uint8_t* const dstPlanes[], const size_t dstRowBytes[]) {
+  auto texture = surface->getTexture();
+  if (texture == nullptr) {
+    return false;
+  }
+  auto context = surface->getContext();
+  auto width = surface->width();
+  auto height = surface->height();
+  auto chromaWidth = (width + 1) / 2;
+  auto chromaHeight = (height + 1) / 2;
+  if (!DrawPlane(context, texture, width, height, 1.0f, matrix.y, dstPlanes[0], dstRowBytes[0])) {
+    return false;
+  }
+  if (format == YUVFormat::I420) {
+    return DrawPlane(context, texture, chromaWidth, chromaHeight, 0.5f, matrix.u, dstPlanes[1],
+                     dstRowBytes[1]) &&
+           DrawPlane(context, texture, chromaWidth, chromaHeight, 0.5f, matrix.v, dstPlanes[2],
+                     dstRowBytes[2]);
+  }
+  auto rowBytes = static_cast<size_t>(chromaWidth);
+  tgfx::Buffer buffer(rowBytes * static_cast<size_t>(chromaHeight) * 2);
+  auto uPlane = buffer.bytes();
+  auto vPlane = uPlane + rowBytes * static_cast<size_t>(chromaHeight);
+  if (!DrawPlane(context, texture, chromaWidth, chromaHeight, 0.5f, matrix.u, uPlane, rowBytes) ||
+      !DrawPlane(context, texture, chromaWidth, chromaHeight, 0.5f, matrix.v, vPlane, rowBytes)) {
+    return false;
+  }
+  InterleavePlanes(uPlane, vPlane, rowBytes, chromaWidth, chromaHeight, dstPlanes[1],
+                   dstRowBytes[1]);
+  return true;
+}
+
+static uint8_t ApplyRow(const YUVRow& row, float r, float g, float b) {
+  auto value = (row[0] * r + row[1] * g + row[2] * b + row[3]) * 255.0f + 0.5f;
+  return static_cast<uint8_t>(std::max(0.0f, std::min(value, 255.0f)));
+}
+
+static bool ConvertOnCPU(tgfx::Surface* surface, YUVFormat format, const YUVMatrix& matrix,
+                         uint8_t* const dstPlanes[], const size_t dstRowBytes[]) {
+  auto width = surface->width();
+  auto height = surface->height();
+  auto info = tgfx::ImageInfo::Make(width, height, tgfx::ColorType::RGBA_8888,
+                                    tgfx::AlphaType::Unpremultiplied);
+  tgfx::Buffer buffer(info.byteSize());
+  if (!surface->readPixels(info, buffer.data())) {
+    return false;
+  }
+  auto pixels = buffer.bytes();
+  auto rowBytes = info.rowBytes();
+  for (int y = 0; y < height; y++) {
+    auto src = pixels + static_cast<size_t>(y) * rowBytes;
+    auto dst = dstPlanes[0] + static_cast<size_t>(y) * dstRowBytes[0];
+    for (int x = 0; x < width; x++) {
+      dst[x] = ApplyRow(matrix.y, src[4 * x] / 255.0f, src[4 * x + 1] / 255.0f,
+                        src[4 * x + 2] / 255.0f);
+    }
+  }
+  auto chromaWidth = (width + 1) / 2;
+  auto chromaHeight = (height + 1) / 2;
+  for (int y = 0; y < chromaHeight; y++) {
+    for (int x = 0; x < chromaWidth; x++) {
+      // Averages the 2x2 block, which is equivalent to averaging the chroma since it is linear.
+      float rgb[3] = {0, 0, 0};
+      int count = 0;
+      for (int dy = 0; dy < 2 && 2 * y + dy < height; dy++) {
+        for (int dx = 0; dx < 2 && 2 * x + dx < width; dx++) {
+          auto src = pixels + static_cast<size_t>(2 * y + dy) * rowBytes + 4 * (2 * x + dx);
+          rgb[0] += src[0];
+          rgb[1] += src[1];
+          rgb[2] += src[2];
+          count++;
+        }
+      }
+      auto r = rgb[0] / (255.0f * static_cast<float>(count));
+      auto g = rgb[1] / (255.0f * static_cast<float>(count));
+      auto b = rgb[2] / (255.0f * static_cast<float>(count));
+      auto u = ApplyRow(matrix.u, r, g, b);
+      auto v = ApplyRow(matrix.v, r, g, b);
+      if (format == YUVFormat::I420) {
+        dstPlanes[1][static_cast<size_t>(y) * dstRowBytes[1] + x] = u;
+        dstPlanes[2][static_cast<size_t>(y) * dstRowBytes[2] + x] = v;
+      } else {
+        auto dst = dstPlanes[1] + static_cast<size_t>(y) * dstRowBytes[1] + 2 * x;
+        dst[0] = u;
+        dst[1] = v;
+      }
+    }
+  }
+  return true;
+}
+
+static bool CheckPlanes(tgfx::Surface* surface, YUVFormat format, uint8_t* const dstPlanes[],
+                        const size_t dstRowBytes[]) {
+  if (surface == nullptr || dstPlanes == nullptr || dstRowBytes == nullptr) {
+    return false;
+  }
+  auto planeCount = format == YUVFormat::I420 ? 3 : 2;
+  for (int i = 0; i < planeCount; i++) {
+    if (dstPlanes[i] == nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool YUVConverter::ReadPixels(tgfx::Surface* surface, YUVFormat format, YUVColorSpace colorSpace,
+                              YUVColorRange colorRange, uint8_t* const dstPlanes[],
+                              const size_t dstRowBytes[]) {
+  if (!CheckPlanes(surface, format, dstPlanes, dstRowBytes)) {
+    return false;
+  }
+  auto matrix = MakeYUVMatrix(colorSpace, colorRange);
+  if (ConvertOnGPU(surface, format, matrix, dstPlanes, dstRowBytes)) {
+    return true;
+  }
+  return ConvertOnCPU(surface, format, matrix, dstPlanes, dstRowBytes);
+}
+
+bool YUVConverter::ReadPixelsOnCPU(tgfx::Surface* surface, YUVFormat format,
+                                   YUVColorSpace colorSpace, YUVColorRange colorRange,
+                                   uint8_t* const dstPlanes[], const size_t dstRowBytes[]) {
+  if (!CheckPlanes(surface, format, dstPlanes, dstRowBytes)) {
+    return false;
+  }
+  auto matrix = MakeYUVMatrix(colorSpace, colorRange);
+  return ConvertOnCPU(surface, format, matrix, dstPlanes, dstRowBytes);
+}
+}  // namespace pag
@@ -0,0 +1,44 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "pag/types.h"
+#include "tgfx/gpu/Surface.h"
+
+namespace pag {
+class YUVConverter {
+ public:
+  /**
+   * Converts the pixels of the surface to the specified YUV format and copies the planes to
+   * dstPlanes. The conversion runs on the GPU if the surface is backed by a texture and the GPU
+   * supports single-channel render targets, otherwise on the CPU.
+   */
+  static bool ReadPixels(tgfx::Surface* surface, YUVFormat format, YUVColorSpace colorSpace,
+                         YUVColorRange colorRange, uint8_t* const dstPlanes[],
+                         const size_t dstRowBytes[]);
+
+ private:
+  /**
+   * Converts the pixels on the CPU, which is the fallback when the GPU path is not available.
+   */
+  static bool ReadPixelsOnCPU(tgfx::Surface* surface, YUVFormat format, YUVColorSpace colorSpace,
+                              YUVColorRange colorRange, uint8_t* const dstPlanes[],
+                              const size_t dstRowBytes[]);
+};
+}  // namespace pag
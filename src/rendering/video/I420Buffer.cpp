@@ -17,10 +17,62 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "I420Buffer.h"
+#include <cstring>
 
 namespace pag {
 #define I420_PLANE_COUNT 3
 
+/**
+ * Computes the offsets and row bytes of the tightly packed planes, returns the total byte size.
+ */
+static size_t GetPackedLayout(int width, int height, size_t offsets[I420_PLANE_COUNT],
+                              int lineSize[I420_PLANE_COUNT]) {
+  auto uvWidth = (width + 1) / 2;
+  auto uvHeight = (height + 1) / 2;
+  auto ySize = static_cast<size_t>(width) * height;
+  auto uvSize = static_cast<size_t>(uvWidth) * uvHeight;
+  offsets[0] = 0;
+  offsets[1] = ySize;
+  offsets[2] = ySize + uvSize;
+  lineSize[0] = width;
+  lineSize[1] = uvWidth;
+  lineSize[2] = uvWidth;
+  return ySize + uvSize * 2;
+}
+
+class RasterI420Buffer : public I420Buffer {
+ public:
+  static std::shared_ptr<RasterI420Buffer> Make(int width, int height,
+                                                tgfx::YUVColorSpace colorSpace,
+                                                tgfx::YUVColorRange colorRange) {
+    size_t offsets[I420_PLANE_COUNT] = {};
+    int lineSize[I420_PLANE_COUNT] = {};
+    auto byteSize = GetPackedLayout(width, height, offsets, lineSize);
+    auto pixels = new (std::nothrow) uint8_t[byteSize];
+    if (pixels == nullptr) {
+      return nullptr;
+    }
+    uint8_t* data[I420_PLANE_COUNT] = {pixels + offsets[0], pixels + offsets[1],
+                                       pixels + offsets[2]};
+    auto buffer = new RasterI420Buffer(width, height, data, lineSize, colorSpace, colorRange);
+    return std::shared_ptr<RasterI420Buffer>(buffer);
+  }
+
+  ~RasterI420Buffer() override {
+    delete[] pixels;
+  }
+
+ private:
+  uint8_t* pixels = nullptr;
+
+  RasterI420Buffer(int width, int height, uint8_t* data[3], const int lineSize[3],
+                   tgfx::YUVColorSpace colorSpace, tgfx::YUVColorRange colorRange)
+      : I420Buffer(width, height, data, lineSize, colorSpace, colorRange), pixels(data[0]) {
+  }
+
+  friend class I420Buffer;
+};
+
 I420Buffer::I420Buffer(int width, int height, uint8_t** data, const int* lineSize,
                        tgfx::YUVColorSpace colorSpace, tgfx::YUVColorRange colorRange)
     : VideoBuffer(width, height), colorSpace(colorSpace), colorRange(colorRange) {
@@ -41,4 +93,54 @@ std::shared_ptr<tgfx::Texture> I420Buffer::makeTexture(tgfx::Context* context) c
   return tgfx::YUVTexture::MakeI420(context, colorSpace, colorRange, width(), height(),
                                     const_cast<uint8_t**>(pixelsPlane), rowBytesPlane);
 }
+
+std::shared_ptr<VideoBuffer> I420Buffer::makeCopy(
+    std::shared_ptr<VideoBuffer> reusableBuffer) const {
+  // The reusable buffers are always RasterI420Buffers made below.
+  auto buffer = std::static_pointer_cast<RasterI420Buffer>(reusableBuffer);
+  if (buffer == nullptr || buffer->width() != width() || buffer->height() != height() ||
+      buffer->colorSpace != colorSpace || buffer->colorRange != colorRange) {
+    buffer = RasterI420Buffer::Make(width(), height(), colorSpace, colorRange);
+    if (buffer == nullptr) {
+      return nullptr;
+    }
+  }
+  copyPlanes(buffer->pixelsPlane, buffer->rowBytesPlane);
+  return buffer;
+}
+
+size_t I420Buffer::uploadBufferSize() const {
+  size_t offsets[I420_PLANE_COUNT] = {};
+  int lineSize[I420_PLANE_COUNT] = {};
+  return GetPackedLayout(width(), height(), offsets, lineSize);
+}
+
+bool I420Buffer::writeToUploadBuffer(void* pixels) const {
+  size_t offsets[I420_PLANE_COUNT] = {};
+  int lineSize[I420_PLANE_COUNT] = {};
+  GetPackedLayout(width(), height(), offsets, lineSize);
+  auto bytes = static_cast<uint8_t*>(pixels);
+  uint8_t* data[I420_PLANE_COUNT] = {bytes + offsets[0], bytes + offsets[1], bytes + offsets[2]};
+  copyPlanes(data, lineSize);
+  return true;
+}
+
+std::shared_ptr<tgfx::Texture> I420Buffer::makeUploadedTexture(
+    tgfx::UploadBuffer* uploadBuffer) const {
+  size_t offsets[I420_PLANE_COUNT] = {};
+  int lineSize[I420_PLANE_COUNT] = {};
+  GetPackedLayout(width(), height(), offsets, lineSize);
+  return uploadBuffer->makeI420Texture(colorSpace, colorRange, width(), height(), offsets,
+                                       lineSize);
+}
+
+void I420Buffer::copyPlanes(uint8_t* dstPlanes[3], const int dstLineSize[3]) const {
+  for (int i = 0; i < I420_PLANE_COUNT; i++) {
+    auto rowCount = i == 0 ? height() : (height() + 1) / 2;
+    auto rowBytes = static_cast<size_t>(dstLineSize[i]);
+    for (int row = 0; row < rowCount; row++) {
+      memcpy(dstPlanes[i] + rowBytes * row, pixelsPlane[i] + rowBytesPlane[i] * row, rowBytes);
+    }
+  }
+}
 }  // namespace pag
@@ -27,6 +27,16 @@ class I420Buffer : public VideoBuffer {
 
   std::shared_ptr<tgfx::Texture> makeTexture(tgfx::Context* context) const override;
 
+  size_t uploadBufferSize() const override;
+
+  bool writeToUploadBuffer(void* pixels) const override;
+
+  std::shared_ptr<tgfx::Texture> makeUploadedTexture(
+      tgfx::UploadBuffer* uploadBuffer) const override;
+
+  std::shared_ptr<VideoBuffer> makeCopy(
+      std::shared_ptr<VideoBuffer> reusableBuffer) const override;
+
  protected:
   I420Buffer(int width, int height, uint8_t* data[3], const int lineSize[3],
              tgfx::YUVColorSpace colorSpace, tgfx::YUVColorRange colorRange);
@@ -36,5 +46,7 @@ class I420Buffer : public VideoBuffer {
   tgfx::YUVColorRange colorRange = tgfx::YUVColorRange::MPEG;
   uint8_t* pixelsPlane[3] = {};
   int rowBytesPlane[3] = {};
+
+  void copyPlanes(uint8_t* dstPlanes[3], const int dstLineSize[3]) const;
 };
 }  // namespace pag
\ No newline at end of file
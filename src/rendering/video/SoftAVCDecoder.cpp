@@ -17,6 +17,7 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "SoftAVCDecoder.h"
+#include <algorithm>
 #include <cstdlib>
 #include "tgfx/core/Buffer.h"
 
@@ -66,6 +67,13 @@ static void ivd_aligned_free(void*, void* block) {
 
 #endif
 
+// libavc ignores the cores more than this.
+static constexpr int MAX_DECODING_THREADS = 3;
+
+SoftAVCDecoder::SoftAVCDecoder(int threadCount)
+    : threadCount(std::max(1, std::min(threadCount, MAX_DECODING_THREADS))) {
+}
+
 bool SoftAVCDecoder::onConfigure(const std::vector<HeaderData>& headers, std::string mimeType, int,
                                  int) {
   if (mimeType != "video/avc") {
@@ -279,7 +287,7 @@ bool SoftAVCDecoder::setNumCores() {
   ih264d_ctl_set_num_cores_op_t s_set_cores_op;
   s_set_cores_ip.e_cmd = IVD_CMD_VIDEO_CTL;
   s_set_cores_ip.e_sub_cmd = (IVD_CONTROL_API_COMMAND_TYPE_T)IH264D_CMD_CTL_SET_NUM_CORES;
-  s_set_cores_ip.u4_num_cores = 1;
+  s_set_cores_ip.u4_num_cores = static_cast<UWORD32>(threadCount);
   s_set_cores_ip.u4_size = sizeof(ih264d_ctl_set_num_cores_ip_t);
   s_set_cores_op.u4_size = sizeof(ih264d_ctl_set_num_cores_op_t);
   auto status = ih264d_api_function(codecContext, &s_set_cores_ip, &s_set_cores_op);
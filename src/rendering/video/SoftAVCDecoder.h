@@ -43,6 +43,12 @@ namespace pag {
  */
 class SoftAVCDecoder : public SoftwareDecoder {
  public:
+  /**
+   * Creates a decoder which decodes frames with the specified number of threads. libavc uses up to
+   * 3 threads, one of them parses the bitstream while the others decode and filter the macroblocks.
+   */
+  explicit SoftAVCDecoder(int threadCount = 1);
+
   ~SoftAVCDecoder() override;
 
   bool onConfigure(const std::vector<HeaderData>& headers, std::string mime, int width,
@@ -65,6 +71,7 @@ class SoftAVCDecoder : public SoftwareDecoder {
   ivd_video_decode_ip_t decodeInput = {};
   ivd_video_decode_op_t decodeOutput = {};
   bool flushed = true;
+  int threadCount = 1;
 
   bool initDecoder();
   bool openDecoder();
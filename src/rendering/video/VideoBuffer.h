@@ -19,6 +19,7 @@
 #pragma once
 
 #include "tgfx/core/ImageBuffer.h"
+#include "tgfx/gpu/UploadBuffer.h"
 #include "tgfx/gpu/YUVTexture.h"
 
 namespace pag {
@@ -32,6 +33,38 @@ class VideoBuffer : public tgfx::ImageBuffer {
    */
   virtual size_t planeCount() const = 0;
 
+  /**
+   * Copies the pixels into a new VideoBuffer which owns its memory and stays valid after the
+   * decoder outputs other frames. The reusableBuffer is reused if it is a buffer returned by this
+   * method before and has the same size. Returns nullptr if the pixels are not accessible by CPU.
+   */
+  virtual std::shared_ptr<VideoBuffer> makeCopy(std::shared_ptr<VideoBuffer>) const {
+    return nullptr;
+  }
+
+  /**
+   * Returns the byte size of the UploadBuffer required by writeToUploadBuffer(). Returns 0 if the
+   * pixels are not accessible by CPU.
+   */
+  virtual size_t uploadBufferSize() const {
+    return 0;
+  }
+
+  /**
+   * Copies the pixels into the mapped memory of an UploadBuffer, which can be called from any
+   * thread. Returns false if the pixels are not accessible by CPU.
+   */
+  virtual bool writeToUploadBuffer(void*) const {
+    return false;
+  }
+
+  /**
+   * Creates a new Texture from an UploadBuffer filled by writeToUploadBuffer().
+   */
+  virtual std::shared_ptr<tgfx::Texture> makeUploadedTexture(tgfx::UploadBuffer*) const {
+    return nullptr;
+  }
+
  protected:
   VideoBuffer(int width, int height) : tgfx::ImageBuffer(width, height) {
   }
@@ -21,6 +21,7 @@
 #include <mutex>
 #include "SoftAVCDecoder.h"
 #include "SoftwareDecoderWrapper.h"
+#include "VideoDecoderPool.h"
 #include "pag/pag.h"
 #include "platform/Platform.h"
 
@@ -28,6 +29,7 @@ namespace pag {
 static std::atomic<SoftwareDecoderFactory*> softwareDecoderFactory = {nullptr};
 static std::atomic_int maxHardwareDecoderCount = {65535};
 static std::atomic_int globalGPUDecoderCount = {0};
+static std::atomic_int softwareDecoderThreadCount = {1};
 
 void PAGVideoDecoder::SetMaxHardwareDecoderCount(int count) {
   maxHardwareDecoderCount = count;
@@ -35,6 +37,18 @@ void PAGVideoDecoder::SetMaxHardwareDecoderCount(int count) {
 
 void PAGVideoDecoder::RegisterSoftwareDecoderFactory(SoftwareDecoderFactory* decoderFactory) {
   softwareDecoderFactory = decoderFactory;
+  // The idle decoders are created by the previous factory.
+  VideoDecoderPool::GetInstance()->clear();
+}
+
+void PAGVideoDecoder::SetSoftwareDecoderThreadCount(int count) {
+  softwareDecoderThreadCount = count;
+  // The idle decoders are created with the previous thread count.
+  VideoDecoderPool::GetInstance()->clear();
+}
+
+void PAGVideoDecoder::SetMaxIdleDecoderCount(int count) {
+  VideoDecoderPool::GetInstance()->setMaxIdleCount(count);
 }
 
 bool VideoDecoder::HasHardwareDecoder() {
@@ -45,6 +59,10 @@ int VideoDecoder::GetMaxHardwareDecoderCount() {
   return maxHardwareDecoderCount;
 }
 
+int VideoDecoder::GetSoftwareDecoderThreadCount() {
+  return softwareDecoderThreadCount;
+}
+
 bool VideoDecoder::HasSoftwareDecoder() {
 #ifdef PAG_USE_LIBAVC
   return true;
@@ -82,7 +100,8 @@ std::unique_ptr<VideoDecoder> VideoDecoder::CreateSoftwareDecoder(const VideoFor
 
 #ifdef PAG_USE_LIBAVC
   if (videoDecoder == nullptr) {
-    videoDecoder = SoftwareDecoderWrapper::Wrap(std::make_unique<SoftAVCDecoder>(), format);
+    auto softAVCDecoder = std::make_unique<SoftAVCDecoder>(GetSoftwareDecoderThreadCount());
+    videoDecoder = SoftwareDecoderWrapper::Wrap(std::move(softAVCDecoder), format);
     if (videoDecoder != nullptr) {
       LOGI("All other video decoders are not available, fallback to SoftAVCDecoder!");
     }
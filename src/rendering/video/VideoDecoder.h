@@ -55,6 +55,11 @@ class VideoDecoder {
    */
   static int GetMaxHardwareDecoderCount();
 
+  /**
+   * Returns the number of threads used by each built-in software video decoder.
+   */
+  static int GetSoftwareDecoderThreadCount();
+
   /**
    * Creates a new video decoder by specified type. Returns a hardware video decoder if useHardware
    * is true, otherwise, returns a software video decoder.
@@ -0,0 +1,113 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "VideoDecoderPool.h"
+#include <algorithm>
+#include <cstring>
+#include "tgfx/core/Clock.h"
+
+namespace pag {
+static constexpr int64_t DECODER_IDLE_TIMEOUT = 5000000;  // 5s
+
+static bool IsSameFormat(const VideoFormat& a, const VideoFormat& b) {
+  if (a.mimeType != b.mimeType || a.width != b.width || a.height != b.height ||
+      a.colorSpace != b.colorSpace || a.colorRange != b.colorRange ||
+      a.headers.size() != b.headers.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.headers.size(); i++) {
+    auto& headerA = a.headers[i];
+    auto& headerB = b.headers[i];
+    if (headerA->size() != headerB->size() ||
+        memcmp(headerA->data(), headerB->data(), headerA->size()) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+VideoDecoderPool* VideoDecoderPool::GetInstance() {
+  // Never destroyed, the idle decoders may depend on other static objects during exiting.
+  static auto& pool = *new VideoDecoderPool();
+  return &pool;
+}
+
+std::unique_ptr<VideoDecoder> VideoDecoderPool::checkOut(const VideoFormat& format) {
+  std::lock_guard<std::mutex> autoLock(locker);
+  for (auto item = idleDecoders.begin(); item != idleDecoders.end(); item++) {
+    if (IsSameFormat(item->format, format)) {
+      auto decoder = std::move(item->decoder);
+      idleDecoders.erase(item);
+      return decoder;
+    }
+  }
+  return nullptr;
+}
+
+void VideoDecoderPool::checkIn(const VideoFormat& format, std::unique_ptr<VideoDecoder> decoder) {
+  if (decoder == nullptr || decoder->isHardwareBacked()) {
+    return;
+  }
+  decoder->onFlush();
+  IdleDecoder idleDecoder = {};
+  idleDecoder.format = format;
+  // The headers may point to the memory of a File, which could be released before the decoder.
+  idleDecoder.format.headers.clear();
+  for (auto& header : format.headers) {
+    idleDecoder.format.headers.push_back(tgfx::Data::MakeWithCopy(header->data(), header->size()));
+  }
+  idleDecoder.decoder = std::move(decoder);
+  idleDecoder.idleTime = tgfx::Clock::Now();
+  std::lock_guard<std::mutex> autoLock(locker);
+  idleDecoders.push_front(std::move(idleDecoder));
+  while (idleDecoders.size() > static_cast<size_t>(std::max(_maxIdleCount, 0))) {
+    idleDecoders.pop_back();
+  }
+}
+
+void VideoDecoderPool::purgeExpired() {
+  auto expiredTime = tgfx::Clock::Now() - DECODER_IDLE_TIMEOUT;
+  std::lock_guard<std::mutex> autoLock(locker);
+  while (!idleDecoders.empty() && idleDecoders.back().idleTime < expiredTime) {
+    idleDecoders.pop_back();
+  }
+}
+
+void VideoDecoderPool::clear() {
+  std::lock_guard<std::mutex> autoLock(locker);
+  idleDecoders.clear();
+}
+
+int VideoDecoderPool::maxIdleCount() {
+  std::lock_guard<std::mutex> autoLock(locker);
+  return _maxIdleCount;
+}
+
+void VideoDecoderPool::setMaxIdleCount(int count) {
+  std::lock_guard<std::mutex> autoLock(locker);
+  _maxIdleCount = count;
+  while (idleDecoders.size() > static_cast<size_t>(std::max(_maxIdleCount, 0))) {
+    idleDecoders.pop_back();
+  }
+}
+
+size_t VideoDecoderPool::idleCount() {
+  std::lock_guard<std::mutex> autoLock(locker);
+  return idleDecoders.size();
+}
+}  // namespace pag
@@ -0,0 +1,91 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include "VideoDecoder.h"
+
+namespace pag {
+/**
+ * VideoDecoderPool keeps the idle software video decoders returned by VideoReaders, so that a new
+ * VideoReader of the same video format can reuse one of them rather than paying the initialization
+ * cost again. The idle decoders are released if they exceed the maximum idle count or stay unused
+ * for longer than the idle timeout.
+ */
+class VideoDecoderPool {
+ public:
+  /**
+   * Returns the VideoDecoderPool shared by the whole process.
+   */
+  static VideoDecoderPool* GetInstance();
+
+  /**
+   * Returns an idle software decoder for the specified video format and removes it from the pool.
+   * Returns nullptr if there is no matching one.
+   */
+  std::unique_ptr<VideoDecoder> checkOut(const VideoFormat& format);
+
+  /**
+   * Flushes the decoder and keeps it in the pool for reusing. The decoder is released immediately
+   * if it is hardware backed or the maximum idle count is zero.
+   */
+  void checkIn(const VideoFormat& format, std::unique_ptr<VideoDecoder> decoder);
+
+  /**
+   * Releases the decoders which have been idle for longer than the idle timeout.
+   */
+  void purgeExpired();
+
+  /**
+   * Releases all idle decoders.
+   */
+  void clear();
+
+  /**
+   * Returns the maximum number of idle decoders kept in the pool.
+   */
+  int maxIdleCount();
+
+  /**
+   * Sets the maximum number of idle decoders kept in the pool, the least recently returned ones are
+   * released if the pool exceeds the new count.
+   */
+  void setMaxIdleCount(int count);
+
+  /**
+   * Returns the number of idle decoders in the pool.
+   */
+  size_t idleCount();
+
+ private:
+  struct IdleDecoder {
+    VideoFormat format = {};
+    std::unique_ptr<VideoDecoder> decoder = nullptr;
+    int64_t idleTime = 0;
+  };
+
+  std::mutex locker = {};
+  int _maxIdleCount = 4;
+  // The idle decoders, the most recently returned first.
+  std::list<IdleDecoder> idleDecoders = {};
+
+  VideoDecoderPool() = default;
+};
+}  // namespace pag
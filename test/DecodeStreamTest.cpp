@@ -0,0 +1,210 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <vector>
+#include "codec/utils/DecodeStream.h"
+#include "codec/utils/EncodeStream.h"
+#include "framework/pag_test.h"
+
+namespace pag {
+// Crosses the batches of readFloatList() and leaves a partial batch at the end.
+static const uint32_t ListSize = 100;
+
+/**
+ * Returns the unsigned values that writeUint32List() stores with exactly numBits bits.
+ */
+static std::vector<uint32_t> MakeUintList(uint8_t numBits, uint32_t count) {
+  auto mask = numBits >= 32 ? UINT32_MAX : (1u << numBits) - 1;
+  std::vector<uint32_t> values(count);
+  for (uint32_t i = 0; i < count; i++) {
+    values[i] = (i * 2654435761u) & mask;
+  }
+  values[0] = 1u << (numBits - 1);
+  return values;
+}
+
+/**
+ * Returns the signed values that writeInt32List() stores with exactly numBits bits, numBits must
+ * be at least 2.
+ */
+static std::vector<int32_t> MakeIntList(uint8_t numBits, uint32_t count) {
+  auto half = static_cast<int64_t>(1) << (numBits - 2);
+  std::vector<int32_t> values(count);
+  for (uint32_t i = 0; i < count; i++) {
+    auto hash = static_cast<int64_t>(i * 2654435761u);
+    values[i] = static_cast<int32_t>(hash % (half * 2 + 1) - half);
+  }
+  values[0] = static_cast<int32_t>(half);
+  values[1] = static_cast<int32_t>(-half);
+  return values;
+}
+
+/**
+ * 用例描述: 测试 1 到 32 位的列表经 EncodeStream 写入后可以被 DecodeStream 正确读出
+ */
+PAG_TEST(DecodeStreamTest, BitListRoundTrip) {
+  for (uint8_t numBits = 1; numBits <= 32; numBits++) {
+    auto uintList = MakeUintList(numBits, ListSize);
+    auto intList = MakeIntList(std::max(numBits, static_cast<uint8_t>(2)), ListSize);
+    std::vector<float> floatList(ListSize);
+    for (uint32_t i = 0; i < ListSize; i++) {
+      // Keeps the floats small enough to survive the rounding of the encoder.
+      floatList[i] = static_cast<float>(intList[i] >> std::max(numBits - 20, 0)) * 0.01f;
+    }
+    StreamContext context = {};
+    EncodeStream encodeStream(&context);
+    encodeStream.writeUint32List(uintList.data(), ListSize);
+    encodeStream.writeInt32List(intList.data(), ListSize);
+    encodeStream.writeFloatList(floatList.data(), ListSize, 0.01f);
+    // The values read one by one start at an odd bit position.
+    encodeStream.writeUBits(1, 1);
+    for (uint32_t i = 0; i < ListSize; i++) {
+      encodeStream.writeUBits(uintList[i], numBits);
+    }
+    auto bytes = encodeStream.release();
+    auto data = ByteData::MakeCopy(bytes->data(), bytes->length());
+
+    DecodeStream stream(&context, data->data(), static_cast<uint32_t>(data->length()));
+    auto peekStream = stream;
+    EXPECT_EQ(peekStream.readNumBits(), numBits);
+    std::vector<uint32_t> uintResult(ListSize);
+    stream.readUint32List(uintResult.data(), ListSize);
+    EXPECT_EQ(uintResult, uintList) << "numBits: " << static_cast<int>(numBits);
+    std::vector<int32_t> intResult(ListSize);
+    stream.readInt32List(intResult.data(), ListSize);
+    EXPECT_EQ(intResult, intList) << "numBits: " << static_cast<int>(numBits);
+    std::vector<float> floatResult(ListSize);
+    stream.readFloatList(floatResult.data(), ListSize, 0.01f);
+    for (uint32_t i = 0; i < ListSize; i++) {
+      EXPECT_FLOAT_EQ(floatResult[i], floatList[i]) << "numBits: " << static_cast<int>(numBits);
+    }
+    EXPECT_EQ(stream.readUBits(1), 1u);
+    for (uint32_t i = 0; i < ListSize; i++) {
+      EXPECT_EQ(stream.readUBits(numBits), uintList[i]) << "numBits: " << static_cast<int>(numBits);
+    }
+    EXPECT_FALSE(context.hasException());
+    EXPECT_EQ(stream.bytesAvailable(), 0u);
+  }
+}
+
+/**
+ * 用例描述: 测试结束于子数据流最后 8 个字节内的列表不会读到子数据流之外的数据
+ */
+PAG_TEST(DecodeStreamTest, ListAtEndOfSubStream) {
+  for (uint8_t numBits = 1; numBits <= 32; numBits++) {
+    // An odd count leaves the last value in the middle of a byte.
+    auto uintList = MakeUintList(numBits, 37);
+    StreamContext context = {};
+    EncodeStream encodeStream(&context);
+    encodeStream.writeUint32List(uintList.data(), static_cast<uint32_t>(uintList.size()));
+    auto bytes = encodeStream.release();
+    // The list is followed by more bytes in the parent stream, as a tag body usually is.
+    std::vector<uint8_t> buffer(bytes->length() + 8, 0xFF);
+    memcpy(buffer.data(), bytes->data(), bytes->length());
+    auto length = static_cast<uint32_t>(bytes->length());
+    DecodeStream parentStream(&context, buffer.data(), static_cast<uint32_t>(buffer.size()));
+    auto stream = parentStream.readBytes(length);
+    std::vector<uint32_t> result(uintList.size());
+    stream.readUint32List(result.data(), static_cast<uint32_t>(result.size()));
+    EXPECT_EQ(result, uintList) << "numBits: " << static_cast<int>(numBits);
+    EXPECT_FALSE(context.hasException());
+    EXPECT_EQ(stream.bytesAvailable(), 0u);
+  }
+}
+
+/**
+ * 用例描述: 测试 readUBits 可以读取到数据流的最后一位，超出末尾时报错
+ */
+PAG_TEST(DecodeStreamTest, ReadUBitsAtEnd) {
+  for (uint8_t numBits = 1; numBits <= 32; numBits++) {
+    // Eight values of numBits bits fill exactly numBits bytes.
+    auto uintList = MakeUintList(numBits, 8);
+    StreamContext context = {};
+    EncodeStream encodeStream(&context);
+    for (auto value : uintList) {
+      encodeStream.writeUBits(value, numBits);
+    }
+    auto bytes = encodeStream.release();
+    ASSERT_EQ(bytes->length(), static_cast<size_t>(numBits));
+    // An exact copy, so that any read past the end leaves the allocation.
+    auto data = ByteData::MakeCopy(bytes->data(), bytes->length());
+    DecodeStream stream(&context, data->data(), static_cast<uint32_t>(data->length()));
+    for (auto value : uintList) {
+      EXPECT_EQ(stream.readUBits(numBits), value) << "numBits: " << static_cast<int>(numBits);
+    }
+    EXPECT_FALSE(context.hasException());
+    EXPECT_EQ(stream.bytesAvailable(), 0u);
+    EXPECT_EQ(stream.readUBits(1), 0u);
+    EXPECT_TRUE(context.hasException());
+  }
+}
+
+/**
+ * 用例描述: 测试超出数据流末尾的列表读取会报错
+ */
+PAG_TEST(DecodeStreamTest, OverrunningList) {
+  auto uintList = MakeUintList(13, ListSize);
+  auto intList = MakeIntList(13, ListSize);
+  std::vector<float> floatList(ListSize);
+  for (uint32_t i = 0; i < ListSize; i++) {
+    floatList[i] = static_cast<float>(intList[i]) * 0.01f;
+  }
+  StreamContext encodeContext = {};
+  EncodeStream encodeStream(&encodeContext);
+  encodeStream.writeUint32List(uintList.data(), ListSize);
+  auto uintBytes = encodeStream.release();
+  encodeStream.writeInt32List(intList.data(), ListSize);
+  auto intBytes = encodeStream.release();
+  encodeStream.writeFloatList(floatList.data(), ListSize, 0.01f);
+  auto floatBytes = encodeStream.release();
+
+  // Reads one more value than the list has.
+  {
+    StreamContext context = {};
+    DecodeStream stream(&context, uintBytes->data(), static_cast<uint32_t>(uintBytes->length()));
+    std::vector<uint32_t> result(ListSize + 1);
+    stream.readUint32List(result.data(), ListSize + 1);
+    EXPECT_TRUE(context.hasException());
+  }
+  {
+    StreamContext context = {};
+    DecodeStream stream(&context, intBytes->data(), static_cast<uint32_t>(intBytes->length()));
+    std::vector<int32_t> result(ListSize + 1);
+    stream.readInt32List(result.data(), ListSize + 1);
+    EXPECT_TRUE(context.hasException());
+  }
+  {
+    StreamContext context = {};
+    DecodeStream stream(&context, floatBytes->data(),
+                        static_cast<uint32_t>(floatBytes->length()));
+    std::vector<float> result(ListSize + 1);
+    stream.readFloatList(result.data(), ListSize + 1, 0.01f);
+    EXPECT_TRUE(context.hasException());
+  }
+  // Reads the whole list from a truncated stream.
+  {
+    StreamContext context = {};
+    DecodeStream stream(&context, uintBytes->data(),
+                        static_cast<uint32_t>(uintBytes->length() - 1));
+    std::vector<uint32_t> result(ListSize);
+    stream.readUint32List(result.data(), ListSize);
+    EXPECT_TRUE(context.hasException());
+  }
+}
+}  // namespace pag
@@ -0,0 +1,84 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "framework/pag_test.h"
+
+namespace pag {
+
+PAG_TEST_SUIT(PAGExportSessionTest)
+
+/**
+ * 用例描述: 多线程导出的帧按顺序回调，并且与单线程导出的结果一致
+ */
+PAG_TEST(PAGExportSessionTest, ExportFrames) {
+  auto pagFile = PAGFile::Load("../resources/apitest/test.pag");
+  ASSERT_NE(pagFile, nullptr);
+  auto textData = pagFile->getTextData(0);
+  textData->text = "PAGExportSession";
+  pagFile->replaceText(0, textData);
+  auto width = pagFile->width();
+  auto height = pagFile->height();
+  Frame endFrame = 39;
+
+  std::vector<std::vector<uint8_t>> expectedFrames = {};
+  auto session = PAGExportSession::Make(pagFile, width, height, 1);
+  ASSERT_NE(session, nullptr);
+  auto success = session->exportFrames(
+      0, endFrame, ColorType::RGBA_8888, AlphaType::Premultiplied,
+      [&](Frame, const void* pixels, size_t rowBytes) {
+        auto bytes = static_cast<const uint8_t*>(pixels);
+        expectedFrames.emplace_back(bytes, bytes + rowBytes * height);
+        return true;
+      });
+  EXPECT_TRUE(success);
+  ASSERT_EQ(static_cast<Frame>(expectedFrames.size()), endFrame + 1);
+
+  session = PAGExportSession::Make(pagFile, width, height, 4);
+  ASSERT_NE(session, nullptr);
+  EXPECT_EQ(session->workerCount(), 4);
+  Frame nextFrame = 0;
+  success = session->exportFrames(
+      0, endFrame, ColorType::RGBA_8888, AlphaType::Premultiplied,
+      [&](Frame frame, const void* pixels, size_t rowBytes) {
+        EXPECT_EQ(frame, nextFrame);
+        auto& expected = expectedFrames[static_cast<size_t>(frame)];
+        EXPECT_EQ(memcmp(expected.data(), pixels, rowBytes * height), 0);
+        nextFrame++;
+        return true;
+      });
+  EXPECT_TRUE(success);
+  EXPECT_EQ(nextFrame, endFrame + 1);
+}
+
+/**
+ * 用例描述: 回调返回 false 时取消剩余帧的导出
+ */
+PAG_TEST(PAGExportSessionTest, Cancel) {
+  auto pagFile = PAGFile::Load("../resources/apitest/test.pag");
+  ASSERT_NE(pagFile, nullptr);
+  auto session = PAGExportSession::Make(pagFile, pagFile->width(), pagFile->height(), 4);
+  ASSERT_NE(session, nullptr);
+  int count = 0;
+  auto success = session->exportFrames(0, 100, ColorType::RGBA_8888, AlphaType::Premultiplied,
+                                       [&](Frame, const void*, size_t) { return ++count < 5; });
+  EXPECT_FALSE(success);
+  EXPECT_EQ(count, 5);
+  EXPECT_EQ(PAGExportSession::Make(nullptr, 100, 100), nullptr);
+  EXPECT_EQ(PAGExportSession::Make(pagFile, 0, 100), nullptr);
+}
+}  // namespace pag
@@ -16,7 +16,12 @@
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include "base/utils/Task.h"
 #include "base/utils/TimeUtil.h"
+#include "codec/CodecContext.h"
+#include "codec/TagHeader.h"
+#include "codec/tags/FileTags.h"
+#include "codec/utils/LZ4.h"
 #include "framework/pag_test.h"
 #include "framework/utils/PAGTestUtils.h"
 #include "nlohmann/json.hpp"
@@ -352,6 +357,289 @@ PAG_TEST(PAGFileLoadTest, loadTest) {
   ASSERT_TRUE(file == nullptr);
 }
 
+/**
+ * 用例描述: 内存映射方式加载的 PAGFile 直接引用映射的数据，编码结果与普通加载一致
+ */
+PAG_TEST(PAGFileLoadTest, memoryMap) {
+  auto byteData = ByteData::FromPath(PAG_COMPLEX_FILE_PATH);
+  ASSERT_TRUE(byteData != nullptr);
+  auto mappedData = ByteData::MapFromPath(PAG_COMPLEX_FILE_PATH);
+  if (mappedData == nullptr) {
+    // Memory mapping is not supported on current platform.
+    return;
+  }
+  ASSERT_EQ(mappedData->length(), byteData->length());
+  auto mappedStart = mappedData->data();
+  auto mappedEnd = mappedStart + mappedData->length();
+  auto mappedFile = Codec::Decode(std::move(mappedData), "");
+  ASSERT_TRUE(mappedFile != nullptr);
+  ASSERT_FALSE(mappedFile->images.empty());
+  for (auto imageBytes : mappedFile->images) {
+    EXPECT_TRUE(imageBytes->fileBytes->data() >= mappedStart &&
+                imageBytes->fileBytes->data() < mappedEnd);
+  }
+  auto file = Codec::Decode(byteData->data(), static_cast<uint32_t>(byteData->length()), "");
+  ASSERT_TRUE(file != nullptr);
+  auto mappedBytes = Codec::Encode(mappedFile);
+  auto bytes = Codec::Encode(file);
+  ASSERT_EQ(mappedBytes->length(), bytes->length());
+  EXPECT_EQ(memcmp(mappedBytes->data(), bytes->data(), bytes->length()), 0);
+
+  PAGFile::SetMemoryMapEnabled(true);
+  EXPECT_TRUE(PAGFile::MemoryMapEnabled());
+  EXPECT_TRUE(PAGFile::Load(PAG_COMPLEX_FILE_PATH) != nullptr);
+  EXPECT_TRUE(PAGFile::Load(PAG_ERROR_FILE_PATH_ERRPATH) == nullptr);
+  PAGFile::SetMemoryMapEnabled(false);
+}
+
+/**
+ * 用例描述: 延迟解码模式下视频序列帧在首次使用时才解码，静态区间和编码结果与普通加载一致
+ */
+PAG_TEST(PAGFileLoadTest, lazyDecoding) {
+  std::string filePath = "../resources/apitest/video_sequence_with_mp4header.pag";
+  auto byteData = ByteData::FromPath(filePath);
+  ASSERT_TRUE(byteData != nullptr);
+  PAGFile::SetLazyDecodingEnabled(true);
+  EXPECT_TRUE(PAGFile::LazyDecodingEnabled());
+  // Loads from bytes without memory mapping, the File keeps a copy of the bytes instead.
+  auto lazyFile = File::Load(byteData->data(), byteData->length());
+  PAGFile::SetLazyDecodingEnabled(false);
+  ASSERT_TRUE(lazyFile != nullptr);
+  EXPECT_TRUE(lazyFile->mappedData != nullptr);
+  auto file = Codec::Decode(byteData->data(), static_cast<uint32_t>(byteData->length()), "");
+  ASSERT_TRUE(file != nullptr);
+  ASSERT_EQ(lazyFile->compositions.size(), file->compositions.size());
+  int videoCount = 0;
+  for (size_t i = 0; i < file->compositions.size(); i++) {
+    auto lazyComposition = lazyFile->compositions[i];
+    auto composition = file->compositions[i];
+    ASSERT_EQ(lazyComposition->staticTimeRanges.size(), composition->staticTimeRanges.size());
+    for (size_t j = 0; j < composition->staticTimeRanges.size(); j++) {
+      EXPECT_EQ(lazyComposition->staticTimeRanges[j].start,
+                composition->staticTimeRanges[j].start);
+      EXPECT_EQ(lazyComposition->staticTimeRanges[j].end, composition->staticTimeRanges[j].end);
+    }
+    if (composition->type() != CompositionType::Video) {
+      continue;
+    }
+    videoCount++;
+    auto videoComposition = static_cast<VideoComposition*>(lazyComposition);
+    EXPECT_TRUE(videoComposition->sequences.empty());
+    auto sequence = static_cast<VideoSequence*>(Sequence::Get(videoComposition));
+    ASSERT_TRUE(sequence != nullptr);
+    EXPECT_EQ(sequence->frames.size(),
+              static_cast<VideoComposition*>(composition)->sequences.back()->frames.size());
+  }
+  EXPECT_GT(videoCount, 0);
+  auto lazyBytes = Codec::Encode(lazyFile);
+  auto bytes = Codec::Encode(file);
+  ASSERT_EQ(lazyBytes->length(), bytes->length());
+  EXPECT_EQ(memcmp(lazyBytes->data(), bytes->data(), bytes->length()), 0);
+}
+
+/**
+ * 用例描述: 并行解码的合成顺序和图片数量与串行解码一致
+ */
+PAG_TEST(PAGFileLoadTest, parallelDecoding) {
+  ASSERT_GT(TaskGroup::GetInstance()->threadCount(), 1);
+  // Finds the file with the most composition bytes, which must take the parallel path.
+  std::vector<std::string> files;
+  GetAllPAGFiles("../resources/apitest", files);
+  std::unique_ptr<ByteData> byteData = nullptr;
+  size_t compositionCount = 0;
+  uint32_t compositionBytes = 0;
+  for (auto& path : files) {
+    auto candidate = ByteData::FromPath(path);
+    if (candidate == nullptr) {
+      continue;
+    }
+    CodecContext context = {};
+    DecodeStream stream(&context, candidate->data(), static_cast<uint32_t>(candidate->length()));
+    std::unique_ptr<ByteData> bodyData = nullptr;
+    auto bodyBytes = ReadBodyBytes(&stream, &bodyData);
+    size_t count = 0;
+    uint32_t bytes = 0;
+    auto header = ReadTagHeader(&bodyBytes);
+    while (!context.hasException() && header.code != TagCode::End) {
+      bodyBytes.skip(header.length);
+      if (header.code == TagCode::VectorCompositionBlock ||
+          header.code == TagCode::BitmapCompositionBlock ||
+          header.code == TagCode::VideoCompositionBlock) {
+        count++;
+        bytes += header.length;
+      }
+      header = ReadTagHeader(&bodyBytes);
+    }
+    if (!context.hasException() && count > 1 && bytes > compositionBytes) {
+      byteData = std::move(candidate);
+      compositionCount = count;
+      compositionBytes = bytes;
+    }
+  }
+  ASSERT_TRUE(byteData != nullptr);
+  ASSERT_GT(compositionCount, 1u);
+  ASSERT_GE(compositionBytes, static_cast<uint32_t>(MIN_PARALLEL_DECODING_BYTES));
+
+  auto file = Codec::Decode(byteData->data(), static_cast<uint32_t>(byteData->length()), "");
+  ASSERT_TRUE(file != nullptr);
+  ASSERT_EQ(file->compositions.size(), compositionCount);
+  // Reads the same tags one by one as the serial reference.
+  CodecContext context = {};
+  DecodeStream stream(&context, byteData->data(), static_cast<uint32_t>(byteData->length()));
+  std::unique_ptr<ByteData> bodyData = nullptr;
+  auto bodyBytes = ReadBodyBytes(&stream, &bodyData);
+  ASSERT_FALSE(context.hasException());
+  ReadTags(&bodyBytes, &context, ReadTagsOfFile);
+  ASSERT_FALSE(context.hasException());
+  ASSERT_EQ(file->compositions.size(), context.compositions.size());
+  for (size_t i = 0; i < context.compositions.size(); i++) {
+    EXPECT_EQ(file->compositions[i]->id, context.compositions[i]->id);
+    EXPECT_EQ(file->compositions[i]->type(), context.compositions[i]->type());
+  }
+  EXPECT_EQ(file->images.size(), context.images.size());
+  EXPECT_EQ(file->tagLevel(), context.tagLevel);
+}
+
+/**
+ * 用例描述: 引用了缺失图片的合成并行解码时和串行解码一样只生成一个占位图片
+ */
+PAG_TEST(PAGFileLoadTest, parallelDecodingMissingImages) {
+  ASSERT_GT(TaskGroup::GetInstance()->threadCount(), 1);
+  // Finds the file with the most images and removes their tags, so that the image layers all refer
+  // to missing images.
+  std::vector<std::string> files;
+  GetAllPAGFiles("../resources/apitest", files);
+  std::vector<uint8_t> body = {};
+  size_t maxImageCount = 0;
+  for (auto& path : files) {
+    auto byteData = ByteData::FromPath(path);
+    if (byteData == nullptr) {
+      continue;
+    }
+    CodecContext context = {};
+    DecodeStream stream(&context, byteData->data(), static_cast<uint32_t>(byteData->length()));
+    std::unique_ptr<ByteData> bodyData = nullptr;
+    auto bodyBytes = ReadBodyBytes(&stream, &bodyData);
+    std::vector<uint8_t> tags = {};
+    size_t imageCount = 0;
+    size_t compositionCount = 0;
+    while (!context.hasException() && bodyBytes.bytesAvailable() > 0) {
+      auto tagStart = bodyBytes.position();
+      auto header = ReadTagHeader(&bodyBytes);
+      bodyBytes.skip(header.length);
+      if (header.code == TagCode::ImageBytes || header.code == TagCode::ImageBytesV2 ||
+          header.code == TagCode::ImageBytesV3) {
+        imageCount++;
+        continue;
+      }
+      if (header.code == TagCode::VectorCompositionBlock ||
+          header.code == TagCode::BitmapCompositionBlock ||
+          header.code == TagCode::VideoCompositionBlock) {
+        compositionCount++;
+      }
+      tags.insert(tags.end(), bodyBytes.data() + tagStart, bodyBytes.data() + bodyBytes.position());
+      if (header.code == TagCode::End) {
+        break;
+      }
+    }
+    if (!context.hasException() && compositionCount > 1 && imageCount > maxImageCount) {
+      body = std::move(tags);
+      maxImageCount = imageCount;
+    }
+  }
+  ASSERT_GT(maxImageCount, 0u);
+
+  CodecContext serialContext = {};
+  DecodeStream serialStream(&serialContext, body.data(), static_cast<uint32_t>(body.size()));
+  ReadTags(&serialStream, &serialContext, ReadTagsOfFile);
+  ASSERT_FALSE(serialContext.hasException());
+  ASSERT_GT(serialContext.images.size(), 0u);
+
+  // Each tag comes in a chunk of its own, so every composition is read by a different task.
+  CodecContext parallelContext = {};
+  DecodeStream parallelStream(&parallelContext, body.data(), static_cast<uint32_t>(body.size()));
+  auto nextChunk = [&](DecodeStream* chunk) {
+    if (parallelStream.bytesAvailable() == 0) {
+      return false;
+    }
+    auto tagStart = parallelStream.position();
+    auto header = ReadTagHeader(&parallelStream);
+    parallelStream.skip(header.length);
+    *chunk = DecodeStream(&parallelContext, body.data() + tagStart,
+                          parallelStream.position() - tagStart);
+    return true;
+  };
+  ReadFileTags(nextChunk, MIN_PARALLEL_DECODING_BYTES, &parallelContext);
+  ASSERT_FALSE(parallelContext.hasException());
+  ASSERT_EQ(parallelContext.compositions.size(), serialContext.compositions.size());
+  for (size_t i = 0; i < serialContext.compositions.size(); i++) {
+    EXPECT_EQ(parallelContext.compositions[i]->id, serialContext.compositions[i]->id);
+  }
+  EXPECT_EQ(parallelContext.images.size(), serialContext.images.size());
+}
+
+/**
+ * 用例描述: LZ4 压缩编码的 PAG 文件按完整的 tag 分块，可以正确解码，损坏的压缩数据解码失败
+ */
+PAG_TEST(PAGFileLoadTest, compressedBody) {
+  auto file = File::Load(PAG_COMPLEX_FILE_PATH);
+  ASSERT_TRUE(file != nullptr);
+  auto bytes = Codec::Encode(file, nullptr, false);
+  auto compressedBytes = Codec::Encode(file, nullptr, true);
+  ASSERT_TRUE(compressedBytes != nullptr);
+  EXPECT_LT(compressedBytes->length(), bytes->length());
+  auto compressedFile = Codec::Decode(compressedBytes->data(),
+                                      static_cast<uint32_t>(compressedBytes->length()), "");
+  ASSERT_TRUE(compressedFile != nullptr);
+  auto result = Codec::Encode(compressedFile);
+  ASSERT_EQ(result->length(), bytes->length());
+  EXPECT_EQ(memcmp(result->data(), bytes->data(), bytes->length()), 0);
+
+  auto mappedFile = Codec::Decode(ByteData::MakeCopy(compressedBytes->data(),
+                                                     compressedBytes->length()), "");
+  ASSERT_TRUE(mappedFile != nullptr);
+  result = Codec::Encode(mappedFile);
+  ASSERT_EQ(result->length(), bytes->length());
+  EXPECT_EQ(memcmp(result->data(), bytes->data(), bytes->length()), 0);
+
+  // Every chunk after the 11-byte file header holds whole tags.
+  CodecContext context = {};
+  DecodeStream stream(&context, compressedBytes->data() + 11,
+                      static_cast<uint32_t>(compressedBytes->length() - 11));
+  while (stream.bytesAvailable() > 0) {
+    auto rawLength = stream.readUint32();
+    auto storedLength = stream.readUint32();
+    auto chunkBytes = stream.readBytes(storedLength);
+    ASSERT_FALSE(context.hasException());
+    std::vector<uint8_t> chunk(rawLength);
+    if (storedLength == rawLength) {
+      memcpy(chunk.data(), chunkBytes.data(), rawLength);
+    } else {
+      ASSERT_TRUE(LZ4Decompress(chunkBytes.data(), storedLength, chunk.data(), rawLength));
+    }
+    DecodeStream tags(&context, chunk.data(), rawLength);
+    while (tags.bytesAvailable() > 0) {
+      auto header = ReadTagHeader(&tags);
+      ASSERT_FALSE(context.hasException());
+      ASSERT_LE(header.length, tags.bytesAvailable());
+      tags.skip(header.length);
+    }
+  }
+
+  // Truncates the last chunk.
+  auto length = static_cast<uint32_t>(compressedBytes->length() - 1);
+  EXPECT_TRUE(Codec::Decode(compressedBytes->data(), length, "") == nullptr);
+
+  // The body length in the file header no longer matches the chunks.
+  auto badBytes = ByteData::MakeCopy(compressedBytes->data(), compressedBytes->length());
+  uint32_t bodyLength = 0;
+  memcpy(&bodyLength, badBytes->data() + 4, sizeof(uint32_t));
+  bodyLength += 1;
+  memcpy(badBytes->data() + 4, &bodyLength, sizeof(uint32_t));
+  EXPECT_TRUE(Codec::Decode(badBytes->data(), static_cast<uint32_t>(badBytes->length()), "") ==
+              nullptr);
+}
+
 PAG_TEST_CASE(PAGFileContainerTest)
 
 /**
@@ -0,0 +1,90 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <thread>
+#include "base/keyframes/SingleEaseKeyframe.h"
+#include "base/keyframes/SpatialPointKeyframe.h"
+#include "framework/pag_test.h"
+
+namespace pag {
+template <typename T, typename K>
+static std::unique_ptr<AnimatableProperty<T>> MakeProperty(const std::vector<T>& values,
+                                                           Frame duration) {
+  std::vector<Keyframe<T>*> keyframes = {};
+  for (size_t i = 0; i + 1 < values.size(); i++) {
+    auto keyframe = new K();
+    keyframe->startValue = values[i];
+    keyframe->endValue = values[i + 1];
+    keyframe->startTime = static_cast<Frame>(i) * duration;
+    keyframe->endTime = static_cast<Frame>(i + 1) * duration;
+    keyframe->interpolationType = KeyframeInterpolationType::Linear;
+    keyframes.push_back(keyframe);
+  }
+  return std::make_unique<AnimatableProperty<T>>(keyframes);
+}
+
+/**
+ * 用例描述: 关键帧属性的取值不依赖访问顺序
+ */
+PAG_TEST(PAGKeyframeTest, GetValueAt) {
+  auto property = MakeProperty<float, SingleEaseKeyframe<float>>({0, 10, 30, 60}, 10);
+  EXPECT_EQ(property->getValueAt(-5), 0);
+  EXPECT_EQ(property->getValueAt(0), 0);
+  EXPECT_EQ(property->getValueAt(5), 5);
+  EXPECT_EQ(property->getValueAt(25), 45);
+  EXPECT_EQ(property->getValueAt(15), 20);
+  EXPECT_EQ(property->getValueAt(30), 60);
+  EXPECT_EQ(property->getValueAt(100), 60);
+  EXPECT_EQ(property->findKeyframeAt(10), property->keyframes[1]);
+  EXPECT_EQ(property->findKeyframeAt(-1), property->keyframes[0]);
+  EXPECT_EQ(property->findKeyframeAt(31), property->keyframes[2]);
+}
+
+/**
+ * 用例描述: 多个线程同时在不同的时间点上对同一个关键帧属性取值
+ */
+PAG_TEST(PAGKeyframeTest, ConcurrentGetValueAt) {
+  auto property = MakeProperty<Point, SpatialPointKeyframe>(
+      {Point::Make(0, 0), Point::Make(100, 50), Point::Make(20, 200), Point::Make(0, 0)}, 20);
+  std::vector<Point> expected = {};
+  for (Frame frame = 0; frame <= 60; frame++) {
+    expected.push_back(property->getValueAt(frame));
+  }
+  std::vector<std::thread> threads = {};
+  std::vector<int> mismatches(4, 0);
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([&, i]() {
+      for (int loop = 0; loop < 200; loop++) {
+        // Each thread walks the timeline in a different order.
+        for (Frame step = 0; step <= 60; step++) {
+          auto frame = (step * (i * 2 + 1) + loop) % 61;
+          if (property->getValueAt(frame) != expected[frame]) {
+            mismatches[i]++;
+          }
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto count : mismatches) {
+    EXPECT_EQ(count, 0);
+  }
+}
+}  // namespace pag
@@ -18,15 +18,21 @@
 
 #ifdef PERFORMANCE_TEST
 
+#include <sys/resource.h>
 #include <filesystem>
 #include <fstream>
 #include <vector>
 #include "TestUtils.h"
 #include "base/utils/TimeUtil.h"
+#include "codec/utils/DecodeStream.h"
+#include "codec/utils/EncodeStream.h"
 #include "core/Clock.h"
 #include "framework/pag_test.h"
 #include "framework/utils/PAGTestUtils.h"
 #include "nlohmann/json.hpp"
+#include "rendering/caches/RenderCache.h"
+#include "rendering/sequences/VideoReader.h"
+#include "rendering/sequences/VideoSequenceDemuxer.h"
 
 namespace pag {
 using nlohmann::json;
@@ -156,5 +162,330 @@ PAG_TEST(PerformanceTest, TestRender) {
   outGraphicsFile << std::setw(4) << graphicsJson << std::endl;
   outGraphicsFile.close();
 }
+
+/**
+ * 用例描述: 测试显存紧张时 Snapshot 缓存淘汰策略下的渲染性能
+ */
+PAG_TEST(PerformanceTest, SnapshotCache) {
+  std::vector<std::string> files;
+  GetAllPAGFiles("../resources/smoke", files);
+  for (auto& file : files) {
+    auto fileName = file.substr(file.rfind('/') + 1, file.size());
+    auto pagFile = PAGFile::Load(file);
+    ASSERT_NE(pagFile, nullptr);
+    auto pagSurface = PAGSurface::MakeOffscreen(pagFile->width(), pagFile->height());
+    ASSERT_NE(pagSurface, nullptr);
+    auto pagPlayer = std::make_shared<PAGPlayer>();
+    pagPlayer->setSurface(pagSurface);
+    pagPlayer->setComposition(pagFile);
+    auto budget = pagPlayer->cacheBudget();
+    // Limits the snapshots to a quarter of the full-screen size to force evictions.
+    budget.purgeableMemory = static_cast<size_t>(pagFile->width()) * pagFile->height();
+    pagPlayer->setCacheBudget(budget);
+
+    Frame totalFrames = TimeToFrame(pagFile->duration(), pagFile->frameRate());
+    int64_t totalTime = 0;
+    size_t totalSnapshots = 0;
+    for (Frame currentFrame = 0; currentFrame < totalFrames; currentFrame++) {
+      pagPlayer->setProgress((currentFrame + 0.1) * 1.0 / totalFrames);
+      int64_t frameTime = GetTimer();
+      pagPlayer->flush();
+      totalTime += GetTimer() - frameTime;
+      totalSnapshots += pagPlayer->cacheUsage().snapshots;
+    }
+    std::cout << "\n" << fileName << " frameTime: " << totalTime / totalFrames
+              << " snapshotMemory: " << totalSnapshots / totalFrames << std::endl;
+  }
+}
+
+/**
+ * 用例描述: 缩放动画下不同 PAGSnapshotScaleMode 的栅格化次数和 flush 耗时
+ */
+PAG_TEST(PerformanceTest, SnapshotScaleMode) {
+  std::vector<std::string> files;
+  GetAllPAGFiles("../resources/smoke", files);
+  std::vector<PAGSnapshotScaleMode> modes = {PAGSnapshotScaleMode::Exact,
+                                             PAGSnapshotScaleMode::Bucketed,
+                                             PAGSnapshotScaleMode::BucketedWithDownscale};
+  for (auto& file : files) {
+    auto fileName = file.substr(file.rfind('/') + 1, file.size());
+    std::cout << "\n" << fileName;
+    size_t exactCount = 0;
+    for (auto mode : modes) {
+      auto pagFile = PAGFile::Load(file);
+      ASSERT_NE(pagFile, nullptr);
+      auto pagSurface = PAGSurface::MakeOffscreen(pagFile->width(), pagFile->height());
+      ASSERT_NE(pagSurface, nullptr);
+      auto pagPlayer = std::make_shared<PAGPlayer>();
+      pagPlayer->setSnapshotScaleMode(mode);
+      pagPlayer->setSurface(pagSurface);
+      pagPlayer->setComposition(pagFile);
+      int64_t totalTime = 0;
+      // Zooms between 25% and 100% twice on the first frame.
+      int totalFrames = 120;
+      for (int i = 0; i < totalFrames; i++) {
+        auto progress = static_cast<float>(i % 60) / 30.0f;
+        auto scale = 0.25f + 0.75f * (progress > 1.0f ? 2.0f - progress : progress);
+        pagPlayer->setMatrix(Matrix::MakeScale(scale));
+        int64_t frameTime = GetTimer();
+        pagPlayer->flush();
+        totalTime += GetTimer() - frameTime;
+      }
+      auto rasterizingCount = pagPlayer->renderCache->snapshotRasterizingCount();
+      if (mode == PAGSnapshotScaleMode::Exact) {
+        exactCount = rasterizingCount;
+      } else {
+        EXPECT_LE(rasterizingCount, exactCount);
+      }
+      std::cout << " mode: " << static_cast<int>(mode) << " frameTime: " << totalTime / totalFrames
+                << " rasterizingCount: " << rasterizingCount;
+    }
+    std::cout << std::endl;
+  }
+}
+
+/**
+ * 用例描述: 视频序列帧随机跳帧、倒放和往返播放的解码耗时
+ */
+PAG_TEST(PerformanceTest, VideoSeeking) {
+  auto pagFile = PAGFile::Load("../resources/apitest/wz_mvp.pag");
+  ASSERT_NE(pagFile, nullptr);
+  auto file = pagFile->getFile();
+  VideoSequence* sequence = nullptr;
+  for (auto composition : file->compositions) {
+    if (composition->type() == CompositionType::Video) {
+      sequence = static_cast<VideoComposition*>(composition)->sequences.front();
+      break;
+    }
+  }
+  ASSERT_NE(sequence, nullptr);
+  auto totalFrames = sequence->duration();
+  std::vector<Frame> randomFrames = {};
+  std::vector<Frame> backwardFrames = {};
+  std::vector<Frame> pingPongFrames = {};
+  srand(0);
+  for (Frame i = 0; i < totalFrames; i++) {
+    randomFrames.push_back(rand() % totalFrames);
+    backwardFrames.push_back(totalFrames - 1 - i);
+    // Steps forward and backward between the middle 3 frames.
+    pingPongFrames.push_back(totalFrames / 2 + (i % 4 == 3 ? 1 : i % 4) - 1);
+  }
+  std::vector<std::pair<std::string, std::vector<Frame>>> cases = {
+      {"random", randomFrames}, {"backward", backwardFrames}, {"pingPong", pingPongFrames}};
+  for (auto& item : cases) {
+    auto frameCount = static_cast<int64_t>(item.second.size());
+    std::cout << "\n" << item.first;
+    // Runs every case without and then with the copies of the recently decoded frames.
+    for (auto recentFramesSupported : {false, true}) {
+      auto demuxer = std::make_unique<VideoSequenceDemuxer>(file, sequence);
+      VideoReader reader(std::move(demuxer));
+      reader.recentFramesSupported = recentFramesSupported;
+      int64_t totalTime = 0;
+      for (auto frame : item.second) {
+        int64_t frameTime = GetTimer();
+        ASSERT_TRUE(reader.decodeFrame(frame));
+        totalTime += GetTimer() - frameTime;
+      }
+      std::cout << (recentFramesSupported ? " cached: " : " uncached: ") << totalTime / frameCount;
+      if (!reader.recentFramesSupported) {
+        // The hardware decoded frames can not be copied.
+        continue;
+      }
+      std::cout << " hits: " << reader.recentFrameHits;
+      if (item.first == "pingPong") {
+        // Only the first two loops over the three frames need decoding.
+        EXPECT_GT(reader.recentFrameHits * 2, static_cast<size_t>(frameCount));
+      }
+    }
+  }
+  std::cout << std::endl;
+}
+
+/**
+ * 用例描述: 不同线程数下软解码视频序列帧的吞吐量
+ */
+PAG_TEST(PerformanceTest, VideoDecodingThroughput) {
+  std::vector<std::string> files;
+  GetAllPAGFiles("../resources/apitest", files);
+  for (auto& file : files) {
+    auto pagFile = PAGFile::Load(file);
+    if (pagFile == nullptr) {
+      continue;
+    }
+    auto pagFileData = pagFile->getFile();
+    for (auto composition : pagFileData->compositions) {
+      if (composition->type() != CompositionType::Video) {
+        continue;
+      }
+      auto sequence = static_cast<VideoComposition*>(composition)->sequences.back();
+      auto fileName = file.substr(file.rfind('/') + 1, file.size());
+      std::cout << "\n" << fileName << " " << sequence->getVideoWidth() << "x"
+                << sequence->getVideoHeight();
+      for (int threadCount = 1; threadCount <= 3; threadCount++) {
+        PAGVideoDecoder::SetSoftwareDecoderThreadCount(threadCount);
+        auto demuxer = std::make_unique<VideoSequenceDemuxer>(pagFileData, sequence);
+        VideoReader reader(std::move(demuxer));
+        auto totalFrames = sequence->duration();
+        int64_t totalTime = GetTimer();
+        for (Frame frame = 0; frame < totalFrames; frame++) {
+          ASSERT_TRUE(reader.decodeFrame(frame));
+        }
+        totalTime = GetTimer() - totalTime;
+        std::cout << " threads: " << threadCount
+                  << " fps: " << totalFrames * 1000000.0 / std::max(totalTime, int64_t(1));
+      }
+    }
+  }
+  PAGVideoDecoder::SetSoftwareDecoderThreadCount(1);
+  std::cout << std::endl;
+}
+
+static double PeakResidentMemoryInMB() {
+  rusage usage = {};
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return static_cast<double>(usage.ru_maxrss) / 1048576.0;
+#else
+  return static_cast<double>(usage.ru_maxrss) / 1024.0;
+#endif
+}
+
+/**
+ * 用例描述: 测试内存映射方式加载 PAG 文件的耗时和内存峰值
+ */
+PAG_TEST(PerformanceTest, MemoryMappedLoading) {
+  std::vector<std::string> files;
+  GetAllPAGFiles("../resources", files);
+  // The peak resident memory never drops, so the memory-mapped loading is measured first, and the
+  // growth measured for reading is a lower bound.
+  for (auto memoryMapped : {true, false}) {
+    File::SetMemoryMapEnabled(memoryMapped);
+    auto startMemory = PeakResidentMemoryInMB();
+    int64_t totalTime = 0;
+    for (auto& file : files) {
+      int64_t startTime = GetTimer();
+      auto pagFile = File::Load(file);
+      totalTime += GetTimer() - startTime;
+    }
+    std::cout << (memoryMapped ? "memory-mapped" : "read") << " files: " << files.size()
+              << " load time: " << static_cast<double>(totalTime) / 1000.0
+              << "ms peak memory growth: " << PeakResidentMemoryInMB() - startMemory << "MB"
+              << std::endl;
+  }
+  File::SetMemoryMapEnabled(false);
+}
+
+/**
+ * 用例描述: 测试 LZ4 压缩的 PAG 文件体积和解码耗时
+ */
+PAG_TEST(PerformanceTest, CompressedDecoding) {
+  std::vector<std::string> files;
+  GetAllPAGFiles("../resources", files);
+  size_t totalSize = 0;
+  size_t totalCompressedSize = 0;
+  int64_t totalTime = 0;
+  int64_t totalCompressedTime = 0;
+  for (auto& path : files) {
+    auto file = File::Load(path);
+    if (file == nullptr) {
+      continue;
+    }
+    auto bytes = Codec::Encode(file, nullptr, false);
+    auto compressedBytes = Codec::Encode(file, nullptr, true);
+    ASSERT_TRUE(bytes != nullptr && compressedBytes != nullptr);
+    totalSize += bytes->length();
+    totalCompressedSize += compressedBytes->length();
+    for (int i = 0; i < 10; i++) {
+      int64_t startTime = GetTimer();
+      auto result = Codec::Decode(bytes->data(), static_cast<uint32_t>(bytes->length()), "");
+      totalTime += GetTimer() - startTime;
+      ASSERT_TRUE(result != nullptr);
+      startTime = GetTimer();
+      result = Codec::Decode(compressedBytes->data(),
+                             static_cast<uint32_t>(compressedBytes->length()), "");
+      totalCompressedTime += GetTimer() - startTime;
+      ASSERT_TRUE(result != nullptr);
+    }
+  }
+  std::cout << "uncompressed size: " << totalSize / 1024 << "KB decode time: "
+            << static_cast<double>(totalTime) / 10000.0 << "ms" << std::endl;
+  std::cout << "compressed size: " << totalCompressedSize / 1024 << "KB decode time: "
+            << static_cast<double>(totalCompressedTime) / 10000.0 << "ms ratio: "
+            << static_cast<double>(totalCompressedSize) / std::max(totalSize, size_t(1))
+            << std::endl;
+}
+
+/**
+ * 用例描述: 测试 DecodeStream 基础读取接口和整个文件解码的耗时
+ */
+PAG_TEST(PerformanceTest, DecodeStreamPrimitives) {
+  static const uint32_t ListSize = 1000;
+  static const int ListCount = 1000;
+  StreamContext context = {};
+  EncodeStream encodeStream(&context);
+  std::vector<int32_t> intList(ListSize);
+  std::vector<float> floatList(ListSize);
+  for (uint32_t i = 0; i < ListSize; i++) {
+    intList[i] = static_cast<int32_t>(i * 7919 % 4096) - 2048;
+    floatList[i] = static_cast<float>(intList[i]) * 0.01f;
+  }
+  for (int i = 0; i < ListCount; i++) {
+    encodeStream.writeInt32List(intList.data(), ListSize);
+    encodeStream.writeFloatList(floatList.data(), ListSize, 0.01f);
+    for (uint32_t j = 0; j < ListSize; j++) {
+      encodeStream.writeBits(intList[j], 13);
+    }
+    encodeStream.alignWithBytes();
+    for (uint32_t j = 0; j < ListSize; j++) {
+      encodeStream.writeEncodedInt32(intList[j]);
+    }
+  }
+  auto bytes = encodeStream.release();
+  DecodeStream stream(&context, bytes->data(), static_cast<uint32_t>(bytes->length()));
+  int64_t listTime = 0;
+  int64_t floatListTime = 0;
+  int64_t bitsTime = 0;
+  int64_t encodedTime = 0;
+  for (int i = 0; i < ListCount; i++) {
+    auto startTime = GetTimer();
+    stream.readInt32List(intList.data(), ListSize);
+    listTime += GetTimer() - startTime;
+    startTime = GetTimer();
+    stream.readFloatList(floatList.data(), ListSize, 0.01f);
+    floatListTime += GetTimer() - startTime;
+    startTime = GetTimer();
+    for (uint32_t j = 0; j < ListSize; j++) {
+      intList[j] = stream.readBits(13);
+    }
+    bitsTime += GetTimer() - startTime;
+    stream.alignWithBytes();
+    startTime = GetTimer();
+    for (uint32_t j = 0; j < ListSize; j++) {
+      intList[j] = stream.readEncodedInt32();
+    }
+    encodedTime += GetTimer() - startTime;
+  }
+  ASSERT_FALSE(context.hasException());
+  std::cout << "values: " << ListSize * ListCount << " readInt32List: " << listTime / 1000.0
+            << "ms readFloatList: " << floatListTime / 1000.0 << "ms readBits: " << bitsTime / 1000.0
+            << "ms readEncodedInt32: " << encodedTime / 1000.0 << "ms" << std::endl;
+
+  std::vector<std::string> files;
+  GetAllPAGFiles("../resources", files);
+  int64_t decodingTime = 0;
+  for (auto& path : files) {
+    auto data = ByteData::FromPath(path);
+    if (data == nullptr) {
+      continue;
+    }
+    auto startTime = GetTimer();
+    for (int i = 0; i < 10; i++) {
+      Codec::Decode(data->data(), static_cast<uint32_t>(data->length()), path);
+    }
+    decodingTime += GetTimer() - startTime;
+  }
+  std::cout << "files: " << files.size() << " decode time: " << decodingTime / 10000.0 << "ms"
+            << std::endl;
+}
 }  // namespace pag
 #endif
\ No newline at end of file
@@ -16,9 +16,17 @@
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include "base/utils/TGFXCast.h"
+#include "base/utils/TimeUtil.h"
+#include "base/utils/UniqueID.h"
 #include "framework/pag_test.h"
 #include "framework/utils/PAGTestUtils.h"
 #include "nlohmann/json.hpp"
+#include "rendering/caches/FrameCache.h"
+#include "rendering/caches/RenderCache.h"
+#include "rendering/layers/PAGStage.h"
+#include "tgfx/gpu/opengl/GLDevice.h"
+#include "tgfx/gpu/opengl/GLFunctions.h"
 
 namespace pag {
 using nlohmann::json;
@@ -129,4 +137,223 @@ PAG_TEST_F(PAGPlayerTest, autoClear) {
   EXPECT_TRUE(Baseline::Compare(pagSurface, "PAGPlayerTest/autoClear_autoClear_true"));
 }
 
+/**
+ * 用例描述: PAGPlayer 缓存预算，预算为 0 的类别不产生缓存
+ */
+PAG_TEST_F(PAGPlayerTest, cacheBudget) {
+  auto pagFile = PAGFile::Load(TestConstants::DEFAULT_PAG_PATH);
+  ASSERT_NE(pagFile, nullptr);
+  auto pagSurface = PAGSurface::MakeOffscreen(pagFile->width(), pagFile->height());
+  auto pagPlayer = std::make_unique<PAGPlayer>();
+  pagPlayer->setSurface(pagSurface);
+  pagPlayer->setComposition(pagFile);
+  auto budget = pagPlayer->cacheBudget();
+  EXPECT_EQ(budget.snapshots, static_cast<size_t>(314572800));
+  EXPECT_EQ(budget.textAtlases, SIZE_MAX);
+  budget.snapshots = 0;
+  budget.textAtlases = 0;
+  budget.filterBuffers = 0;
+  pagPlayer->setCacheBudget(budget);
+  EXPECT_EQ(pagPlayer->cacheBudget().snapshots, static_cast<size_t>(0));
+  for (int i = 0; i < 10; i++) {
+    pagPlayer->setProgress(i * 0.1);
+    ASSERT_TRUE(pagPlayer->flush());
+  }
+  auto usage = pagPlayer->cacheUsage();
+  EXPECT_EQ(usage.snapshots, static_cast<size_t>(0));
+  EXPECT_EQ(usage.textAtlases, static_cast<size_t>(0));
+  EXPECT_EQ(usage.filterBuffers, static_cast<size_t>(0));
+  EXPECT_EQ(pagPlayer->renderCache->memoryUsage(), static_cast<size_t>(0));
+}
+
+/**
+ * 用例描述: 预解码的提前量随素材测得的解码和上传耗时增长
+ */
+PAG_TEST_F(PAGPlayerTest, prefetchHorizon) {
+  auto pagFile = PAGFile::Load(TestConstants::DEFAULT_PAG_PATH);
+  ASSERT_NE(pagFile, nullptr);
+  auto pagSurface = PAGSurface::MakeOffscreen(pagFile->width(), pagFile->height());
+  auto pagPlayer = std::make_unique<PAGPlayer>();
+  pagPlayer->setSurface(pagSurface);
+  pagPlayer->setComposition(pagFile);
+  EXPECT_EQ(pagPlayer->cacheBudget().prefetchMemory, static_cast<size_t>(67108864));
+  for (int i = 0; i < 10; i++) {
+    pagPlayer->nextFrame();
+    ASSERT_TRUE(pagPlayer->flush());
+    for (auto& item : pagPlayer->prefetchHorizons()) {
+      EXPECT_LE(item.second, MAX_DECODING_VISIBLE_DISTANCE);
+    }
+  }
+  auto renderCache = pagPlayer->renderCache;
+  auto assetID = UniqueID::Next();
+  EXPECT_EQ(renderCache->prefetchHorizon(assetID), DECODING_VISIBLE_DISTANCE);
+  renderCache->recordDecodingCost(assetID, 1000, 1);
+  renderCache->updateDecodingCosts();
+  auto cheapHorizon = renderCache->prefetchHorizon(assetID);
+  EXPECT_LT(cheapHorizon, DECODING_VISIBLE_DISTANCE);
+  // The frames decoded ahead in one batch are averaged rather than summed.
+  renderCache->recordDecodingCost(assetID, 4000, 4);
+  renderCache->updateDecodingCosts();
+  EXPECT_EQ(renderCache->decodingCosts[assetID].perFrame, 1000);
+  renderCache->recordDecodingCost(assetID, 400000, 1);
+  renderCache->updateDecodingCosts();
+  auto heavyHorizon = renderCache->prefetchHorizon(assetID);
+  EXPECT_GT(heavyHorizon, cheapHorizon);
+  EXPECT_LE(heavyHorizon, MAX_DECODING_VISIBLE_DISTANCE);
+  // The cost is dropped together with the sequence readers of the asset.
+  renderCache->clearSequenceCache(assetID);
+  EXPECT_EQ(renderCache->decodingCosts.count(assetID), 0u);
+  EXPECT_EQ(renderCache->prefetchHorizon(assetID), DECODING_VISIBLE_DISTANCE);
+}
+
+/**
+ * Restores the frame cache budget when the test ends, even if an assertion fails.
+ */
+class FrameCacheBudgetGuard {
+ public:
+  FrameCacheBudgetGuard() : budget(PAGPlayer::FrameCacheBudget()) {
+  }
+
+  ~FrameCacheBudgetGuard() {
+    PAGPlayer::SetFrameCacheBudget(budget);
+  }
+
+ private:
+  size_t budget = 0;
+};
+
+static std::shared_ptr<PAGFile> LoadUncachedFile(const std::string& filePath) {
+  // Files loaded from bytes without a path are not shared, so their frame caches start empty.
+  auto byteData = ByteData::FromPath(filePath);
+  if (byteData == nullptr) {
+    return nullptr;
+  }
+  return PAGFile::Load(byteData->data(), byteData->length());
+}
+
+/**
+ * 用例描述: 逐帧缓存超出内存上限时只保留播放位置附近的帧
+ */
+PAG_TEST_F(PAGPlayerTest, frameCacheBudget) {
+  EXPECT_EQ(PAGPlayer::FrameCacheBudget(), static_cast<size_t>(67108864));
+  FrameCacheBudgetGuard budgetGuard = {};
+  size_t fullMemory = 0;
+  {
+    auto pagFile = LoadUncachedFile(TestConstants::DEFAULT_PAG_PATH);
+    ASSERT_NE(pagFile, nullptr);
+    auto pagSurface = PAGSurface::MakeOffscreen(pagFile->width(), pagFile->height());
+    auto pagPlayer = std::make_unique<PAGPlayer>();
+    pagPlayer->setSurface(pagSurface);
+    pagPlayer->setComposition(pagFile);
+    auto totalFrames = TimeToFrame(pagFile->duration(), pagFile->frameRate());
+    for (Frame i = 0; i < totalFrames; i++) {
+      pagPlayer->setProgress((i + 0.1) * 1.0 / totalFrames);
+      ASSERT_TRUE(pagPlayer->flush());
+    }
+    fullMemory = pagPlayer->stage->frameCacheMemory();
+    ASSERT_GT(fullMemory, static_cast<size_t>(0));
+  }
+
+  // Replays a fresh copy of the file with half of the memory it needs.
+  auto budget = fullMemory / 2;
+  PAGPlayer::SetFrameCacheBudget(budget);
+  auto pagFile = LoadUncachedFile(TestConstants::DEFAULT_PAG_PATH);
+  ASSERT_NE(pagFile, nullptr);
+  auto pagSurface = PAGSurface::MakeOffscreen(pagFile->width(), pagFile->height());
+  auto pagPlayer = std::make_unique<PAGPlayer>();
+  pagPlayer->setSurface(pagSurface);
+  pagPlayer->setComposition(pagFile);
+  auto totalFrames = TimeToFrame(pagFile->duration(), pagFile->frameRate());
+  for (Frame i = 0; i < totalFrames; i++) {
+    pagPlayer->setProgress((i + 0.1) * 1.0 / totalFrames);
+    ASSERT_TRUE(pagPlayer->flush());
+    // The released frames are deleted once the flush returns.
+    EXPECT_LE(pagPlayer->stage->frameCacheMemory(), budget);
+    EXPECT_EQ(FrameCacheBudget::RetiredMemory(), static_cast<size_t>(0));
+  }
+  auto frameCacheMemory = pagPlayer->stage->frameCacheMemory();
+  EXPECT_GT(frameCacheMemory, static_cast<size_t>(0));
+  EXPECT_LT(frameCacheMemory, fullMemory);
+  EXPECT_EQ(pagPlayer->graphicsMemory(),
+            static_cast<int64_t>(pagPlayer->renderCache->memoryUsage() + frameCacheMemory));
+
+  // Going back to the start makes the released frames again.
+  pagPlayer->setProgress(0);
+  ASSERT_TRUE(pagPlayer->flush());
+  EXPECT_LE(pagPlayer->stage->frameCacheMemory(), budget);
+}
+
+/**
+ * 用例描述: 同一设备上的多个 PAGPlayer 共享缓存时复用彼此的快照，渲染结果一致
+ */
+PAG_TEST_F(PAGPlayerTest, sharedCache) {
+  EXPECT_EQ(PAGPlayer::SharedCacheBudget(), static_cast<size_t>(67108864));
+  auto pagFile1 = PAGFile::Load(TestConstants::DEFAULT_PAG_PATH);
+  ASSERT_NE(pagFile1, nullptr);
+  auto pagFile2 = PAGFile::Load(TestConstants::DEFAULT_PAG_PATH);
+  auto width = pagFile1->width();
+  auto height = pagFile1->height();
+  // Both surfaces render on the same device, which owns the shared cache.
+  auto device = GLDevice::Make();
+  ASSERT_TRUE(device != nullptr);
+  auto context = device->lockContext();
+  ASSERT_TRUE(context != nullptr);
+  GLSampler textureInfo1 = {};
+  GLSampler textureInfo2 = {};
+  ASSERT_TRUE(CreateGLTexture(context, width, height, &textureInfo1));
+  ASSERT_TRUE(CreateGLTexture(context, width, height, &textureInfo2));
+  auto pagSurface1 = PAGSurface::MakeFrom(ToBackendTexture(textureInfo1, width, height),
+                                          ImageOrigin::TopLeft);
+  auto pagSurface2 = PAGSurface::MakeFrom(ToBackendTexture(textureInfo2, width, height),
+                                          ImageOrigin::TopLeft);
+  device->unlock();
+  ASSERT_NE(pagSurface1, nullptr);
+  ASSERT_NE(pagSurface2, nullptr);
+  auto pagPlayer1 = std::make_unique<PAGPlayer>();
+  pagPlayer1->setSharedCacheEnabled(true);
+  pagPlayer1->setSurface(pagSurface1);
+  pagPlayer1->setComposition(pagFile1);
+  auto pagPlayer2 = std::make_unique<PAGPlayer>();
+  pagPlayer2->setSharedCacheEnabled(true);
+  pagPlayer2->setSurface(pagSurface2);
+  pagPlayer2->setComposition(pagFile2);
+  ASSERT_TRUE(pagPlayer2->sharedCacheEnabled());
+
+  pagPlayer1->setProgress(0.5);
+  pagPlayer2->setProgress(0.5);
+  ASSERT_TRUE(pagPlayer1->flush());
+  ASSERT_TRUE(pagPlayer2->flush());
+  auto renderCache1 = pagPlayer1->renderCache;
+  auto renderCache2 = pagPlayer2->renderCache;
+  ASSERT_TRUE(renderCache1->sharedCache != nullptr);
+  EXPECT_EQ(renderCache1->sharedCache, renderCache2->sharedCache);
+  // The second player reuses every snapshot and text atlas made by the first one.
+  EXPECT_GT(renderCache1->snapshotRasterizingCount(), static_cast<size_t>(0));
+  EXPECT_EQ(renderCache2->snapshotRasterizingCount(), static_cast<size_t>(0));
+  EXPECT_EQ(renderCache1->sharedCache->entries.size(),
+            renderCache1->snapshotCaches.size() + renderCache1->textAtlases.size());
+  EXPECT_EQ(renderCache2->snapshotCaches.size(), renderCache1->snapshotCaches.size());
+  EXPECT_EQ(renderCache2->textAtlases.size(), renderCache1->textAtlases.size());
+
+  auto rowBytes = static_cast<size_t>(width) * 4;
+  std::vector<uint8_t> pixels1(rowBytes * height);
+  std::vector<uint8_t> pixels2(rowBytes * height);
+  ASSERT_TRUE(pagSurface1->readPixels(ColorType::RGBA_8888, AlphaType::Premultiplied,
+                                      pixels1.data(), rowBytes));
+  ASSERT_TRUE(pagSurface2->readPixels(ColorType::RGBA_8888, AlphaType::Premultiplied,
+                                      pixels2.data(), rowBytes));
+  EXPECT_TRUE(pixels1 == pixels2);
+
+  pagPlayer1 = nullptr;
+  pagPlayer2 = nullptr;
+  pagSurface1 = nullptr;
+  pagSurface2 = nullptr;
+  context = device->lockContext();
+  ASSERT_TRUE(context != nullptr);
+  auto gl = GLFunctions::Get(context);
+  gl->deleteTextures(1, &textureInfo1.id);
+  gl->deleteTextures(1, &textureInfo2.id);
+  device->unlock();
+}
+
 }  // namespace pag
\ No newline at end of file
@@ -17,13 +17,18 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include <vector>
+#include "base/utils/TimeUtil.h"
 #include "framework/pag_test.h"
 #include "framework/utils/PAGTestUtils.h"
 #include "gpu/opengl/GLUtil.h"
+#include "rendering/utils/YUVConverter.h"
 #include "tgfx/core/Bitmap.h"
 #include "tgfx/core/Buffer.h"
+#include "tgfx/core/Clock.h"
 #include "tgfx/core/ImageCodec.h"
 #include "tgfx/gpu/Surface.h"
+#include "tgfx/gpu/UploadBuffer.h"
+#include "tgfx/gpu/YUVTexture.h"
 #include "tgfx/gpu/opengl/GLDevice.h"
 #include "tgfx/gpu/opengl/GLTexture.h"
 
@@ -254,6 +259,270 @@ PAG_TEST(PAGReadPixelsTest, TestSurfaceReadPixels) {
   device->unlock();
 }
 
+/**
+ * 用例描述: 异步读取像素的结果与同步读取一致，并对比两者的导出帧率
+ */
+PAG_TEST(PAGReadPixelsTest, ReadPixelsAsync) {
+  auto pagFile = PAGFile::Load("../resources/apitest/test.pag");
+  ASSERT_TRUE(pagFile != nullptr);
+  auto width = pagFile->width();
+  auto height = pagFile->height();
+  auto pagSurface = PAGSurface::MakeOffscreen(width, height);
+  ASSERT_TRUE(pagSurface != nullptr);
+  auto pagPlayer = std::make_shared<PAGPlayer>();
+  pagPlayer->setSurface(pagSurface);
+  pagPlayer->setComposition(pagFile);
+  auto totalFrames = TimeToFrame(pagFile->duration(), pagFile->frameRate());
+  auto rowBytes = static_cast<size_t>(width) * 4;
+  auto byteSize = rowBytes * static_cast<size_t>(height);
+
+  std::vector<std::vector<uint8_t>> syncFrames = {};
+  Clock clock = {};
+  for (Frame frame = 0; frame < totalFrames; frame++) {
+    pagPlayer->setProgress(FrameToProgress(frame, totalFrames));
+    pagPlayer->flush();
+    std::vector<uint8_t> pixels(byteSize);
+    auto result = pagSurface->readPixels(pag::ColorType::RGBA_8888, pag::AlphaType::Premultiplied,
+                                         pixels.data(), rowBytes);
+    ASSERT_TRUE(result);
+    syncFrames.push_back(std::move(pixels));
+  }
+  auto syncCost = clock.measure();
+
+  // The async path copies the pixels out just like the sync path does, and the cost of waiting for
+  // the last reads to complete is included, so that both paths do the same amount of work.
+  std::vector<std::vector<uint8_t>> asyncFrames = {};
+  clock.reset();
+  for (Frame frame = 0; frame < totalFrames; frame++) {
+    pagPlayer->setProgress(FrameToProgress(frame, totalFrames));
+    pagPlayer->flush();
+    auto result = pagSurface->readPixelsAsync(
+        pag::ColorType::RGBA_8888, pag::AlphaType::Premultiplied,
+        [&](const void* pixels, size_t pixelRowBytes) {
+          ASSERT_TRUE(pixels != nullptr);
+          EXPECT_EQ(pixelRowBytes, rowBytes);
+          auto data = static_cast<const uint8_t*>(pixels);
+          asyncFrames.emplace_back(data, data + byteSize);
+        });
+    ASSERT_TRUE(result);
+  }
+  pagSurface->finishPixelReads();
+  auto asyncCost = clock.measure();
+  ASSERT_EQ(asyncFrames.size(), syncFrames.size());
+  for (size_t i = 0; i < syncFrames.size(); i++) {
+    EXPECT_EQ(memcmp(syncFrames[i].data(), asyncFrames[i].data(), byteSize), 0);
+  }
+  LOGI("PAGReadPixelsTest.ReadPixelsAsync: sync %.1f fps, async %.1f fps",
+       static_cast<double>(totalFrames) * 1000000 / static_cast<double>(syncCost),
+       static_cast<double>(totalFrames) * 1000000 / static_cast<double>(asyncCost));
+}
+
+/**
+ * Returns the max difference between the chroma planes and the BT.601 limited range values
+ * computed on the CPU from the RGBA pixels. The blocks that are not fully opaque are skipped,
+ * since their chroma depends on whether the pixels are averaged before or after premultiplying.
+ */
+static int MaxChromaDiff(const std::vector<uint8_t>& rgba, int width, int height,
+                         const uint8_t* uPlane, const uint8_t* vPlane, size_t chromaRowBytes,
+                         size_t chromaStep) {
+  auto rowBytes = static_cast<size_t>(width) * 4;
+  int maxDiff = 0;
+  for (int y = 0; y < height / 2; y++) {
+    for (int x = 0; x < width / 2; x++) {
+      float rgb[3] = {0, 0, 0};
+      bool opaque = true;
+      for (int dy = 0; dy < 2; dy++) {
+        for (int dx = 0; dx < 2; dx++) {
+          auto pixel =
+              rgba.data() + static_cast<size_t>(2 * y + dy) * rowBytes + (2 * x + dx) * 4;
+          opaque = opaque && pixel[3] == 255;
+          rgb[0] += pixel[0] / (4 * 255.0f);
+          rgb[1] += pixel[1] / (4 * 255.0f);
+          rgb[2] += pixel[2] / (4 * 255.0f);
+        }
+      }
+      if (!opaque) {
+        continue;
+      }
+      auto expectedU = 128.0f - 37.797f * rgb[0] - 74.203f * rgb[1] + 112.0f * rgb[2];
+      auto expectedV = 128.0f + 112.0f * rgb[0] - 93.786f * rgb[1] - 18.214f * rgb[2];
+      auto offset = static_cast<size_t>(y) * chromaRowBytes + x * chromaStep;
+      maxDiff = std::max(maxDiff, static_cast<int>(fabsf(uPlane[offset] - expectedU)));
+      maxDiff = std::max(maxDiff, static_cast<int>(fabsf(vPlane[offset] - expectedV)));
+    }
+  }
+  return maxDiff;
+}
+
+/**
+ * 用例描述: 在 GPU 上将 RGBA 转换为 I420 和 NV12
+ */
+PAG_TEST(PAGReadPixelsTest, ReadYUVPixels) {
+  auto pagFile = PAGFile::Load("../resources/apitest/test.pag");
+  ASSERT_TRUE(pagFile != nullptr);
+  auto width = pagFile->width();
+  auto height = pagFile->height();
+  auto pagSurface = PAGSurface::MakeOffscreen(width, height);
+  ASSERT_TRUE(pagSurface != nullptr);
+  auto pagPlayer = std::make_shared<PAGPlayer>();
+  pagPlayer->setSurface(pagSurface);
+  pagPlayer->setComposition(pagFile);
+  pagPlayer->setProgress(0.5);
+  pagPlayer->flush();
+
+  auto rowBytes = static_cast<size_t>(width) * 4;
+  std::vector<uint8_t> rgba(rowBytes * static_cast<size_t>(height));
+  auto result = pagSurface->readPixels(pag::ColorType::RGBA_8888, pag::AlphaType::Unpremultiplied,
+                                       rgba.data(), rowBytes);
+  ASSERT_TRUE(result);
+
+  auto chromaWidth = static_cast<size_t>((width + 1) / 2);
+  auto chromaHeight = static_cast<size_t>((height + 1) / 2);
+  std::vector<uint8_t> yPlane(static_cast<size_t>(width) * static_cast<size_t>(height));
+  std::vector<uint8_t> uPlane(chromaWidth * chromaHeight);
+  std::vector<uint8_t> vPlane(chromaWidth * chromaHeight);
+  uint8_t* i420Planes[] = {yPlane.data(), uPlane.data(), vPlane.data()};
+  size_t i420RowBytes[] = {static_cast<size_t>(width), chromaWidth, chromaWidth};
+  result = pagSurface->readYUVPixels(YUVFormat::I420, YUVColorSpace::Rec601, YUVColorRange::MPEG,
+                                     i420Planes, i420RowBytes);
+  ASSERT_TRUE(result);
+  // BT.601 limited range, computed on the CPU from the RGBA pixels.
+  int maxDiff = 0;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      auto pixel = rgba.data() + static_cast<size_t>(y) * rowBytes + x * 4;
+      auto expected = 16.0f + 65.481f * pixel[0] / 255.0f + 128.553f * pixel[1] / 255.0f +
+                      24.966f * pixel[2] / 255.0f;
+      auto actual = yPlane[static_cast<size_t>(y) * static_cast<size_t>(width) + x];
+      maxDiff = std::max(maxDiff, static_cast<int>(fabsf(actual - expected)));
+    }
+  }
+  EXPECT_LE(maxDiff, 2);
+  EXPECT_LE(MaxChromaDiff(rgba, width, height, uPlane.data(), vPlane.data(), chromaWidth, 1), 3);
+
+  std::vector<uint8_t> nv12Y(yPlane.size());
+  std::vector<uint8_t> uvPlane(chromaWidth * chromaHeight * 2);
+  uint8_t* nv12Planes[] = {nv12Y.data(), uvPlane.data()};
+  size_t nv12RowBytes[] = {static_cast<size_t>(width), chromaWidth * 2};
+  result = pagSurface->readYUVPixels(YUVFormat::NV12, YUVColorSpace::Rec601, YUVColorRange::MPEG,
+                                     nv12Planes, nv12RowBytes);
+  ASSERT_TRUE(result);
+  EXPECT_TRUE(nv12Y == yPlane);
+  for (size_t i = 0; i < uPlane.size(); i++) {
+    ASSERT_EQ(uvPlane[2 * i], uPlane[i]);
+    ASSERT_EQ(uvPlane[2 * i + 1], vPlane[i]);
+  }
+  EXPECT_LE(
+      MaxChromaDiff(rgba, width, height, uvPlane.data(), uvPlane.data() + 1, chromaWidth * 2, 2),
+      3);
+
+  // The CPU fallback must produce the same planes as the GPU path.
+  std::vector<uint8_t> cpuY(yPlane.size());
+  std::vector<uint8_t> cpuU(uPlane.size());
+  std::vector<uint8_t> cpuV(vPlane.size());
+  uint8_t* cpuPlanes[] = {cpuY.data(), cpuU.data(), cpuV.data()};
+  ASSERT_TRUE(pagSurface->lockContext() != nullptr);
+  result = YUVConverter::ReadPixelsOnCPU(pagSurface->surface.get(), YUVFormat::I420,
+                                         YUVColorSpace::Rec601, YUVColorRange::MPEG, cpuPlanes,
+                                         i420RowBytes);
+  pagSurface->unlockContext();
+  ASSERT_TRUE(result);
+  maxDiff = 0;
+  for (size_t i = 0; i < yPlane.size(); i++) {
+    maxDiff = std::max(maxDiff, std::abs(cpuY[i] - yPlane[i]));
+  }
+  EXPECT_LE(maxDiff, 2);
+  EXPECT_LE(MaxChromaDiff(rgba, width, height, cpuU.data(), cpuV.data(), chromaWidth, 1), 1);
+
+  result = pagSurface->readYUVPixels(YUVFormat::I420, YUVColorSpace::Rec709, YUVColorRange::JPEG,
+                                     i420Planes, i420RowBytes);
+  ASSERT_TRUE(result);
+  auto pixel = rgba.data();
+  auto expected = 0.2126f * pixel[0] + 0.7152f * pixel[1] + 0.0722f * pixel[2];
+  EXPECT_LE(fabsf(yPlane[0] - expected), 2.0f);
+}
+
+static std::vector<uint8_t> DrawAndReadPixels(Context* context, std::shared_ptr<Texture> texture) {
+  auto surface = Surface::Make(context, texture->width(), texture->height());
+  if (surface == nullptr) {
+    return {};
+  }
+  surface->getCanvas()->drawTexture(texture);
+  auto info = ImageInfo::Make(texture->width(), texture->height(), tgfx::ColorType::RGBA_8888,
+                              tgfx::AlphaType::Premultiplied);
+  std::vector<uint8_t> pixels(info.byteSize());
+  if (!surface->readPixels(info, pixels.data())) {
+    return {};
+  }
+  return pixels;
+}
+
+/**
+ * 用例描述: 通过 UploadBuffer 上传 RGBA 和 I420 像素，读回的结果与直接上传一致
+ */
+PAG_TEST(PAGReadPixelsTest, UploadBuffer) {
+  auto device = GLDevice::Make();
+  ASSERT_TRUE(device != nullptr);
+  auto context = device->lockContext();
+  ASSERT_TRUE(context != nullptr);
+  int width = 64;
+  int height = 32;
+  auto rowBytes = static_cast<size_t>(width) * 4;
+  auto uploadBuffer = UploadBuffer::Make(context, rowBytes * static_cast<size_t>(height));
+  if (uploadBuffer == nullptr) {
+    // The pixel unpack buffers are not supported.
+    device->unlock();
+    return;
+  }
+  std::vector<uint8_t> rgba(uploadBuffer->size());
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      auto pixel = rgba.data() + static_cast<size_t>(y) * rowBytes + x * 4;
+      pixel[0] = static_cast<uint8_t>(x * 4);
+      pixel[1] = static_cast<uint8_t>(y * 8);
+      pixel[2] = 128;
+      pixel[3] = 255;
+    }
+  }
+  ASSERT_TRUE(uploadBuffer->data() != nullptr);
+  memcpy(uploadBuffer->data(), rgba.data(), rgba.size());
+  auto texture = uploadBuffer->makeRGBATexture(width, height, rowBytes);
+  ASSERT_TRUE(texture != nullptr);
+  EXPECT_TRUE(uploadBuffer->data() == nullptr);
+  EXPECT_TRUE(DrawAndReadPixels(context, texture) == rgba);
+
+  auto chromaWidth = width / 2;
+  auto chromaHeight = height / 2;
+  auto ySize = static_cast<size_t>(width * height);
+  auto chromaSize = static_cast<size_t>(chromaWidth * chromaHeight);
+  std::vector<uint8_t> i420(ySize + chromaSize * 2);
+  for (size_t i = 0; i < i420.size(); i++) {
+    i420[i] = static_cast<uint8_t>(i < ySize ? 16 + i % 220 : 64 + i % 128);
+  }
+  size_t offsets[] = {0, ySize, ySize + chromaSize};
+  int lineSize[] = {width, chromaWidth, chromaWidth};
+  uint8_t* pixelsPlane[] = {i420.data(), i420.data() + offsets[1], i420.data() + offsets[2]};
+  auto expectedTexture = YUVTexture::MakeI420(context, tgfx::YUVColorSpace::Rec601,
+                                              tgfx::YUVColorRange::MPEG, width, height, pixelsPlane,
+                                              lineSize);
+  ASSERT_TRUE(expectedTexture != nullptr);
+  auto expected = DrawAndReadPixels(context, expectedTexture);
+  ASSERT_FALSE(expected.empty());
+  // Drops the recyclable texture so that the upload buffer has to allocate new planes.
+  expectedTexture = nullptr;
+  context->purgeResourcesNotUsedSince(0);
+
+  uploadBuffer = UploadBuffer::Make(context, i420.size());
+  ASSERT_TRUE(uploadBuffer != nullptr);
+  memcpy(uploadBuffer->data(), i420.data(), i420.size());
+  auto yuvTexture = uploadBuffer->makeI420Texture(tgfx::YUVColorSpace::Rec601,
+                                                  tgfx::YUVColorRange::MPEG, width, height, offsets,
+                                                  lineSize);
+  ASSERT_TRUE(yuvTexture != nullptr);
+  EXPECT_TRUE(DrawAndReadPixels(context, yuvTexture) == expected);
+  device->unlock();
+}
+
 /**
  * 用例描述: PNG 解码器测试
  */
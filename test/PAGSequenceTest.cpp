@@ -16,17 +16,40 @@
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include "base/utils/TimeUtil.h"
 #include "codec/mp4/MP4BoxHelper.h"
 #include "framework/pag_test.h"
 #include "framework/utils/PAGTestUtils.h"
 #include "pag/pag.h"
 #include "platform/swiftshader/NativePlatform.h"
 #include "rendering/caches/RenderCache.h"
+#include "rendering/sequences/BitmapSequenceReader.h"
+#include "rendering/sequences/VideoReader.h"
+#include "rendering/sequences/VideoSequenceDemuxer.h"
+#include "rendering/video/VideoDecoderPool.h"
 
 namespace pag {
 
 PAG_TEST_SUIT(PAGSequenceTest)
 
+/**
+ * Returns the sequence of the first composition of the specified type in the file which passes the
+ * filter, or nullptr if there is no such composition.
+ */
+static Sequence* FindSequence(const std::shared_ptr<File>& file, CompositionType type,
+                              const std::function<bool(Sequence*)>& filter = nullptr) {
+  for (auto composition : file->compositions) {
+    if (composition->type() != type) {
+      continue;
+    }
+    auto sequence = Sequence::Get(composition);
+    if (sequence != nullptr && (filter == nullptr || filter(sequence))) {
+      return sequence;
+    }
+  }
+  return nullptr;
+}
+
 /**
  * 用例描述: 测试直接上屏
  */
@@ -154,4 +177,243 @@ PAG_TEST_F(PAGSequenceTest, Sequence_Multiple_References) {
   EXPECT_EQ(static_cast<int>(sequenceCaches.begin()->second.size()), 1);
 }
 
+/**
+ * 用例描述: 序列帧预解码多帧时，顺序播放和跳帧的渲染结果与只预解码一帧时一致
+ */
+PAG_TEST_F(PAGSequenceTest, SequenceLookahead) {
+  auto pagFile1 = PAGFile::Load("../resources/apitest/ZC_mg_seky2_landscape.pag");
+  ASSERT_NE(pagFile1, nullptr);
+  auto pagFile2 = PAGFile::Load("../resources/apitest/ZC_mg_seky2_landscape.pag");
+  auto width = pagFile1->width();
+  auto height = pagFile1->height();
+  auto pagSurface1 = PAGSurface::MakeOffscreen(width, height);
+  auto pagSurface2 = PAGSurface::MakeOffscreen(width, height);
+  auto pagPlayer1 = std::make_shared<PAGPlayer>();
+  pagPlayer1->setSurface(pagSurface1);
+  pagPlayer1->setComposition(pagFile1);
+  pagPlayer1->setSequenceLookahead(4);
+  auto pagPlayer2 = std::make_shared<PAGPlayer>();
+  pagPlayer2->setSurface(pagSurface2);
+  pagPlayer2->setComposition(pagFile2);
+  EXPECT_EQ(pagPlayer1->sequenceLookahead(), 4);
+
+  auto rowBytes = static_cast<size_t>(width) * 4;
+  std::vector<uint8_t> pixels1(rowBytes * height);
+  std::vector<uint8_t> pixels2(rowBytes * height);
+  std::vector<Frame> frames = {0, 1, 2, 3, 4, 5, 6, 7, 8, 20, 21, 22, 3, 4};
+  auto& sequenceCaches = pagPlayer1->renderCache->sequenceCaches;
+  Frame lastFrame = -1;
+  Frame lastSequenceFrame = -1;
+  size_t lastHits = 0;
+  size_t totalHits = 0;
+  for (auto frame : frames) {
+    pagFile1->setCurrentTime(FrameToTime(frame, pagFile1->frameRate()));
+    pagFile2->setCurrentTime(FrameToTime(frame, pagFile2->frameRate()));
+    ASSERT_TRUE(pagPlayer1->flush());
+    ASSERT_TRUE(pagPlayer2->flush());
+    ASSERT_TRUE(pagSurface1->readPixels(ColorType::RGBA_8888, AlphaType::Premultiplied,
+                                        pixels1.data(), rowBytes));
+    ASSERT_TRUE(pagSurface2->readPixels(ColorType::RGBA_8888, AlphaType::Premultiplied,
+                                        pixels2.data(), rowBytes));
+    EXPECT_TRUE(pixels1 == pixels2);
+
+    ASSERT_EQ(static_cast<int>(sequenceCaches.size()), 1);
+    auto reader = sequenceCaches.begin()->second.front();
+    if (lastFrame >= 0 && frame == lastFrame + 1 && reader->lastFrame != lastSequenceFrame) {
+      // The next frame of the sequence was decoded ahead while the last one was on screen.
+      EXPECT_EQ(reader->bufferedFrameHits, lastHits + 1) << "frame: " << frame;
+      totalHits++;
+    }
+    // Waits for the frames decoded ahead, then the next one must be at the front of the ring.
+    if (reader->lastTask != nullptr) {
+      reader->lastTask->wait();
+    }
+    {
+      std::lock_guard<std::mutex> autoLock(reader->bufferLocker);
+      ASSERT_FALSE(reader->bufferedFrames.empty()) << "frame: " << frame;
+      EXPECT_EQ(reader->bufferedFrames.front().frame, reader->lastFrame + 1) << "frame: " << frame;
+    }
+    lastFrame = frame;
+    lastSequenceFrame = reader->lastFrame;
+    lastHits = reader->bufferedFrameHits;
+  }
+  EXPECT_GT(totalHits, 0u);
+  auto reader = sequenceCaches.begin()->second.front();
+  EXPECT_EQ(reader->lookaheadDepth(), 4);
+  EXPECT_GT(reader->decodingTime(), 0);
+}
+
+/**
+ * 用例描述: BitmapSequence跳帧时通过关键帧索引定位并行解码，结果与逐帧解码一致
+ */
+PAG_TEST_F(PAGSequenceTest, BitmapSequenceSeeking) {
+  auto pagFile = PAGFile::Load("../resources/apitest/ZC_mg_seky2_landscape.pag");
+  ASSERT_NE(pagFile, nullptr);
+  auto file = pagFile->getFile();
+  auto sequence = static_cast<BitmapSequence*>(FindSequence(file, CompositionType::Bitmap));
+  ASSERT_NE(sequence, nullptr);
+  BitmapSequenceReader playingReader(file, sequence);
+  BitmapSequenceReader seekingReader(file, sequence);
+  ASSERT_FALSE(seekingReader.keyframes.empty());
+  auto totalFrames = sequence->duration();
+  std::vector<Frame> targetFrames = {totalFrames / 2, totalFrames - 1};
+  Frame frame = 0;
+  for (auto targetFrame : targetFrames) {
+    for (; frame <= targetFrame; frame++) {
+      ASSERT_TRUE(playingReader.decodeFrame(frame));
+    }
+    // The seeking reader either starts from a keyframe or continues from its last decoded frame.
+    auto lastDecodeFrame = seekingReader.lastDecodeFrame;
+    auto startFrame = seekingReader.findStartFrame(targetFrame);
+    EXPECT_TRUE(sequence->frames[startFrame]->isKeyframe || startFrame == lastDecodeFrame + 1);
+    ASSERT_TRUE(seekingReader.decodeFrame(targetFrame));
+    tgfx::Bitmap playingBitmap(playingReader.pixelBuffer);
+    tgfx::Bitmap seekingBitmap(seekingReader.pixelBuffer);
+    EXPECT_EQ(memcmp(playingBitmap.pixels(), seekingBitmap.pixels(), playingBitmap.byteSize()), 0);
+  }
+}
+
+/**
+ * Restores the maximum number of idle video decoders when the test ends, even if it fails.
+ */
+class MaxIdleDecoderCountGuard {
+ public:
+  MaxIdleDecoderCountGuard() : count(VideoDecoderPool::GetInstance()->maxIdleCount()) {
+  }
+
+  ~MaxIdleDecoderCountGuard() {
+    PAGVideoDecoder::SetMaxIdleDecoderCount(count);
+  }
+
+ private:
+  int count = 0;
+};
+
+/**
+ * 用例描述: 视频序列帧释放后软解码器回收到解码器池，新的同格式序列帧复用该解码器
+ */
+PAG_TEST_F(PAGSequenceTest, VideoDecoderPool) {
+  auto pagFile = PAGFile::Load("../resources/apitest/wz_mvp.pag");
+  ASSERT_NE(pagFile, nullptr);
+  auto file = pagFile->getFile();
+  auto sequence = static_cast<VideoSequence*>(FindSequence(file, CompositionType::Video));
+  ASSERT_NE(sequence, nullptr);
+  MaxIdleDecoderCountGuard countGuard = {};
+  auto pool = VideoDecoderPool::GetInstance();
+  pool->clear();
+  auto demuxer = std::make_unique<VideoSequenceDemuxer>(file, sequence);
+  auto reader = std::make_unique<VideoReader>(std::move(demuxer));
+  ASSERT_TRUE(reader->decodeFrame(0));
+  if (reader->videoDecoder->isHardwareBacked()) {
+    return;
+  }
+  reader = nullptr;
+  EXPECT_EQ(pool->idleCount(), 1u);
+  demuxer = std::make_unique<VideoSequenceDemuxer>(file, sequence);
+  reader = std::make_unique<VideoReader>(std::move(demuxer));
+  ASSERT_TRUE(reader->decodeFrame(10));
+  EXPECT_EQ(pool->idleCount(), 0u);
+  reader = nullptr;
+  EXPECT_EQ(pool->idleCount(), 1u);
+  PAGVideoDecoder::SetMaxIdleDecoderCount(0);
+  EXPECT_EQ(pool->idleCount(), 0u);
+}
+
+/**
+ * 用例描述: 视频序列帧顺序播放时不拷贝解码结果，往回跳帧后才开始缓存最近解码的帧
+ */
+PAG_TEST_F(PAGSequenceTest, VideoRecentFrames) {
+  auto pagFile = PAGFile::Load("../resources/apitest/wz_mvp.pag");
+  ASSERT_NE(pagFile, nullptr);
+  auto file = pagFile->getFile();
+  auto sequence = static_cast<VideoSequence*>(FindSequence(file, CompositionType::Video));
+  ASSERT_NE(sequence, nullptr);
+  auto demuxer = std::make_unique<VideoSequenceDemuxer>(file, sequence);
+  auto reader = std::make_unique<VideoReader>(std::move(demuxer));
+  for (Frame frame = 0; frame < 10; frame++) {
+    ASSERT_TRUE(reader->decodeFrame(frame));
+  }
+  EXPECT_TRUE(reader->recentFrames.empty());
+  EXPECT_FALSE(reader->recentFramesActive);
+  ASSERT_TRUE(reader->decodeFrame(8));
+  ASSERT_TRUE(reader->decodeFrame(9));
+  if (!reader->recentFramesSupported) {
+    return;
+  }
+  EXPECT_TRUE(reader->recentFramesActive);
+  EXPECT_EQ(reader->recentFrames.size(), 2u);
+  ASSERT_TRUE(reader->decodeFrame(8));
+  EXPECT_EQ(reader->recentFrameHits, 1u);
+}
+
+/**
+ * 用例描述: 开启循环缓存后，视频序列帧第二遍播放不再解码
+ */
+PAG_TEST_F(PAGSequenceTest, VideoLoopCache) {
+  // Finds a video sequence short enough for the loop cache.
+  std::vector<std::string> files;
+  GetAllPAGFiles("../resources/apitest", files);
+  std::shared_ptr<PAGFile> pagFile = nullptr;
+  VideoSequence* sequence = nullptr;
+  auto isShortLoop = [](Sequence* videoSequence) {
+    return !videoSequence->composition->staticContent() &&
+           FrameToTime(videoSequence->duration(), videoSequence->frameRate) <= 3000000;
+  };
+  for (auto& path : files) {
+    pagFile = PAGFile::Load(path);
+    if (pagFile == nullptr) {
+      continue;
+    }
+    sequence = static_cast<VideoSequence*>(
+        FindSequence(pagFile->getFile(), CompositionType::Video, isShortLoop));
+    if (sequence != nullptr) {
+      break;
+    }
+  }
+  ASSERT_NE(sequence, nullptr);
+  auto file = pagFile->getFile();
+  auto demuxer = std::make_unique<VideoSequenceDemuxer>(file, sequence);
+  auto reader = std::make_unique<VideoReader>(std::move(demuxer));
+  reader->setLoopCacheEnabled(true);
+  auto totalFrames = sequence->duration();
+  for (Frame frame = 0; frame < totalFrames; frame++) {
+    ASSERT_TRUE(reader->decodeFrame(frame));
+  }
+  if (reader->videoDecoder != nullptr && reader->videoDecoder->isHardwareBacked()) {
+    return;
+  }
+  // Every sample is resident after the first loop, so the decoder is released.
+  EXPECT_EQ(reader->loopFrames.size(), reader->sampleCount);
+  EXPECT_EQ(reader->loopCacheMemory(), reader->frameSize * reader->sampleCount);
+  for (Frame frame = 0; frame < totalFrames; frame++) {
+    ASSERT_TRUE(reader->decodeFrame(frame));
+    EXPECT_EQ(reader->videoDecoder, nullptr);
+  }
+  reader->setLoopCacheEnabled(false);
+  EXPECT_TRUE(reader->loopFrames.empty());
+  EXPECT_EQ(reader->loopCacheMemory(), 0u);
+
+  // Lowering the budget turns the loop cache off, raising it again turns it back on.
+  auto pagSurface = PAGSurface::MakeOffscreen(pagFile->width(), pagFile->height());
+  auto pagPlayer = std::make_shared<PAGPlayer>();
+  pagPlayer->setSurface(pagSurface);
+  pagPlayer->setComposition(pagFile);
+  auto budget = pagPlayer->cacheBudget();
+  budget.loopingVideoFrames = SIZE_MAX;
+  pagPlayer->setCacheBudget(budget);
+  auto renderCache = pagPlayer->renderCache;
+  for (int i = 0; i < 60 && renderCache->loopCacheMemory() == 0; i++) {
+    ASSERT_TRUE(pagPlayer->flush());
+    pagPlayer->nextFrame();
+  }
+  auto loopCacheMemory = renderCache->loopCacheMemory();
+  ASSERT_GT(loopCacheMemory, 0u);
+  budget.loopingVideoFrames = 1;
+  pagPlayer->setCacheBudget(budget);
+  EXPECT_EQ(renderCache->loopCacheMemory(), 0u);
+  budget.loopingVideoFrames = SIZE_MAX;
+  pagPlayer->setCacheBudget(budget);
+  EXPECT_EQ(renderCache->loopCacheMemory(), loopCacheMemory);
+}
+
 }  // namespace pag
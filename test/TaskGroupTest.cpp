@@ -0,0 +1,228 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <unordered_set>
+#include "base/utils/Task.h"
+#include "framework/pag_test.h"
+#include "pag/pag.h"
+#include "tgfx/core/Clock.h"
+
+namespace pag {
+class CountingExecutor : public Executor {
+ public:
+  explicit CountingExecutor(int loops) : loops(loops) {
+  }
+
+  double result = 0;
+
+ private:
+  int loops = 0;
+
+  void execute() override {
+    for (int i = 0; i < loops; i++) {
+      result += sqrt(static_cast<double>(i));
+    }
+  }
+};
+
+class BlockingExecutor : public Executor {
+ public:
+  std::atomic_bool blocked = {true};
+
+ private:
+  void execute() override {
+    while (blocked) {
+      std::this_thread::yield();
+    }
+  }
+};
+
+class OrderExecutor : public Executor {
+ public:
+  OrderExecutor(int id, std::mutex* locker, std::vector<int>* order)
+      : id(id), locker(locker), order(order) {
+  }
+
+ private:
+  int id = 0;
+  std::mutex* locker = nullptr;
+  std::vector<int>* order = nullptr;
+
+  void execute() override {
+    std::lock_guard<std::mutex> autoLock(*locker);
+    order->push_back(id);
+  }
+};
+
+class ThreadRecordingExecutor : public Executor {
+ public:
+  ThreadRecordingExecutor(std::atomic_int* runningTasks, std::atomic_int* maxRunningTasks)
+      : runningTasks(runningTasks), maxRunningTasks(maxRunningTasks) {
+  }
+
+  std::thread::id threadID = {};
+
+ private:
+  std::atomic_int* runningTasks = nullptr;
+  std::atomic_int* maxRunningTasks = nullptr;
+
+  void execute() override {
+    threadID = std::this_thread::get_id();
+    auto count = ++(*runningTasks);
+    auto maxCount = maxRunningTasks->load();
+    while (count > maxCount && !maxRunningTasks->compare_exchange_weak(maxCount, count)) {
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    (*runningTasks)--;
+  }
+};
+
+static int64_t RunTasks(std::shared_ptr<TaskGroup> taskGroup, int taskCount, int loops) {
+  std::vector<std::shared_ptr<Task>> tasks = {};
+  tgfx::Clock clock = {};
+  for (int i = 0; i < taskCount; i++) {
+    auto task = Task::Make(std::make_unique<CountingExecutor>(loops), TaskPriority::Immediate,
+                           NO_DEADLINE, taskGroup);
+    task->run();
+    tasks.push_back(task);
+  }
+  for (auto& task : tasks) {
+    auto executor = static_cast<CountingExecutor*>(task->wait());
+    EXPECT_GT(executor->result, 0);
+  }
+  return clock.measure();
+}
+
+/**
+ * 用例描述: 测试 TaskGroup 的吞吐量随线程数的变化
+ */
+PAG_TEST(TaskGroupTest, Throughput) {
+  auto maxThreads = static_cast<int>(std::thread::hardware_concurrency());
+  if (maxThreads <= 0) {
+    maxThreads = 1;
+  }
+  int taskCount = 2000;
+  for (int threads = 1; threads <= maxThreads; threads *= 2) {
+    auto taskGroup = TaskGroup::Make("Throughput", threads);
+    ASSERT_TRUE(taskGroup != nullptr);
+    auto totalTime = RunTasks(taskGroup, taskCount, 20000);
+    std::cout << "\nthreads: " << threads << " tasks/s: "
+              << static_cast<int64_t>(taskCount * 1000000.0 / std::max(totalTime, int64_t(1)))
+              << std::endl;
+  }
+}
+
+/**
+ * 用例描述: 测试取消尚未执行的任务
+ */
+PAG_TEST(TaskGroupTest, Cancel) {
+  auto taskGroup = TaskGroup::Make("Cancel", 2);
+  ASSERT_TRUE(taskGroup != nullptr);
+  std::vector<std::shared_ptr<Task>> tasks = {};
+  for (int i = 0; i < 1000; i++) {
+    auto task = Task::Make(std::make_unique<CountingExecutor>(1000), TaskPriority::Immediate,
+                           NO_DEADLINE, taskGroup);
+    task->run();
+    tasks.push_back(task);
+  }
+  for (auto& task : tasks) {
+    task->cancel();
+    EXPECT_FALSE(task->isRunning());
+  }
+  EXPECT_EQ(taskGroup->queueDepth(), 0);
+}
+
+/**
+ * 用例描述: 测试高优先级的任务总是先于预加载任务执行，同优先级的任务按截止时间执行
+ */
+PAG_TEST(TaskGroupTest, Priority) {
+  auto taskGroup = TaskGroup::Make("Priority", 1);
+  ASSERT_TRUE(taskGroup != nullptr);
+  auto blockingTask = Task::Make(std::make_unique<BlockingExecutor>(), TaskPriority::Immediate,
+                                 NO_DEADLINE, taskGroup);
+  blockingTask->run();
+  while (taskGroup->queueDepth() > 0) {
+    std::this_thread::yield();
+  }
+  std::mutex locker = {};
+  std::vector<int> order = {};
+  std::vector<std::shared_ptr<Task>> tasks = {};
+  auto addTask = [&](int id, TaskPriority priority, int64_t deadline) {
+    auto task = Task::Make(std::make_unique<OrderExecutor>(id, &locker, &order), priority,
+                           deadline, taskGroup);
+    task->run();
+    tasks.push_back(task);
+  };
+  addTask(4, TaskPriority::Prefetch, NO_DEADLINE);
+  addTask(3, TaskPriority::Prefetch, 100);
+  addTask(2, TaskPriority::NextFrame, NO_DEADLINE);
+  addTask(1, TaskPriority::Immediate, NO_DEADLINE);
+  static_cast<BlockingExecutor*>(blockingTask->executor.get())->blocked = false;
+  for (auto& task : tasks) {
+    while (task->isRunning()) {
+      std::this_thread::yield();
+    }
+  }
+  EXPECT_EQ(order, std::vector<int>({1, 2, 3, 4}));
+}
+
+/**
+ * 用例描述: 测试独立线程池的创建和统计数据
+ */
+PAG_TEST(TaskGroupTest, ThreadPool) {
+  EXPECT_TRUE(PAGThreadPool::Make("Empty", 0) == nullptr);
+  auto threadPool = PAGThreadPool::Make("Tenant", 2, {0});
+  ASSERT_TRUE(threadPool != nullptr);
+  EXPECT_EQ(threadPool->name(), "Tenant");
+  EXPECT_EQ(threadPool->threadCount(), 2);
+  std::atomic_int runningTasks = {0};
+  std::atomic_int maxRunningTasks = {0};
+  std::vector<std::shared_ptr<Task>> tasks = {};
+  for (int i = 0; i < 20; i++) {
+    auto task = Task::Make(
+        std::make_unique<ThreadRecordingExecutor>(&runningTasks, &maxRunningTasks),
+        TaskPriority::Immediate, NO_DEADLINE, threadPool->taskGroup);
+    task->run();
+    tasks.push_back(task);
+  }
+  // Polls rather than calling wait(), which would execute the queued tasks on this thread.
+  for (auto& task : tasks) {
+    while (task->isRunning()) {
+      std::this_thread::yield();
+    }
+  }
+  // The statistics are updated right after a task finishes.
+  while (threadPool->completedTasks() < 20) {
+    std::this_thread::yield();
+  }
+  std::unordered_set<std::thread::id> threadIDs = {};
+  for (auto& task : tasks) {
+    auto executor = static_cast<ThreadRecordingExecutor*>(task->executor.get());
+    EXPECT_NE(executor->threadID, std::this_thread::get_id());
+    threadIDs.insert(executor->threadID);
+  }
+  EXPECT_LE(threadIDs.size(), 2u);
+  EXPECT_LE(maxRunningTasks.load(), 2);
+  EXPECT_EQ(threadPool->completedTasks(), 20);
+  EXPECT_EQ(threadPool->queueDepth(), 0);
+  EXPECT_GT(threadPool->busyTime(), 0);
+}
+}  // namespace pag
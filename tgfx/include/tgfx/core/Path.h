@@ -89,6 +89,16 @@ class Path {
    */
   bool isEmpty() const;
 
+  /**
+   * Returns the number of points in the Path.
+   */
+  int countPoints() const;
+
+  /**
+   * Returns the number of verbs in the Path.
+   */
+  int countVerbs() const;
+
   /**
    * Returns true if the point (x, y) is contained by Path, taking into account PathFillType.
    */
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <functional>
 #include "tgfx/core/ImageInfo.h"
 #include "tgfx/gpu/Canvas.h"
 #include "tgfx/gpu/RenderTarget.h"
@@ -47,6 +48,12 @@ class Context;
  */
 class Surface {
  public:
+  /**
+   * The callback to receive the pixels copied by readPixelsAsync(). The pixels are nullptr if the
+   * copy failed, and are only valid during the call.
+   */
+  using ReadPixelsCallback = std::function<void(const void* pixels, size_t rowBytes)>;
+
   /**
    * Creates a new Surface on GPU indicated by context. Allocates memory for pixels, based on the
    * width, height and color type (alphaOnly). A Surface with MSAA enabled is returned if the
@@ -155,6 +162,23 @@ class Surface {
    */
   bool readPixels(const ImageInfo& dstInfo, void* dstPixels, int srcX = 0, int srcY = 0);
 
+  /**
+   * Queues a copy of a rect of pixels with specified ImageInfo without waiting for the GPU to
+   * finish, so that the next frame can be drawn while the pixels are being transferred. Copy starts
+   * at (0, 0) and does not exceed Surface (width(), height()). The callback is invoked on the
+   * calling thread once the copy is complete, either during a later call to readPixelsAsync() or
+   * during finishPixelReads(), always in the order the copies are queued. The callback must not
+   * access this Surface. Falls back to a synchronous copy if the GPU back-end does not support
+   * pixel buffers. Returns false if the copy can not be queued.
+   */
+  bool readPixelsAsync(const ImageInfo& dstInfo, ReadPixelsCallback callback);
+
+  /**
+   * Waits for all copies queued by readPixelsAsync() and invokes their callbacks. The pending
+   * callbacks are discarded if the Surface is released before this method is called.
+   */
+  void finishPixelReads();
+
   /**
    * Evaluates the Surface to see if it overlaps or intersects with the specified point. The point
    * is in the coordinate space of the Surface. This method always checks against the actual pixels
@@ -167,6 +191,10 @@ class Surface {
 
   virtual bool onReadPixels(const ImageInfo& dstInfo, void* dstPixels, int srcX, int srcY) = 0;
 
+  virtual bool onReadPixelsAsync(const ImageInfo& dstInfo, ReadPixelsCallback callback) = 0;
+
+  virtual void onFinishPixelReads() = 0;
+
   std::shared_ptr<RenderTarget> renderTarget = nullptr;
   std::shared_ptr<Texture> texture = nullptr;
   bool requiresManualMSAAResolve = false;
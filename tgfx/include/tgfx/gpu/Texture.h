@@ -114,6 +114,15 @@ class Texture : public Resource {
     return false;
   }
 
+  /**
+   * Generates the mipmap levels of this texture from its current content, so that it can be sampled
+   * with trilinear filtering when drawn at a smaller size. It needs to be called again if the
+   * content changes. Returns false if the texture does not support mipmaps.
+   */
+  virtual bool generateMipmaps() {
+    return false;
+  }
+
  private:
   int _width = 0;
   int _height = 0;
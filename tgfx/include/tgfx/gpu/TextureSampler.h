@@ -37,6 +37,11 @@ class TextureSampler {
    */
   PixelFormat format = PixelFormat::RGBA_8888;
 
+  /**
+   * The max mipmap level of the sampler, 0 means the sampler has no mipmaps.
+   */
+  int maxMipMapLevel = 0;
+
   virtual TextureType type() const {
     return TextureType::TwoD;
   }
@@ -0,0 +1,71 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "tgfx/gpu/YUVTexture.h"
+
+namespace tgfx {
+/**
+ * UploadBuffer is a staging buffer for uploading pixels to textures without blocking the context
+ * thread. It is created in a mapped state, any thread can fill the memory returned by data(), then
+ * the context thread makes textures from it, which unmaps the buffer and lets the GPU copy the
+ * pixels asynchronously.
+ */
+class UploadBuffer : public Resource {
+ public:
+  /**
+   * Creates a new UploadBuffer with the specified size in bytes. Returns nullptr if the backend does
+   * not support staging buffers.
+   */
+  static std::shared_ptr<UploadBuffer> Make(Context* context, size_t size);
+
+  size_t size() const {
+    return _size;
+  }
+
+  /**
+   * Returns the mapped memory of the buffer, which can be written on any thread until the buffer
+   * is used to make a texture. Returns nullptr if the buffer is not mapped.
+   */
+  virtual void* data() const = 0;
+
+  /**
+   * Creates a new texture with each pixel stored as 32-bit RGBA data from the pixels at the offset
+   * of the buffer. The buffer is unmapped after calling this method.
+   */
+  virtual std::shared_ptr<Texture> makeRGBATexture(int width, int height, size_t rowBytes,
+                                                   size_t offset = 0) = 0;
+
+  /**
+   * Creates a new YUV texture from the I420 planes at the offsets of the buffer. The buffer is
+   * unmapped after calling this method.
+   */
+  virtual std::shared_ptr<YUVTexture> makeI420Texture(YUVColorSpace colorSpace,
+                                                      YUVColorRange colorRange, int width,
+                                                      int height, const size_t offsets[3],
+                                                      const int lineSize[3]) = 0;
+
+ protected:
+  explicit UploadBuffer(size_t size) : _size(size) {
+  }
+
+ private:
+  size_t _size = 0;
+};
+}  // namespace tgfx
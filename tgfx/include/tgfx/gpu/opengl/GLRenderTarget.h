@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <functional>
 #include "tgfx/core/ImageInfo.h"
 #include "tgfx/gpu/RenderTarget.h"
 #include "tgfx/gpu/opengl/GLFrameBuffer.h"
@@ -26,6 +27,8 @@
 namespace tgfx {
 class GLInterface;
 
+class GLPixelBuffer;
+
 /**
  * Represents a OpenGL 2D buffer of pixels that can be rendered to.
  */
@@ -87,6 +90,21 @@ class GLRenderTarget : public RenderTarget {
    */
   bool readPixels(const ImageInfo& dstInfo, void* dstPixels, int srcX = 0, int srcY = 0) const;
 
+  /**
+   * Queues a copy of the rect (0, 0, dstInfo.width(), dstInfo.height()) of pixels to a new pixel
+   * buffer object without waiting for the GPU. Returns nullptr if pixel buffer objects are not
+   * supported.
+   */
+  std::shared_ptr<GLPixelBuffer> readPixelsToBuffer(const ImageInfo& dstInfo) const;
+
+  /**
+   * Maps the pixel buffer returned by readPixelsToBuffer() and passes the pixels converted to
+   * dstInfo to the callback, waiting for the GPU if the copy is not finished yet. The callback
+   * receives nullptr if the buffer can not be mapped.
+   */
+  bool readPixelsFromBuffer(GLPixelBuffer* buffer, const ImageInfo& dstInfo,
+                            const std::function<void(const void*, size_t)>& callback) const;
+
   friend class GLSurface;
 
   friend class Surface;
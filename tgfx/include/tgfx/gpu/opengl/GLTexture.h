@@ -43,6 +43,8 @@ class GLTexture : public Texture {
 
   Point getTextureCoord(float x, float y) const override;
 
+  bool generateMipmaps() override;
+
   const TextureSampler* getSampler() const override {
     return &sampler;
   }
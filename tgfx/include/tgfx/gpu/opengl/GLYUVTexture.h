@@ -41,8 +41,22 @@ class GLYUVTexture : public YUVTexture {
   GLYUVTexture(YUVColorSpace colorSpace, YUVColorRange colorRange, int width, int height);
 
  private:
+  /**
+   * Returns an I420 texture whose planes are allocated but not written yet.
+   */
+  static std::shared_ptr<GLYUVTexture> MakeI420Planes(Context* context, YUVColorSpace colorSpace,
+                                                      YUVColorRange colorRange, int width,
+                                                      int height);
+
+  /**
+   * Writes the pixels of every plane. The pixels pointers are offsets if a pixel unpack buffer is
+   * bound.
+   */
+  void writePlanes(uint8_t* pixelsPlane[], const int lineSize[]);
+
   void onReleaseGPU() override;
 
   friend class YUVTexture;
+  friend class GLUploadBuffer;
 };
 }  // namespace tgfx
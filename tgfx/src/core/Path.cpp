@@ -175,6 +175,14 @@ bool Path::isEmpty() const {
   return pathRef->path.isEmpty();
 }
 
+int Path::countPoints() const {
+  return pathRef->path.countPoints();
+}
+
+int Path::countVerbs() const {
+  return pathRef->path.countVerbs();
+}
+
 bool Path::contains(float x, float y) const {
   return pathRef->path.contains(x, y);
 }
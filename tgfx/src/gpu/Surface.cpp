@@ -61,6 +61,19 @@ bool Surface::readPixels(const ImageInfo& dstInfo, void* dstPixels, int srcX, in
   return onReadPixels(dstInfo, dstPixels, srcX, srcY);
 }
 
+bool Surface::readPixelsAsync(const ImageInfo& dstInfo, ReadPixelsCallback callback) {
+  auto outInfo = dstInfo.makeIntersect(0, 0, width(), height());
+  if (outInfo.isEmpty() || callback == nullptr) {
+    return false;
+  }
+  flush();
+  return onReadPixelsAsync(outInfo, std::move(callback));
+}
+
+void Surface::finishPixelReads() {
+  onFinishPixelReads();
+}
+
 bool Surface::hitTest(float x, float y) {
   uint8_t pixel[4];
   auto info = ImageInfo::Make(1, 1, ColorType::RGBA_8888, AlphaType::Premultiplied);
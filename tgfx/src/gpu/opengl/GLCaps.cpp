@@ -226,6 +226,9 @@ void GLCaps::initGLSupport(const GLInfo& info) {
   textureBarrierSupport = version >= GL_VER(4, 5) || info.hasExtension("GL_ARB_texture_barrier") ||
                           info.hasExtension("GL_NV_texture_barrier");
   semaphoreSupport = version >= GL_VER(3, 2) || info.hasExtension("GL_ARB_sync");
+  pixelBufferSupport = semaphoreSupport && (version >= GL_VER(3, 0) ||
+                                            info.hasExtension("GL_ARB_map_buffer_range"));
+  mipMapSupport = version >= GL_VER(3, 0) || info.hasExtension("GL_ARB_framebuffer_object");
   if (version < GL_VER(1, 3) && !info.hasExtension("GL_ARB_texture_border_clamp")) {
     clampToBorderSupport = false;
   }
@@ -259,12 +262,15 @@ void GLCaps::initGLESSupport(const GLInfo& info) {
     frameBufferFetchRequiresEnablePerSample = true;
   }
   semaphoreSupport = version >= GL_VER(3, 0) || info.hasExtension("GL_APPLE_sync");
+  pixelBufferSupport = version >= GL_VER(3, 0);
   if (version < GL_VER(3, 2) && !info.hasExtension("GL_EXT_texture_border_clamp") &&
       !info.hasExtension("GL_NV_texture_border_clamp") &&
       !info.hasExtension("GL_OES_texture_border_clamp")) {
     clampToBorderSupport = false;
   }
   npotTextureTileSupport = version >= GL_VER(3, 0) || info.hasExtension("GL_OES_texture_npot");
+  // Generating mipmaps for the NPOT textures requires the full NPOT support.
+  mipMapSupport = npotTextureTileSupport;
 }
 
 void GLCaps::initWebGLSupport(const GLInfo& info) {
@@ -277,8 +283,11 @@ void GLCaps::initWebGLSupport(const GLInfo& info) {
   multisampleDisableSupport = false;  // no WebGL support
   textureBarrierSupport = false;
   semaphoreSupport = version >= GL_VER(2, 0);
+  // WebGL has no glMapBufferRange().
+  pixelBufferSupport = false;
   clampToBorderSupport = false;
   npotTextureTileSupport = version >= GL_VER(2, 0);
+  mipMapSupport = npotTextureTileSupport;
 }
 
 void GLCaps::initFormatMap(const GLInfo& info) {
@@ -116,6 +116,8 @@ class GLCaps : public Caps {
   bool packRowLengthSupport = false;
   bool unpackRowLengthSupport = false;
   bool textureRedSupport = false;
+  bool pixelBufferSupport = false;
+  bool mipMapSupport = false;
   MSFBOType msFBOType = MSFBOType::None;
   bool frameBufferFetchRequiresEnablePerSample = false;
   std::string frameBufferFetchColorName;
@@ -127,7 +127,8 @@ void GLGpu::bindTexture(int unitIndex, const TextureSampler* sampler, SamplerSta
                     GetGLWrap(glSampler->target, samplerState.wrapModeX));
   gl->texParameteri(glSampler->target, GL_TEXTURE_WRAP_T,
                     GetGLWrap(glSampler->target, samplerState.wrapModeY));
-  gl->texParameteri(glSampler->target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  auto minFilter = glSampler->maxMipMapLevel > 0 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR;
+  gl->texParameteri(glSampler->target, GL_TEXTURE_MIN_FILTER, minFilter);
   gl->texParameteri(glSampler->target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 }
 
@@ -113,6 +113,8 @@ std::unique_ptr<const GLInterface> GLInterface::MakeNativeInterface(const GLProc
   functions->clearColor = reinterpret_cast<GLClearColor*>(getter->getProcAddress("glClearColor"));
   functions->clearStencil =
       reinterpret_cast<GLClearStencil*>(getter->getProcAddress("glClearStencil"));
+  functions->clientWaitSync =
+      reinterpret_cast<GLClientWaitSync*>(getter->getProcAddress("glClientWaitSync"));
   functions->colorMask = reinterpret_cast<GLColorMask*>(getter->getProcAddress("glColorMask"));
   functions->compileShader =
       reinterpret_cast<GLCompileShader*>(getter->getProcAddress("glCompileShader"));
@@ -206,6 +208,8 @@ std::unique_ptr<const GLInterface> GLInterface::MakeNativeInterface(const GLProc
   functions->lineWidth = reinterpret_cast<GLLineWidth*>(getter->getProcAddress("glLineWidth"));
   functions->linkProgram =
       reinterpret_cast<GLLinkProgram*>(getter->getProcAddress("glLinkProgram"));
+  functions->mapBufferRange =
+      reinterpret_cast<GLMapBufferRange*>(getter->getProcAddress("glMapBufferRange"));
   functions->pixelStorei =
       reinterpret_cast<GLPixelStorei*>(getter->getProcAddress("glPixelStorei"));
   functions->readPixels = reinterpret_cast<GLReadPixels*>(getter->getProcAddress("glReadPixels"));
@@ -260,6 +264,8 @@ std::unique_ptr<const GLInterface> GLInterface::MakeNativeInterface(const GLProc
       reinterpret_cast<GLUniformMatrix3fv*>(getter->getProcAddress("glUniformMatrix3fv"));
   functions->uniformMatrix4fv =
       reinterpret_cast<GLUniformMatrix4fv*>(getter->getProcAddress("glUniformMatrix4fv"));
+  functions->unmapBuffer =
+      reinterpret_cast<GLUnmapBuffer*>(getter->getProcAddress("glUnmapBuffer"));
   functions->useProgram = reinterpret_cast<GLUseProgram*>(getter->getProcAddress("glUseProgram"));
   functions->vertexAttrib1f =
       reinterpret_cast<GLVertexAttrib1f*>(getter->getProcAddress("glVertexAttrib1f"));
@@ -0,0 +1,129 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "GLPixelBuffer.h"
+#include "GLCaps.h"
+#include "GLUtil.h"
+#include "core/utils/UniqueID.h"
+
+namespace tgfx {
+static void ComputeRecycleKey(BytesKey* recycleKey, size_t size) {
+  static const uint32_t Type = UniqueID::Next();
+  recycleKey->write(Type);
+  recycleKey->write(static_cast<uint32_t>(size));
+}
+
+std::shared_ptr<GLPixelBuffer> GLPixelBuffer::Make(Context* context, size_t size) {
+  if (size == 0 || !GLCaps::Get(context)->pixelBufferSupport) {
+    return nullptr;
+  }
+  BytesKey recycleKey = {};
+  ComputeRecycleKey(&recycleKey, size);
+  auto buffer =
+      std::static_pointer_cast<GLPixelBuffer>(context->resourceCache()->getRecycled(recycleKey));
+  if (buffer != nullptr) {
+    buffer->deleteFence();
+    return buffer;
+  }
+  auto gl = GLFunctions::Get(context);
+  if (gl->mapBufferRange == nullptr || gl->fenceSync == nullptr || gl->clientWaitSync == nullptr ||
+      gl->deleteSync == nullptr) {
+    return nullptr;
+  }
+  unsigned bufferID = 0;
+  gl->genBuffers(1, &bufferID);
+  if (bufferID == 0) {
+    return nullptr;
+  }
+  gl->bindBuffer(GL_PIXEL_PACK_BUFFER, bufferID);
+  gl->bufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_READ);
+  gl->bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  if (!CheckGLError(context)) {
+    gl->deleteBuffers(1, &bufferID);
+    return nullptr;
+  }
+  return Resource::Wrap(context, new GLPixelBuffer(bufferID, size));
+}
+
+void GLPixelBuffer::insertFence() {
+  deleteFence();
+  auto gl = GLFunctions::Get(context);
+  glSync = gl->fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  // Makes sure the copy command and the fence are submitted, otherwise the fence may never be
+  // signaled if the buffer is waited on from another context.
+  gl->flush();
+  fenceFlushed = false;
+}
+
+bool GLPixelBuffer::checkFence(bool wait) {
+  if (glSync == nullptr) {
+    return true;
+  }
+  auto gl = GLFunctions::Get(context);
+  auto timeout = wait ? GL_TIMEOUT_IGNORED : 0;
+  // The first wait on a fence must flush the command stream, as required by the spec, so that the
+  // fence is guaranteed to be reached. The later polls need not flush again.
+  auto flags = fenceFlushed ? 0u : static_cast<unsigned>(GL_SYNC_FLUSH_COMMANDS_BIT);
+  auto result = gl->clientWaitSync(glSync, flags, timeout);
+  fenceFlushed = true;
+  if (result == GL_TIMEOUT_EXPIRED) {
+    return false;
+  }
+  deleteFence();
+  return true;
+}
+
+const void* GLPixelBuffer::map() {
+  checkFence(true);
+  auto gl = GLFunctions::Get(context);
+  gl->bindBuffer(GL_PIXEL_PACK_BUFFER, _bufferID);
+  auto pixels =
+      gl->mapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(_size), GL_MAP_READ_BIT);
+  if (pixels == nullptr) {
+    gl->bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  }
+  return pixels;
+}
+
+void GLPixelBuffer::unmap() {
+  auto gl = GLFunctions::Get(context);
+  gl->bindBuffer(GL_PIXEL_PACK_BUFFER, _bufferID);
+  gl->unmapBuffer(GL_PIXEL_PACK_BUFFER);
+  gl->bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void GLPixelBuffer::deleteFence() {
+  if (glSync != nullptr) {
+    GLFunctions::Get(context)->deleteSync(glSync);
+    glSync = nullptr;
+  }
+}
+
+void GLPixelBuffer::computeRecycleKey(BytesKey* recycleKey) const {
+  ComputeRecycleKey(recycleKey, _size);
+}
+
+void GLPixelBuffer::onReleaseGPU() {
+  deleteFence();
+  if (_bufferID > 0) {
+    auto gl = GLFunctions::Get(context);
+    gl->deleteBuffers(1, &_bufferID);
+    _bufferID = 0;
+  }
+}
+}  // namespace tgfx
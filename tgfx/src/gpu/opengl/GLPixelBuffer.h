@@ -0,0 +1,78 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "tgfx/gpu/Resource.h"
+
+namespace tgfx {
+/**
+ * GLPixelBuffer is a pixel pack buffer object used to read pixels back from the GPU without
+ * stalling the pipeline. A fence is inserted after the copy is queued, so the pixels can be mapped
+ * once the GPU reaches it.
+ */
+class GLPixelBuffer : public Resource {
+ public:
+  /**
+   * Creates a new GLPixelBuffer with the specified size in bytes. Returns nullptr if pixel
+   * buffer objects are not supported by the context.
+   */
+  static std::shared_ptr<GLPixelBuffer> Make(Context* context, size_t size);
+
+  unsigned bufferID() const {
+    return _bufferID;
+  }
+
+  size_t size() const {
+    return _size;
+  }
+
+  /**
+   * Inserts a fence after the commands queued so far. Any previous fence is deleted.
+   */
+  void insertFence();
+
+  /**
+   * Returns true if the GPU has reached the fence. If wait is true, blocks until it does.
+   */
+  bool checkFence(bool wait);
+
+  /**
+   * Maps the pixels of the buffer for reading. Returns nullptr if failed.
+   */
+  const void* map();
+
+  void unmap();
+
+ protected:
+  void computeRecycleKey(BytesKey* recycleKey) const override;
+
+ private:
+  unsigned _bufferID = 0;
+  size_t _size = 0;
+  void* glSync = nullptr;
+  bool fenceFlushed = false;
+
+  GLPixelBuffer(unsigned bufferID, size_t size) : _bufferID(bufferID), _size(size) {
+  }
+
+  void deleteFence();
+
+  void onReleaseGPU() override;
+};
+}  // namespace tgfx
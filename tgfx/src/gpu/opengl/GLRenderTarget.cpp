@@ -18,6 +18,7 @@
 
 #include "tgfx/gpu/opengl/GLRenderTarget.h"
 #include "gpu/opengl/GLContext.h"
+#include "gpu/opengl/GLPixelBuffer.h"
 #include "gpu/opengl/GLUtil.h"
 #include "tgfx/core/Bitmap.h"
 #include "tgfx/core/Buffer.h"
@@ -268,6 +269,57 @@ bool GLRenderTarget::readPixels(const ImageInfo& dstInfo, void* dstPixels, int s
   return true;
 }
 
+static ImageInfo MakeBufferInfo(PixelFormat pixelFormat, const ImageInfo& dstInfo) {
+  auto colorType = pixelFormat == PixelFormat::ALPHA_8 ? ColorType::ALPHA_8 : ColorType::RGBA_8888;
+  return ImageInfo::Make(dstInfo.width(), dstInfo.height(), colorType, AlphaType::Premultiplied);
+}
+
+std::shared_ptr<GLPixelBuffer> GLRenderTarget::readPixelsToBuffer(const ImageInfo& dstInfo) const {
+  auto pixelFormat = renderTargetFBInfo.format;
+  auto srcInfo = MakeBufferInfo(pixelFormat, dstInfo);
+  auto buffer = GLPixelBuffer::Make(context, srcInfo.byteSize());
+  if (buffer == nullptr) {
+    return nullptr;
+  }
+  auto gl = GLFunctions::Get(context);
+  auto caps = GLCaps::Get(context);
+  const auto& format = caps->getTextureFormat(pixelFormat);
+  gl->bindFramebuffer(GL_FRAMEBUFFER, renderTargetFBInfo.id);
+  gl->bindBuffer(GL_PIXEL_PACK_BUFFER, buffer->bufferID());
+  auto alignment = pixelFormat == PixelFormat::ALPHA_8 ? 1 : 4;
+  gl->pixelStorei(GL_PACK_ALIGNMENT, alignment);
+  auto readY = origin() == ImageOrigin::BottomLeft ? height() - srcInfo.height() : 0;
+  // With a pixel pack buffer bound, the last argument is an offset into the buffer.
+  gl->readPixels(0, readY, srcInfo.width(), srcInfo.height(), format.externalFormat,
+                 GL_UNSIGNED_BYTE, nullptr);
+  gl->bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  buffer->insertFence();
+  return buffer;
+}
+
+bool GLRenderTarget::readPixelsFromBuffer(
+    GLPixelBuffer* buffer, const ImageInfo& dstInfo,
+    const std::function<void(const void*, size_t)>& callback) const {
+  auto srcInfo = MakeBufferInfo(renderTargetFBInfo.format, dstInfo);
+  auto pixels = buffer->map();
+  if (pixels == nullptr) {
+    callback(nullptr, 0);
+    return false;
+  }
+  auto flipY = origin() == ImageOrigin::BottomLeft;
+  if (!flipY && srcInfo.colorType() == dstInfo.colorType() &&
+      srcInfo.alphaType() == dstInfo.alphaType() && srcInfo.rowBytes() == dstInfo.rowBytes()) {
+    // Hands out the mapped memory directly, no extra copy is needed.
+    callback(pixels, srcInfo.rowBytes());
+  } else {
+    Buffer dstPixels(dstInfo.byteSize());
+    CopyPixels(srcInfo, pixels, dstInfo, dstPixels.data(), flipY);
+    callback(dstPixels.data(), dstInfo.rowBytes());
+  }
+  buffer->unmap();
+  return true;
+}
+
 void GLRenderTarget::resolve() const {
   if (sampleCount() <= 1) {
     return;
@@ -19,6 +19,8 @@
 #include "GLSurface.h"
 #include "GLCaps.h"
 #include "GLContext.h"
+#include "GLPixelBuffer.h"
+#include "tgfx/core/Buffer.h"
 #include "tgfx/gpu/opengl/GLSemaphore.h"
 
 namespace tgfx {
@@ -80,4 +82,43 @@ bool GLSurface::onReadPixels(const ImageInfo& dstInfo, void* dstPixels, int srcX
   return std::static_pointer_cast<GLRenderTarget>(renderTarget)
       ->readPixels(dstInfo, dstPixels, srcX, srcY);
 }
+
+// The number of pixel buffers in flight. Three buffers allow the GPU to transfer one frame while
+// the next one is being drawn and the previous one is being consumed.
+static constexpr size_t MAX_PENDING_PIXEL_READS = 3;
+
+bool GLSurface::onReadPixelsAsync(const ImageInfo& dstInfo, ReadPixelsCallback callback) {
+  auto glRT = std::static_pointer_cast<GLRenderTarget>(renderTarget);
+  finishPendingReads(MAX_PENDING_PIXEL_READS - 1);
+  auto buffer = glRT->readPixelsToBuffer(dstInfo);
+  if (buffer == nullptr) {
+    finishPendingReads(0);
+    Buffer pixels(dstInfo.byteSize());
+    if (!glRT->readPixels(dstInfo, pixels.data())) {
+      return false;
+    }
+    callback(pixels.data(), dstInfo.rowBytes());
+    return true;
+  }
+  pendingReads.push_back({std::move(buffer), dstInfo, std::move(callback)});
+  return true;
+}
+
+void GLSurface::onFinishPixelReads() {
+  finishPendingReads(0);
+}
+
+void GLSurface::finishPendingReads(size_t maxPendingReads) {
+  auto glRT = std::static_pointer_cast<GLRenderTarget>(renderTarget);
+  while (!pendingReads.empty()) {
+    auto& pendingRead = pendingReads.front();
+    // Completed copies are delivered early so that their buffers can be recycled.
+    if (pendingReads.size() <= maxPendingReads && !pendingRead.buffer->checkFence(false)) {
+      break;
+    }
+    auto read = std::move(pendingRead);
+    pendingReads.pop_front();
+    glRT->readPixelsFromBuffer(read.buffer.get(), read.dstInfo, read.callback);
+  }
+}
 }  // namespace tgfx
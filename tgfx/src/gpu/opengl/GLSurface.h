@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <deque>
 #include "tgfx/gpu/Surface.h"
 #include "tgfx/gpu/opengl/GLRenderTarget.h"
 #include "tgfx/gpu/opengl/GLTexture.h"
@@ -27,10 +28,24 @@ class GLSurface : public Surface {
  protected:
   bool onReadPixels(const ImageInfo& dstInfo, void* dstPixels, int srcX, int srcY) override;
 
+  bool onReadPixelsAsync(const ImageInfo& dstInfo, ReadPixelsCallback callback) override;
+
+  void onFinishPixelReads() override;
+
  private:
+  struct PendingPixelRead {
+    std::shared_ptr<GLPixelBuffer> buffer = nullptr;
+    ImageInfo dstInfo = {};
+    ReadPixelsCallback callback = nullptr;
+  };
+
+  std::deque<PendingPixelRead> pendingReads = {};
+
   explicit GLSurface(std::shared_ptr<GLRenderTarget> renderTarget,
                      std::shared_ptr<GLTexture> texture = nullptr);
 
+  void finishPendingReads(size_t maxPendingReads);
+
   friend class Surface;
 };
 }  // namespace tgfx
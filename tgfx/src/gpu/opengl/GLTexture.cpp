@@ -137,6 +137,8 @@ std::shared_ptr<Texture> Texture::Make(Context* context, int width, int height,
       std::static_pointer_cast<GLTexture>(context->resourceCache()->getRecycled(recycleKey));
   if (texture) {
     texture->_origin = origin;
+    // The mipmaps of the recycled texture are out of date.
+    texture->sampler.maxMipMapLevel = 0;
   } else {
     PixelFormat pixelFormat = alphaOnly ? PixelFormat::ALPHA_8 : PixelFormat::RGBA_8888;
     auto sampler = context->gpu()->createTexture(width, height, pixelFormat);
@@ -180,4 +182,19 @@ GLTexture::GLTexture(int width, int height, ImageOrigin origin) : Texture(width,
 Point GLTexture::getTextureCoord(float x, float y) const {
   return {x / static_cast<float>(width()), y / static_cast<float>(height())};
 }
+
+bool GLTexture::generateMipmaps() {
+  if (!GLCaps::Get(context)->mipMapSupport || sampler.target != GL_TEXTURE_2D) {
+    return false;
+  }
+  auto maxLevel = static_cast<int>(floorf(log2f(static_cast<float>(std::max(width(), height())))));
+  if (maxLevel < 1) {
+    return false;
+  }
+  auto gl = GLFunctions::Get(context);
+  gl->bindTexture(sampler.target, sampler.id);
+  gl->generateMipmap(sampler.target);
+  sampler.maxMipMapLevel = maxLevel;
+  return true;
+}
 }  // namespace tgfx
@@ -0,0 +1,156 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "GLUploadBuffer.h"
+#include "GLCaps.h"
+#include "GLUtil.h"
+#include "core/utils/UniqueID.h"
+#include "gpu/Gpu.h"
+#include "tgfx/gpu/opengl/GLYUVTexture.h"
+
+namespace tgfx {
+static void ComputeRecycleKey(BytesKey* recycleKey, size_t size) {
+  static const uint32_t Type = UniqueID::Next();
+  recycleKey->write(Type);
+  recycleKey->write(static_cast<uint32_t>(size));
+}
+
+std::shared_ptr<UploadBuffer> UploadBuffer::Make(Context* context, size_t size) {
+  if (context == nullptr || size == 0 || !GLCaps::Get(context)->pixelBufferSupport) {
+    return nullptr;
+  }
+  BytesKey recycleKey = {};
+  ComputeRecycleKey(&recycleKey, size);
+  auto buffer =
+      std::static_pointer_cast<GLUploadBuffer>(context->resourceCache()->getRecycled(recycleKey));
+  if (buffer == nullptr) {
+    auto gl = GLFunctions::Get(context);
+    if (gl->mapBufferRange == nullptr) {
+      return nullptr;
+    }
+    unsigned bufferID = 0;
+    gl->genBuffers(1, &bufferID);
+    if (bufferID == 0) {
+      return nullptr;
+    }
+    gl->bindBuffer(GL_PIXEL_UNPACK_BUFFER, bufferID);
+    gl->bufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr,
+                   GL_STREAM_DRAW);
+    gl->bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (!CheckGLError(context)) {
+      gl->deleteBuffers(1, &bufferID);
+      return nullptr;
+    }
+    buffer = Resource::Wrap(context, new GLUploadBuffer(bufferID, size));
+  }
+  if (!buffer->map()) {
+    return nullptr;
+  }
+  return buffer;
+}
+
+bool GLUploadBuffer::map() {
+  if (mappedPixels != nullptr) {
+    return true;
+  }
+  auto gl = GLFunctions::Get(context);
+  gl->bindBuffer(GL_PIXEL_UNPACK_BUFFER, bufferID);
+  // Invalidating the previous contents allows the driver to hand out new memory rather than
+  // waiting for the pending copies from this buffer.
+  mappedPixels = gl->mapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(size()),
+                                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+  gl->bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  return mappedPixels != nullptr;
+}
+
+void GLUploadBuffer::unmap() {
+  if (mappedPixels == nullptr) {
+    return;
+  }
+  auto gl = GLFunctions::Get(context);
+  gl->bindBuffer(GL_PIXEL_UNPACK_BUFFER, bufferID);
+  gl->unmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+  gl->bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  mappedPixels = nullptr;
+}
+
+std::shared_ptr<Texture> GLUploadBuffer::makeRGBATexture(int width, int height, size_t rowBytes,
+                                                         size_t offset) {
+  unmap();
+  if (offset + rowBytes * static_cast<size_t>(height) > size()) {
+    return nullptr;
+  }
+  auto texture = Texture::MakeRGBA(context, width, height);
+  if (texture == nullptr) {
+    return nullptr;
+  }
+  auto gl = GLFunctions::Get(context);
+  gl->bindBuffer(GL_PIXEL_UNPACK_BUFFER, bufferID);
+  // The pixels pointer is an offset into the bound unpack buffer.
+  context->gpu()->writePixels(texture->getSampler(),
+                              Rect::MakeWH(static_cast<float>(width), static_cast<float>(height)),
+                              reinterpret_cast<void*>(offset), rowBytes);
+  gl->bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  return texture;
+}
+
+std::shared_ptr<YUVTexture> GLUploadBuffer::makeI420Texture(YUVColorSpace colorSpace,
+                                                            YUVColorRange colorRange, int width,
+                                                            int height, const size_t offsets[3],
+                                                            const int lineSize[3]) {
+  unmap();
+  uint8_t* pixelsPlane[3] = {};
+  for (int i = 0; i < 3; i++) {
+    auto rowCount = static_cast<size_t>(i == 0 ? height : (height + 1) / 2);
+    if (offsets[i] + static_cast<size_t>(lineSize[i]) * rowCount > size()) {
+      return nullptr;
+    }
+    // The pixels pointers are offsets into the bound unpack buffer.
+    pixelsPlane[i] = reinterpret_cast<uint8_t*>(offsets[i]);
+  }
+  // Allocates the planes before binding the unpack buffer, otherwise the texImage2D() calls with
+  // null pixels would read from the buffer too.
+  auto texture = GLYUVTexture::MakeI420Planes(context, colorSpace, colorRange, width, height);
+  if (texture == nullptr) {
+    return nullptr;
+  }
+  auto gl = GLFunctions::Get(context);
+  gl->bindBuffer(GL_PIXEL_UNPACK_BUFFER, bufferID);
+  texture->writePlanes(pixelsPlane, lineSize);
+  gl->bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  return texture;
+}
+
+void GLUploadBuffer::computeRecycleKey(BytesKey* recycleKey) const {
+  ComputeRecycleKey(recycleKey, size());
+}
+
+void GLUploadBuffer::onReleaseGPU() {
+  if (bufferID > 0) {
+    auto gl = GLFunctions::Get(context);
+    if (mappedPixels != nullptr) {
+      gl->bindBuffer(GL_PIXEL_UNPACK_BUFFER, bufferID);
+      gl->unmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      gl->bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      mappedPixels = nullptr;
+    }
+    gl->deleteBuffers(1, &bufferID);
+    bufferID = 0;
+  }
+}
+}  // namespace tgfx
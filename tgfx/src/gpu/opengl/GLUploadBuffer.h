@@ -0,0 +1,59 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "tgfx/gpu/UploadBuffer.h"
+
+namespace tgfx {
+/**
+ * GLUploadBuffer is a pixel unpack buffer object. It is mapped with GL_MAP_INVALIDATE_BUFFER_BIT,
+ * so reusing a buffer does not wait for the GPU to finish reading the previous pixels.
+ */
+class GLUploadBuffer : public UploadBuffer {
+ public:
+  void* data() const override {
+    return mappedPixels;
+  }
+
+  std::shared_ptr<Texture> makeRGBATexture(int width, int height, size_t rowBytes,
+                                           size_t offset) override;
+
+  std::shared_ptr<YUVTexture> makeI420Texture(YUVColorSpace colorSpace, YUVColorRange colorRange,
+                                              int width, int height, const size_t offsets[3],
+                                              const int lineSize[3]) override;
+
+ protected:
+  void computeRecycleKey(BytesKey* recycleKey) const override;
+
+ private:
+  unsigned bufferID = 0;
+  void* mappedPixels = nullptr;
+
+  GLUploadBuffer(unsigned bufferID, size_t size) : UploadBuffer(size), bufferID(bufferID) {
+  }
+
+  bool map();
+
+  void unmap();
+
+  void onReleaseGPU() override;
+
+  friend class UploadBuffer;
+};
+}  // namespace tgfx
@@ -38,8 +38,6 @@ struct YUVConfig {
   YUVColorRange colorRange;
   int width = 0;
   int height = 0;
-  uint8_t* pixelsPlane[3]{};
-  int rowBytes[3]{};
   PixelFormat formats[3]{};
   int planeCount = 0;
 };
@@ -107,27 +105,12 @@ static std::vector<GLSampler> MakeTexturePlanes(Context* context, const YUVConfi
   return texturePlanes;
 }
 
-static void SubmitYUVTexture(Context* context, const YUVConfig& yuvConfig,
-                             const GLSampler yuvTextures[]) {
-  static constexpr int factor[] = {0, 1, 1};
-  for (int index = 0; index < yuvConfig.planeCount; index++) {
-    const auto& sampler = yuvTextures[index];
-    auto w = yuvConfig.width >> factor[index];
-    auto h = yuvConfig.height >> factor[index];
-    auto rowBytes = yuvConfig.rowBytes[index];
-    auto pixels = yuvConfig.pixelsPlane[index];
-    context->gpu()->writePixels(
-        &sampler, Rect::MakeWH(static_cast<float>(w), static_cast<float>(h)), pixels, rowBytes);
-  }
-}
-
-std::shared_ptr<YUVTexture> YUVTexture::MakeI420(Context* context, YUVColorSpace colorSpace,
-                                                 YUVColorRange colorRange, int width, int height,
-                                                 uint8_t* pixelsPlane[3], const int lineSize[3]) {
+std::shared_ptr<GLYUVTexture> GLYUVTexture::MakeI420Planes(Context* context,
+                                                           YUVColorSpace colorSpace,
+                                                           YUVColorRange colorRange, int width,
+                                                           int height) {
   YUVConfig yuvConfig = YUVConfig(colorSpace, colorRange, width, height, I420_PLANE_COUNT);
   for (int i = 0; i < 3; i++) {
-    yuvConfig.pixelsPlane[i] = pixelsPlane[i];
-    yuvConfig.rowBytes[i] = lineSize[i];
     yuvConfig.formats[i] = PixelFormat::GRAY_8;
   }
 
@@ -145,7 +128,17 @@ std::shared_ptr<YUVTexture> YUVTexture::MakeI420(Context* context, YUVColorSpace
                                                   yuvConfig.width, yuvConfig.height)));
     texture->samplers = texturePlanes;
   }
-  SubmitYUVTexture(context, yuvConfig, &texture->samplers[0]);
+  return texture;
+}
+
+std::shared_ptr<YUVTexture> YUVTexture::MakeI420(Context* context, YUVColorSpace colorSpace,
+                                                 YUVColorRange colorRange, int width, int height,
+                                                 uint8_t* pixelsPlane[3], const int lineSize[3]) {
+  auto texture = GLYUVTexture::MakeI420Planes(context, colorSpace, colorRange, width, height);
+  if (texture == nullptr) {
+    return nullptr;
+  }
+  texture->writePlanes(pixelsPlane, lineSize);
   return texture;
 }
 
@@ -153,10 +146,6 @@ std::shared_ptr<YUVTexture> YUVTexture::MakeNV12(Context* context, YUVColorSpace
                                                  YUVColorRange colorRange, int width, int height,
                                                  uint8_t* pixelsPlane[2], const int lineSize[2]) {
   YUVConfig yuvConfig = YUVConfig(colorSpace, colorRange, width, height, NV12_PLANE_COUNT);
-  for (int i = 0; i < 2; i++) {
-    yuvConfig.pixelsPlane[i] = pixelsPlane[i];
-    yuvConfig.rowBytes[i] = lineSize[i];
-  }
   yuvConfig.formats[0] = PixelFormat::GRAY_8;
   yuvConfig.formats[1] = PixelFormat::RG_88;
 
@@ -174,7 +163,7 @@ std::shared_ptr<YUVTexture> YUVTexture::MakeNV12(Context* context, YUVColorSpace
                                                   yuvConfig.width, yuvConfig.height)));
     texture->samplers = texturePlanes;
   }
-  SubmitYUVTexture(context, yuvConfig, &texture->samplers[0]);
+  texture->writePlanes(pixelsPlane, lineSize);
   return texture;
 }
 
@@ -194,6 +183,17 @@ const TextureSampler* GLYUVTexture::getSamplerAt(size_t index) const {
   return &samplers[index];
 }
 
+void GLYUVTexture::writePlanes(uint8_t* pixelsPlane[], const int lineSize[]) {
+  static constexpr int factor[] = {0, 1, 1};
+  for (size_t index = 0; index < samplers.size(); index++) {
+    auto w = width() >> factor[index];
+    auto h = height() >> factor[index];
+    context->gpu()->writePixels(&samplers[index],
+                                Rect::MakeWH(static_cast<float>(w), static_cast<float>(h)),
+                                pixelsPlane[index], static_cast<size_t>(lineSize[index]));
+  }
+}
+
 void GLYUVTexture::onReleaseGPU() {
   for (auto& sampler : samplers) {
     context->gpu()->deleteTexture(&sampler);